@@ -8,6 +8,134 @@
  */
 #include "converter.hpp"
 
+// global variables, see converter.hpp for their documentation
+string outputDirString;
+unordered_map<sdfSymbol, sdfCommon*> typedefs;
+vector<tuple<string, string, sdfCommon*>> typerefs;
+unordered_map<sdfSymbol, sdfCommon*> identities;
+vector<tuple<string, string, sdfCommon*>> identsLeft;
+unordered_map<sdfSymbol, sdfCommon*> leafs;
+vector<tuple<string, string, sdfCommon*>> referencesLeft;
+unordered_map<sdfSymbol, sdfCommon*> branchRefs;
+vector<string> alreadyImported;
+vector<shared_ptr<void>> voidPointerStore;
+vector<string> stringStore;
+vector<lys_revision> revStore;
+vector<shared_ptr<lys_node>> nodeStore;
+vector<lys_tpdf*> tpdfStore;
+vector<lys_restr> restrStore;
+unordered_map<sdfSymbol, lys_ident*> identStore;
+unordered_map<sdfSymbol, lys_node*> pathsToNodes;
+vector<tuple<string, lys_ident**>> openBaseIdent;
+vector<tuple<string, lys_node_augment*, string>> openAugments;
+vector<tuple<sdfFile*, lys_module*>> fileToModule;
+vector<sdfFile*> convertedFiles;
+unordered_map<lys_tpdf*, sdfData*> convertedTypedefs;
+unordered_map<lys_ident*, sdfData*> convertedIdentities;
+lys_module *helper;
+vector<lys_module*> bufferedModules;
+map<string, string> *importBuffers = NULL;
+map<string, map<string, string>> moduleIndex;
+validationMode validationSetting = validation_memory;
+bool deduplicationSetting = false;
+sdfFormat sdfFormatSetting = sdf_format_json;
+map<string, tuple<off_t, unordered_set<string>>> bundleContents;
+map<string, unordered_set<string>> featureProfile;
+vector<const lys_module*> profiledModules;
+vector<tuple<int, string, future<tuple<bool, double>>>> deferredValidations;
+map<int, tuple<bool, double>> finishedValidations;
+int nextValidationId = 1;
+
+struct lys_tpdf stringTpdf = {
+        .name = "string",
+        .type = {.base = LY_TYPE_STRING}
+};
+
+struct lys_tpdf dec64Tpdf = {
+        .name = "decimal64",
+        .type = {.base = LY_TYPE_DEC64}
+};
+
+struct lys_tpdf intTpdf = {
+        .name = "int64",
+        .type = {.base = LY_TYPE_INT64}
+};
+
+struct lys_tpdf uint64Tpdf = {
+        .name = "uint64",
+        .type = {.base = LY_TYPE_UINT64}
+};
+
+struct lys_tpdf int32Tpdf = {
+        .name = "int32",
+        .type = {.base = LY_TYPE_INT32}
+};
+
+struct lys_tpdf uint32Tpdf = {
+        .name = "uint32",
+        .type = {.base = LY_TYPE_UINT32}
+};
+
+struct lys_tpdf int16Tpdf = {
+        .name = "int16",
+        .type = {.base = LY_TYPE_INT16}
+};
+
+struct lys_tpdf uint16Tpdf = {
+        .name = "uint16",
+        .type = {.base = LY_TYPE_UINT16}
+};
+
+struct lys_tpdf int8Tpdf = {
+        .name = "int8",
+        .type = {.base = LY_TYPE_INT8}
+};
+
+struct lys_tpdf uint8Tpdf = {
+        .name = "uint8",
+        .type = {.base = LY_TYPE_UINT8}
+};
+
+struct lys_tpdf booleanTpdf = {
+        .name = "boolean",
+        .type = {.base = LY_TYPE_BOOL}
+};
+
+struct lys_tpdf enumTpdf = {
+        .name = "enumeration",
+        .type = {.base = LY_TYPE_ENUM}
+};
+
+struct lys_tpdf leafrefTpdf = {
+        .name = "leafref",
+        .type = {.base = LY_TYPE_LEAFREF}
+};
+
+struct lys_tpdf unionTpdf = {
+        .name = "union",
+        .type = {.base = LY_TYPE_UNION}
+};
+
+struct lys_tpdf emptyTpdf = {
+        .name = "empty",
+        .type = {.base = LY_TYPE_EMPTY}
+};
+
+struct lys_tpdf bitsTpdf = {
+        .name = "bits",
+        .type = {.base = LY_TYPE_BITS}
+};
+
+struct lys_tpdf binaryTpdf = {
+        .name = "binary",
+        .type = {.base = LY_TYPE_BINARY}
+};
+
+struct lys_tpdf identTpdf = {
+        .name = "identityref",
+        .type = {.base = LY_TYPE_IDENT}
+};
+
 string avoidNull(const char *c)
 {
     if (c == NULL)
@@ -149,9 +277,17 @@ bool subTreeUsesModule(lys_node *node, lys_module *wanted)
     if (!node)
         return false;
 
+    // the siblings and children that are left to check (the next child on
+    // top)
+    vector<lys_node*> stack = {node};
     lys_node *elem;
-    for (elem = node; elem; elem = elem->next)
+    while (!stack.empty())
     {
+        elem = stack.back();
+        stack.pop_back();
+        if (elem->next)
+            stack.push_back(elem->next);
+
         if (elem->nodetype == LYS_LEAF
                 && typeUsesModule(&((lys_node_leaf*)elem)->type, wanted))
         {
@@ -212,8 +348,8 @@ bool subTreeUsesModule(lys_node *node, lys_module *wanted)
             return true;
         }
 
-        if (subTreeUsesModule(elem->child, wanted))
-            return true;
+        if (elem->child)
+            stack.push_back(elem->child);
     }
 
     return false;
@@ -249,56 +385,64 @@ bool moduleUsesModule(lys_module *module, lys_module *wanted)
 string generatePath(lys_node *node, lys_module *module,
         bool addPrefix)
 {
-    if (!node)
+    // the path below the current node, built while walking up to the root
+    string suffix = "";
+    for (;;)
     {
-        cerr << "generatePath: node is null" << endl;
-        return "";
-    }
-    if (!node->module)
-    {
-        cerr << "generatePath: module is null" << endl;
-        return "";
-    }
+        if (!node)
+        {
+            cerr << "generatePath: node is null" << endl;
+            return suffix;
+        }
+        if (!node->module)
+        {
+            cerr << "generatePath: module is null" << endl;
+            return suffix;
+        }
 
-    // Try generating the path automatically
-    // (remove prefix if necessary)
-    string automatic = "";
-    if (!addPrefix //&& !node->module->prefix
-                && (!module || node->module == module))
-    {
-        automatic = avoidNull(lys_path(node, 1));
-        smatch sm;
-        regex p("/[^/^:]*:(.*)");
-        if (regex_match(automatic, sm, p))
-            automatic = "/" + sm[1].str();
-    }
-    else
-        automatic = avoidNull(lys_path(node, 0));
+        // Try generating the path automatically
+        // (remove prefix if necessary)
+        string automatic = "";
+        if (!addPrefix //&& !node->module->prefix
+                    && (!module || node->module == module))
+        {
+            automatic = avoidNull(lys_path(node, 1));
+            smatch sm;
+            regex p("/[^/^:]*:(.*)");
+            if (regex_match(automatic, sm, p))
+                automatic = "/" + sm[1].str();
+        }
+        else
+            automatic = avoidNull(lys_path(node, 0));
 
-    if (automatic != "")
-        return automatic;
+        if (automatic != "")
+            return automatic + suffix;
 
-    else
-        cerr << "generatePath: automatic path generation failed" << endl;
+        else
+            cerr << "generatePath: automatic path generation failed"
+                    << endl;
 
-    // if automatic generation did not work try the next step
-    string prefix;
-    if ((!addPrefix || !node->module->prefix)
-            && (!module || node->module == module))
-        prefix = "/";
-    else
-        prefix = "/" + avoidNull(node->module->prefix) + ":";
+        // if automatic generation did not work try the next step
+        string prefix;
+        if ((!addPrefix || !node->module->prefix)
+                && (!module || node->module == module))
+            prefix = "/";
+        else
+            prefix = "/" + avoidNull(node->module->prefix) + ":";
 
-    string nodeName = avoidNull(node->name);
-    if (nodeName == "" && (node->nodetype & (LYS_INPUT | LYS_OUTPUT)))
-    {
-        return  generatePath(node->parent, module, addPrefix);
-    }
+        string nodeName = avoidNull(node->name);
+        if (nodeName == "" && (node->nodetype & (LYS_INPUT | LYS_OUTPUT)))
+        {
+            node = node->parent;
+            continue;
+        }
 
-    if (node->parent == NULL)
-        return prefix + nodeName;
+        if (node->parent == NULL)
+            return prefix + nodeName + suffix;
 
-    return  generatePath(node->parent, module, addPrefix) + prefix + nodeName;
+        suffix = prefix + nodeName + suffix;
+        node = node->parent;
+    }
 }
 
 /*
@@ -366,17 +510,16 @@ string expandPath(lys_tpdf *tpdf, bool addPrefix)
 
 
 /*
- * Recursively check all parent nodes for given type
+ * Check all parent nodes for given type
  */
 bool someParentNodeHasType(struct lys_node *_node, LYS_NODE type)
 {
-    struct lys_node *node = _node;
-    if (node->parent == NULL)
-        return false;
-    else if (node->parent->nodetype == type)
-        return true;
-    else
-        return someParentNodeHasType(node->parent, type);
+    for (lys_node *node = _node->parent; node; node = node->parent)
+    {
+        if (node->nodetype == type)
+            return true;
+    }
+    return false;
 }
 
 /*
@@ -407,44 +550,55 @@ jsonDataType parseBaseType(LY_DATA_TYPE type)
     }
 }
 
-LY_DATA_TYPE stringToLType(std::string type)
+LY_DATA_TYPE stringToLType(const std::string &type)
 {
-    if (type == "string")
-        return LY_TYPE_STRING;
-    else if (type == "number" || type == "dec64")
-        return LY_TYPE_DEC64;
-    else if (type == "boolean")
-        return LY_TYPE_BOOL;
-    else if (type == "integer" || type == "int64")
-        return LY_TYPE_INT64;
-    else if (type == "int32")
-        return LY_TYPE_INT32;
-    else if (type == "int16")
-        return LY_TYPE_INT16;
-    else if (type == "int8")
-        return LY_TYPE_INT8;
-    else if (type == "uint64")
-        return LY_TYPE_UINT64;
-    else if (type == "uint32")
-        return LY_TYPE_UINT32;
-    else if (type == "uint16")
-        return LY_TYPE_UINT16;
-    else if (type == "uint8")
-        return LY_TYPE_UINT8;
-    else if (type == "ident" || type == "identity" || type == "identityref")
-        return LY_TYPE_IDENT;
-    else if (type == "union")
-        return LY_TYPE_UNION;
-    else if (type == "binary")
-        return LY_TYPE_BINARY;
-    else if (type == "bits")
-        return LY_TYPE_BITS;
-    else if (type == "empty")
-        return LY_TYPE_EMPTY;
-    else if (type == "instance-identifier")
-        return LY_TYPE_INST;
-    else
+    switch (keywordHash(type))
+    {
+    case keywordHash("string"):
+        return type == "string" ? LY_TYPE_STRING : LY_TYPE_UNKNOWN;
+    case keywordHash("number"):
+        return type == "number" ? LY_TYPE_DEC64 : LY_TYPE_UNKNOWN;
+    case keywordHash("dec64"):
+        return type == "dec64" ? LY_TYPE_DEC64 : LY_TYPE_UNKNOWN;
+    case keywordHash("boolean"):
+        return type == "boolean" ? LY_TYPE_BOOL : LY_TYPE_UNKNOWN;
+    case keywordHash("integer"):
+        return type == "integer" ? LY_TYPE_INT64 : LY_TYPE_UNKNOWN;
+    case keywordHash("int64"):
+        return type == "int64" ? LY_TYPE_INT64 : LY_TYPE_UNKNOWN;
+    case keywordHash("int32"):
+        return type == "int32" ? LY_TYPE_INT32 : LY_TYPE_UNKNOWN;
+    case keywordHash("int16"):
+        return type == "int16" ? LY_TYPE_INT16 : LY_TYPE_UNKNOWN;
+    case keywordHash("int8"):
+        return type == "int8" ? LY_TYPE_INT8 : LY_TYPE_UNKNOWN;
+    case keywordHash("uint64"):
+        return type == "uint64" ? LY_TYPE_UINT64 : LY_TYPE_UNKNOWN;
+    case keywordHash("uint32"):
+        return type == "uint32" ? LY_TYPE_UINT32 : LY_TYPE_UNKNOWN;
+    case keywordHash("uint16"):
+        return type == "uint16" ? LY_TYPE_UINT16 : LY_TYPE_UNKNOWN;
+    case keywordHash("uint8"):
+        return type == "uint8" ? LY_TYPE_UINT8 : LY_TYPE_UNKNOWN;
+    case keywordHash("ident"):
+        return type == "ident" ? LY_TYPE_IDENT : LY_TYPE_UNKNOWN;
+    case keywordHash("identity"):
+        return type == "identity" ? LY_TYPE_IDENT : LY_TYPE_UNKNOWN;
+    case keywordHash("identityref"):
+        return type == "identityref" ? LY_TYPE_IDENT : LY_TYPE_UNKNOWN;
+    case keywordHash("union"):
+        return type == "union" ? LY_TYPE_UNION : LY_TYPE_UNKNOWN;
+    case keywordHash("binary"):
+        return type == "binary" ? LY_TYPE_BINARY : LY_TYPE_UNKNOWN;
+    case keywordHash("bits"):
+        return type == "bits" ? LY_TYPE_BITS : LY_TYPE_UNKNOWN;
+    case keywordHash("empty"):
+        return type == "empty" ? LY_TYPE_EMPTY : LY_TYPE_UNKNOWN;
+    case keywordHash("instance-identifier"):
+        return type == "instance-identifier" ? LY_TYPE_INST : LY_TYPE_UNKNOWN;
+    default:
         return LY_TYPE_UNKNOWN;
+    }
 }
 
 LY_DATA_TYPE stringToLType(jsonDataType type)
@@ -487,18 +641,90 @@ string parseTypeToString(struct lys_type *type)
     }
 }
 
-void addOriginNote(sdfCommon *com, string stmt, string arg)
+void appendOriginNote(string &dsc, const string &stmt, const string &arg)
 {
-    string dsc = com->getDescription(), note = stmt;
+    if (dsc != "")
+        dsc += "\n";
+    dsc += "!Conversion note: ";
+    dsc += stmt;
     if (arg != "")
-        note += " " + arg;
+    {
+        dsc += " ";
+        dsc += arg;
+    }
+    dsc += "!\n";
+}
 
-    if (dsc == "")
-        dsc = "!Conversion note: " + note + "!\n";
-    else
-        dsc += "\n!Conversion note: " + note + "!\n";
+void addOriginNote(sdfCommon *com, string stmt, string arg)
+{
+    string dsc = com->getDescription();
+    appendOriginNote(dsc, stmt, arg);
+    com->setDescription(move(dsc));
+}
+
+/*
+ * Find the first occurrence of word in text[from, to), the first letter of
+ * word may be upper or lower case
+ */
+static size_t findWordInRange(const string &text, size_t from, size_t to,
+        const string &word)
+{
+    char upper = toupper(word[0]), lower = tolower(word[0]);
+    for (size_t i = from; i + word.size() <= to; i++)
+    {
+        if ((text[i] == upper || text[i] == lower)
+                && text.compare(i + 1, word.size() - 1, word, 1) == 0)
+            return i;
+    }
+    return string::npos;
+}
+
+void scanDescriptionParagraphs(const string &dsc, string &copyright,
+        string &license)
+{
+    copyright = "";
+    license = "";
+    size_t start = 0, end, pos;
+    while (start < dsc.size() && (copyright == "" || license == ""))
+    {
+        // skip empty lines between paragraphs
+        if (dsc[start] == '\n')
+        {
+            start++;
+            continue;
+        }
+        // a paragraph ends at an empty line or at the end of the description
+        end = dsc.find("\n\n", start);
+        if (end == string::npos)
+            end = dsc.back() == '\n' ? dsc.size() - 1 : dsc.size();
+
+        // the copyright notice runs from 'Copyright' to the paragraph end
+        if (copyright == "")
+        {
+            pos = findWordInRange(dsc, start, end, "copyright");
+            if (pos != string::npos)
+                copyright = dsc.substr(pos, end - pos);
+        }
+        // the license is the whole first paragraph mentioning it
+        if (license == ""
+                && findWordInRange(dsc, start, end, "license") != string::npos)
+            license = dsc.substr(start, end - start);
 
-    com->setDescription(dsc);
+        start = end;
+    }
+}
+
+moduleInfo extractModuleInfo(lys_module *module)
+{
+    moduleInfo info;
+    scanDescriptionParagraphs(avoidNull(module->dsc), info.copyright,
+            info.license);
+    info.organization = avoidNull(module->org);
+    info.contact = avoidNull(module->contact);
+    info.reference = avoidNull(module->ref);
+    for (int i = 0; i < module->rev_size; i++)
+        info.revisions.push_back(avoidNull(module->rev[i].date));
+    return info;
 }
 
 vector<int64_t> rangeToInt(const char *range)
@@ -672,17 +898,17 @@ const char* intToRange(int64_t min, uint64_t max)
 string statusToDescription(uint16_t flags, string dsc)
 {
     if ((flags & LYS_STATUS_MASK) == LYS_STATUS_DEPRC)
-        return "!Conversion note: status DEPRECATED!\n" + dsc;
+        return "!Conversion note: status DEPRECATED!\n" + move(dsc);
     else if ((flags & LYS_STATUS_MASK) == LYS_STATUS_OBSLT)
-        return "!Conversion note: status OBSOLETE!\n" + dsc;
+        return "!Conversion note: status OBSOLETE!\n" + move(dsc);
     else if ((flags & LYS_STATUS_MASK) == LYS_STATUS_CURR)
-        return "!Conversion note: status CURRENT!\n" + dsc;
+        return "!Conversion note: status CURRENT!\n" + move(dsc);
     return dsc;
 }
 
 string mustToDescription(lys_restr *must, int size, string dsc)
 {
-    string result = dsc;
+    string result = move(dsc);
 
     for (int i = 0; i < size; i++)
     {
@@ -694,7 +920,6 @@ string mustToDescription(lys_restr *must, int size, string dsc)
                             + "!\n";
     }
 
-    dsc = result;
     return result;
 }
 
@@ -708,7 +933,7 @@ string whenToDescription(lys_when *when, string dsc)
                           + "!\n";
     }
     if (dsc != "")
-        return dsc + "\n\n" + whenString;
+        return move(dsc) + "\n\n" + whenString;
     else return whenString;
 }
 
@@ -776,7 +1001,7 @@ sdfData* typeToSdfData(struct lys_type *type, sdfData *data,
                 dsc += ": " + avoidNull(type->info.bits.bit[i].dsc);
             if (type->info.bits.bit[i].ref)
                 dsc += "\n" + avoidNull(type->info.bits.bit[i].ref);
-            bitProp->setDescription(dsc);
+            bitProp->setDescription(move(dsc));
             bitProp->setType(json_boolean);
             data->addObjectProperty(bitProp);
         }
@@ -854,9 +1079,10 @@ sdfData* typeToSdfData(struct lys_type *type, sdfData *data,
                         avoidNull(type->info.ident.ref[i]->dsc),
                         json_type_undef);
 
-                if (identities[avoidNull(type->info.ident.ref[i]->name)])
-                    ref->setReference(
-                          identities[avoidNull(type->info.ident.ref[i]->name)]);
+                sdfCommon *base = findBySymbol(identities,
+                        avoidNull(type->info.ident.ref[i]->name));
+                if (base)
+                    ref->setReference(base);
                 else
                 {
                     identsLeft.push_back(tuple<string, string, sdfCommon*>{
@@ -873,9 +1099,10 @@ sdfData* typeToSdfData(struct lys_type *type, sdfData *data,
         else if (type->info.ident.count == 1)
         {
             data->setType(json_type_undef);
-            if (identities[avoidNull(type->info.ident.ref[0]->name)])
-                data->setReference(
-                        identities[avoidNull(type->info.ident.ref[0]->name)]);
+            sdfCommon *base = findBySymbol(identities,
+                    avoidNull(type->info.ident.ref[0]->name));
+            if (base)
+                data->setReference(base);
             else
             {
                 identsLeft.push_back(tuple<string, string, sdfCommon*>{
@@ -893,7 +1120,7 @@ sdfData* typeToSdfData(struct lys_type *type, sdfData *data,
             string dsc = data->getDescription();
             dsc += "\nLibyang did not parse the identityref definition(s) of "
                     "this element\n";
-            data->setDescription(dsc);
+            data->setDescription(move(dsc));
         }
 
         addOriginNote(data, "type", "identityref");
@@ -994,7 +1221,7 @@ sdfData* typeToSdfData(struct lys_type *type, sdfData *data,
                     else
                         combPattern += patt;
                 }
-                data->setPattern(combPattern);
+                data->setPattern(move(combPattern));
             }
         }
 
@@ -1011,7 +1238,7 @@ sdfData* typeToSdfData(struct lys_type *type, sdfData *data,
                         + avoidNull(type->info.enums.enm[i].dsc));
                 }
             }
-            data->setEnumString(enum_names);
+            data->setEnumString(move(enum_names));
         }
         // The second condition is a hot fix
         else if (type->info.str.length && type->base == LY_TYPE_STRING)
@@ -1165,10 +1392,25 @@ sdfData* typedefToSdfData(struct lys_tpdf *tpdf)
     typeToSdfData(&tpdf->type, data, true);
     data->parseDefault(tpdf->dflt);
 
-    typedefs[tpdf->name] = data;
+    typedefs[internSymbol(tpdf->name)] = data;
+    convertedTypedefs[tpdf] = data;
     return data;
 }
 
+vector<sdfData*> newTypedefsToSdfData(lys_tpdf *tpdfs, uint16_t tpdf_size)
+{
+    vector<sdfData*> converted;
+    for (int i = 0; i < tpdf_size && tpdfs; i++)
+    {
+        // typedefs of expanded groupings are shared by all copies, they are
+        // referenced through sdfRef by every copy
+        if (convertedTypedefs.find(&tpdfs[i]) != convertedTypedefs.end())
+            continue;
+        converted.push_back(typedefToSdfData(&tpdfs[i]));
+    }
+    return converted;
+}
+
 /*
  * The information is extracted from the given lys_node_leaf struct and
  * a corresponding sdfProperty object is generated
@@ -1199,7 +1441,7 @@ sdfProperty* leafToSdfProperty(struct lys_node_leaf *node,
             && node->iffeature->features[0])
     {
         iffString = resolve_iffeature_recursive(node->iffeature, &eIndex,
-                &fIndex);
+                &fIndex, lys_main_module(node->module));
         addOriginNote(property, "if feature", iffString);
     }
 
@@ -1207,7 +1449,7 @@ sdfProperty* leafToSdfProperty(struct lys_node_leaf *node,
     // save reference to leaf for ability to convert leafref-type
     if (node->type.base != LY_TYPE_LEAFREF
             && strcmp(node->type.der->name, "leafref") != 0)
-        leafs[generatePath((lys_node*)node)] = property;
+        leafs[internSymbol(generatePath((lys_node*)node))] = property;
 
     if (node->units)
     {
@@ -1277,8 +1519,8 @@ sdfData* leafToSdfData(struct lys_node_leaf *node,
                 data});
         }
 
-        leafs[generatePath((lys_node*)node)] = data;
-        leafs[generatePath((lys_node*)node, NULL, true)] = data;
+        leafs[internSymbol(generatePath((lys_node*)node))] = data;
+        leafs[internSymbol(generatePath((lys_node*)node, NULL, true))] = data;
     }
     assert(!dynamic_cast<sdfProperty*>(data));
     return data;
@@ -1320,7 +1562,7 @@ sdfProperty* leaflistToSdfProperty(struct lys_node_leaflist *node,
 
     // overwrite reference for path
     if (node->type.base != LY_TYPE_LEAFREF)
-        leafs[generatePath((lys_node*)node)] = property;
+        leafs[internSymbol(generatePath((lys_node*)node))] = property;
 
     // the number of minimal and maximal items is only valid if at least
     // one of them is not 0
@@ -1348,7 +1590,7 @@ sdfData* leaflistToSdfData(struct lys_node_leaflist *node,
     sdfData *data = new sdfData(*leaflistToSdfProperty(node, object));
 
     if (node->type.base != LY_TYPE_LEAFREF)
-       leafs[generatePath((lys_node*)node)] = data;
+       leafs[internSymbol(generatePath((lys_node*)node))] = data;
 
     assert(!dynamic_cast<sdfProperty*>(data));
     return data;
@@ -1384,8 +1626,8 @@ sdfAction* actionToSdfAction(lys_node_rpc_action *node, sdfObject *object,
                 avoidNull(node->ext[i]->arg_value));
     }
 
-    for (int i = 0; i < node->tpdf_size; i++)
-        action->addDatatype(typedefToSdfData(&node->tpdf[i]));
+    for (sdfData *t : newTypedefsToSdfData(node->tpdf, node->tpdf_size))
+        action->addDatatype(t);
 
     // if feature
     string iffString = "";
@@ -1394,7 +1636,7 @@ sdfAction* actionToSdfAction(lys_node_rpc_action *node, sdfObject *object,
             && node->iffeature->features[0])
     {
         iffString = resolve_iffeature_recursive(node->iffeature, &eIndex,
-                &fIndex);
+                &fIndex, lys_main_module(node->module));
         addOriginNote(data, "if feature", iffString);
     }
 
@@ -1486,25 +1728,43 @@ uint8_t iff_getop(uint8_t *list, int pos)
     return result >> 2 * (pos % 4);
 }
 string resolve_iffeature_recursive(struct lys_iffeature *expr, int *index_e,
-        int *index_f)
+        int *index_f, const lys_module *module)
 {
-    uint8_t op;
+    uint8_t op, opA, opB;
     string a, b;
+    lys_feature *feature;
 
     op = iff_getop(expr->expr, *index_e);
     (*index_e)++;
 
     switch (op) {
     case LYS_IFF_F:
-        /* resolve feature */
-        return avoidNull(expr->features[(*index_f)++]->name);
+        /* resolve feature, features of other modules keep their prefix */
+        feature = expr->features[(*index_f)++];
+        if (module && feature->module
+                && lys_main_module(feature->module) != module)
+            return avoidNull(lys_main_module(feature->module)->prefix) + ":"
+                    + avoidNull(feature->name);
+        return avoidNull(feature->name);
     case LYS_IFF_NOT:
-        /* invert result */
-        return "not " + resolve_iffeature_recursive(expr, index_e, index_f);
+        /* invert result, compound operands are put in parentheses */
+        opA = iff_getop(expr->expr, *index_e);
+        a = resolve_iffeature_recursive(expr, index_e, index_f, module);
+        if (opA == LYS_IFF_AND || opA == LYS_IFF_OR)
+            a = "(" + a + ")";
+        return "not " + a;
     case LYS_IFF_AND:
     case LYS_IFF_OR:
-        a = resolve_iffeature_recursive(expr, index_e, index_f);
-        b = resolve_iffeature_recursive(expr, index_e, index_f);
+        /* operands with the other binary operator are put in parentheses
+         * so that the string keeps the structure of expr */
+        opA = iff_getop(expr->expr, *index_e);
+        a = resolve_iffeature_recursive(expr, index_e, index_f, module);
+        opB = iff_getop(expr->expr, *index_e);
+        b = resolve_iffeature_recursive(expr, index_e, index_f, module);
+        if ((opA == LYS_IFF_AND || opA == LYS_IFF_OR) && opA != op)
+            a = "(" + a + ")";
+        if ((opB == LYS_IFF_AND || opB == LYS_IFF_OR) && opB != op)
+            b = "(" + b + ")";
         if (op == LYS_IFF_AND) {
             return a + " and " + b;
         } else { /* LYS_IFF_OR */
@@ -1515,10 +1775,69 @@ string resolve_iffeature_recursive(struct lys_iffeature *expr, int *index_e,
     return "";
 }
 
-sdfData* nodeToSdfData(struct lys_node *node, sdfObject *object)
+bool iffeatureValue(struct lys_iffeature *expr, int *index_e, int *index_f)
 {
-    if (!node)
-        return NULL;
+    uint8_t op;
+    bool a, b;
+    lys_feature *feature;
+    const lys_module *module;
+
+    op = iff_getop(expr->expr, *index_e);
+    (*index_e)++;
+
+    switch (op) {
+    case LYS_IFF_F:
+        /* look up the feature state of profiled modules only */
+        feature = expr->features[(*index_f)++];
+        if (!feature || !feature->module)
+            return true;
+        module = lys_main_module(feature->module);
+        if (!featureProfile.count(avoidNull(module->name)))
+            return true;
+        return lys_features_state(module, feature->name) == 1;
+    case LYS_IFF_NOT:
+        return !iffeatureValue(expr, index_e, index_f);
+    case LYS_IFF_AND:
+    case LYS_IFF_OR:
+        /* both operands are evaluated to move the indices on */
+        a = iffeatureValue(expr, index_e, index_f);
+        b = iffeatureValue(expr, index_e, index_f);
+        if (op == LYS_IFF_AND)
+            return a && b;
+        return a || b;
+    }
+
+    return true;
+}
+
+bool nodeIsPruned(lys_node *node)
+{
+    if (featureProfile.empty() || !node)
+        return false;
+
+    int eIndex, fIndex;
+    for (int i = 0; i < node->iffeature_size; i++)
+    {
+        eIndex = 0;
+        fIndex = 0;
+        if (node->iffeature[i].expr
+                && !iffeatureValue(&node->iffeature[i], &eIndex, &fIndex))
+            return true;
+    }
+
+    // the if-features of an augment apply to all of its nodes
+    if (node->parent && node->parent->nodetype == LYS_AUGMENT)
+        return nodeIsPruned(node->parent);
+
+    return false;
+}
+
+nodeConversionFrame openNodeConversion(lys_node *node, sdfObject *object)
+{
+    nodeConversionFrame frame;
+    frame.node = node;
+    frame.object = object;
+    frame.elem = node->child;
 
     sdfData *data;
     try
@@ -1531,6 +1850,7 @@ sdfData* nodeToSdfData(struct lys_node *node, sdfObject *object)
         cerr << "allocation failed" << endl;
         exit(EXIT_FAILURE);
     }
+    frame.data = data;
     if (node->ref)
         addOriginNote(data, "reference", avoidNull(node->ref));
 
@@ -1552,7 +1872,7 @@ sdfData* nodeToSdfData(struct lys_node *node, sdfObject *object)
             && node->iffeature->features[0])
     {
         iffString = resolve_iffeature_recursive(node->iffeature, &eIndex,
-                &fIndex);
+                &fIndex, lys_main_module(node->module));
         addOriginNote(data, "if feature", iffString);
     }
 
@@ -1605,323 +1925,437 @@ sdfData* nodeToSdfData(struct lys_node *node, sdfObject *object)
     if (when)
         addOriginNote(data, "when", when->cond);
 
-    sdfCommon *com;
-    // iterate over all child nodes
-    for (lys_node *elem = node->child; elem; elem = elem->next)
+    return frame;
+}
+
+bool nodeNeedsConversionFrame(lys_node *elem)
+{
+    if (elem->nodetype & (LYS_CASE | LYS_CHOICE | LYS_CONTAINER
+            | LYS_GROUPING | LYS_LIST | LYS_NOTIF))
+        return true;
+
+    // if there are alterations to the referenced grouping
+    // it cannot be referenced anymore but has to be inserted fully
+    // in the altered version
+    return elem->nodetype == LYS_USES
+            && (((lys_node_uses*)elem)->augment_size > 0
+                || ((lys_node_uses*)elem)->refine_size > 0);
+}
+
+sdfObject* startChildConversion(nodeConversionFrame &frame)
+{
+    lys_node *elem = frame.elem;
+    sdfObject *object = frame.object;
+
+    if (elem->nodetype == LYS_CONTAINER)
     {
-        // if the node is marked to be ignored
-        if (node->flags & IGNORE_NODE)
-            continue;
+        for (sdfData *t : newTypedefsToSdfData(
+                ((lys_node_container*)elem)->tpdf,
+                ((lys_node_container*)elem)->tpdf_size))
+            object->addDatatype(t);
+    }
+    else if (elem->nodetype == LYS_LIST)
+    {
+        sdfData *next = new sdfData(avoidNull(elem->name),
+                avoidNull(elem->dsc), json_array);
 
-        // conversion note for anydata
-        if (elem->nodetype == LYS_ANYDATA)
-            addOriginNote(data, "anydata", avoidNull(elem->name));
-        // conversion note for anyxml
-        else if (elem->nodetype == LYS_ANYXML)
-            addOriginNote(data, "anyxml", avoidNull(elem->name));
+        // translate the status of the list node
+        next->setDescription(statusToDescription(elem->flags,
+                next->getDescription()));
 
-        // Actions, unlike RPCs, can be tied to containers or lists
-        else if (elem->nodetype == LYS_ACTION)
+        for (int i = 0; i < elem->ext_size; i++)
         {
-            sdfAction *action = actionToSdfAction(
-                    (lys_node_rpc_action*)elem, object, data);
-            action->setDescription(
-                    "Action connected to " + avoidNull(node->name) + "\n\n"
-                    + action->getDescription());
-            object->addAction(action);
-            com = action;
+            addOriginNote(next, avoidNull(elem->ext[i]->def->name),
+                    avoidNull(elem->ext[i]->arg_value));
         }
-        // YANG modules cannot have actions at the top level, only rpcs
-        else if (elem->nodetype == LYS_RPC)
-        {
-            // rpcs are converted to sdfAction
-            sdfAction *action = actionToSdfAction(
-                    (lys_node_rpc_action*)elem, object);
-            object->addAction(action);
 
-            com = action;
+        if (((lys_node_list*)elem)->when)
+        {
+            addOriginNote(next, "when",
+                    avoidNull(((lys_node_list*)elem)->when->cond));
         }
-        else if (elem->nodetype == LYS_CASE)
+        for (int i = 0; i < ((lys_node_list*)elem)->must_size; i++)
         {
-            sdfData *c = nodeToSdfData(elem, object);
-            data->addChoice(c);
-            branchRefs[generatePath(elem)] = c;
-
-            c->setDescription(whenToDescription(
-                    ((lys_node_case*)elem)->when, c->getDescription()));
-            com = c;
+            addOriginNote(next, "must",
+                    avoidNull(((lys_node_list*)elem)->must[i].expr));
         }
-        else if (elem->nodetype == LYS_CHOICE)
+        frame.list = next;
+    }
+    else if (elem->nodetype == LYS_NOTIF)
+    {
+        sdfEvent *event = new sdfEvent(avoidNull(elem->name),
+                avoidNull(elem->dsc));
+
+        // translate the status of the notification
+        event->setDescription(statusToDescription(elem->flags,
+                event->getDescription()));
+        // transfer the must statement to the description
+        event->setDescription(
+                mustToDescription(
+                    ((lys_node_notif*)elem)->must,
+                    ((lys_node_notif*)elem)->must_size,
+                    event->getDescription()));
+        // Transfer extensions
+        for (int i = 0; i < elem->ext_size; i++)
         {
-            sdfData *choiceData = nodeToSdfData(elem, object);
+            addOriginNote(event, avoidNull(elem->ext[i]->def->name),
+                    avoidNull(elem->ext[i]->arg_value));
+        }
+        frame.event = event;
+
+        // buffer sdfObject to not put the grouping on object
+        // this is ok because there cannot be further notifications
+        // or actions in a notification
+        frame.keepGrouping = new sdfObject();
+        return frame.keepGrouping;
+    }
+
+    return object;
+}
+
+void finishChildConversion(nodeConversionFrame &frame, sdfData *child)
+{
+    lys_node *node = frame.node;
+    lys_node *elem = frame.elem;
+    sdfObject *object = frame.object;
+    sdfData *data = frame.data;
+
+    if (elem->nodetype == LYS_CASE)
+    {
+        sdfData *c = child;
+        data->addChoice(c);
+        branchRefs[internSymbol(generatePath(elem))] = c;
+
+        c->setDescription(whenToDescription(
+                ((lys_node_case*)elem)->when, c->getDescription()));
+        frame.com = c;
+    }
+    else if (elem->nodetype == LYS_CHOICE)
+    {
+        sdfData *choiceData = child;
 
-            for (sdfData *prop : choiceData->getObjectProperties())
-                choiceData->addChoice(prop);
-            choiceData->setObjectProperties({});
+        for (sdfData *prop : choiceData->getObjectProperties())
+            choiceData->addChoice(prop);
+        choiceData->setObjectProperties({});
 
-            data->addObjectProperty(choiceData);
-            if (elem->flags && LYS_MAND_MASK == LYS_MAND_TRUE)
-                object->addRequired((sdfCommon*)choiceData);
+        data->addObjectProperty(choiceData);
+        if (elem->flags && LYS_MAND_MASK == LYS_MAND_TRUE)
+            object->addRequired((sdfCommon*)choiceData);
 
-            // conversion note for default
-            if (((lys_node_choice*)elem)->dflt)
+        // conversion note for default
+        if (((lys_node_choice*)elem)->dflt)
+        {
+            addOriginNote(choiceData, "default",
+                    ((lys_node_choice*)elem)->dflt->name);
+        }
+
+        choiceData->setDescription(whenToDescription(
+             ((lys_node_choice*)elem)->when, choiceData->getDescription()));
+        frame.com = choiceData;
+    }
+    else if (elem->nodetype == LYS_CONTAINER)
+    {
+        sdfData *container = child;
+        container->setDescription(
+                mustToDescription(
+                    ((lys_node_container*)elem)->must,
+                    ((lys_node_container*)elem)->must_size,
+                    container->getDescription()));
+        data->addObjectProperty(container);
+
+        if (((lys_node_container*)elem)->presence)
+            addOriginNote(container, "presence",
+                    avoidNull(((lys_node_container*)elem)->presence));
+        frame.com = container;
+    }
+    else if (elem->nodetype == LYS_GROUPING)
+    {
+        sdfData *datatype = child;
+        object->addDatatype(datatype);
+        branchRefs[internSymbol(generatePath(elem))] = datatype;
+        frame.com = datatype;
+    }
+    else if (elem->nodetype == LYS_LIST)
+    {
+        sdfData *next = frame.list;
+        sdfData *itemConstr = child;
+        itemConstr->setName("");
+        next->setItemConstr(itemConstr);
+
+        for (sdfData *t : newTypedefsToSdfData(
+                ((lys_node_list*)elem)->tpdf,
+                ((lys_node_list*)elem)->tpdf_size))
+            object->addDatatype(t);
+
+        if (((lys_node_list*)elem)->min != 0)
+            next->setMinItems(((lys_node_list*)elem)->min);
+        if (((lys_node_list*)elem)->max != 0)
+            next->setMaxItems(((lys_node_list*)elem)->max);
+
+        // look for artificial keys, do not round trip them
+        bool artKey;
+        for (int i = 0; i < ((lys_node_list*)elem)->keys_size; i++)
+        {
+            artKey = false;
+            for (int j = 0; j < ((lys_node_list*)elem)->keys[i]->ext_size;
+                    j++)
             {
-                addOriginNote(choiceData, "default",
-                        ((lys_node_choice*)elem)->dflt->name);
+                if (avoidNull(
+                        ((lys_node_list*)elem)->keys[i]->ext[j]->arg_value)
+                        == "artificial-key")
+                    artKey = true;
             }
-
-            choiceData->setDescription(whenToDescription(
-                 ((lys_node_choice*)elem)->when, choiceData->getDescription()));
-            com = choiceData;
+            if (!artKey)
+                addOriginNote(next, "key",
+                    avoidNull(((lys_node_list*)elem)->keys[i]->name));
         }
-        else if (elem->nodetype == LYS_CONTAINER)
-        {
-            for (int i = 0; i < ((lys_node_container*)elem)->tpdf_size; i++)
-                object->addDatatype(typedefToSdfData(
-                        &((lys_node_container*)elem)->tpdf[i]));
 
-            sdfData *container = nodeToSdfData(elem, object);
-            container->setDescription(
-                    mustToDescription(
-                        ((lys_node_container*)elem)->must,
-                        ((lys_node_container*)elem)->must_size,
-                        container->getDescription()));
-            data->addObjectProperty(container);
+        if (elem->flags & LYS_USERORDERED)
+            addOriginNote(next, "ordered-by", "user");
 
-            if (((lys_node_container*)elem)->presence)
-                addOriginNote(container, "presence",
-                        avoidNull(((lys_node_container*)elem)->presence));
-            com = container;
+        // look for unique leaf nodes in the sub-tree
+        lys_node *after, *now;
+        LY_TREE_DFS_BEGIN(elem, after, now)
+        {
+            if (now->nodetype == LYS_LEAF && (now->flags & LYS_UNIQUE))
+                next->setUniqueItems(true);
+            LY_TREE_DFS_END(elem, after, now);
         }
-        else if (elem->nodetype == LYS_GROUPING)
+
+
+        data->addObjectProperty(next);
+        frame.com = next;
+    }
+    else if (elem->nodetype == LYS_NOTIF)
+    {
+        sdfEvent *event = frame.event;
+        sdfData *output = child;
+        for (sdfData *grp : frame.keepGrouping->getDatatypes())
+            event->addDatatype(grp);
+        output->setName("");
+        output->setDescription("");
+        event->setOutputData(output);
+        if (strcmp(node->name, "buffer") != 0
+                && strcmp(node->name, "") != 0)
         {
-            sdfData *datatype = nodeToSdfData(elem, object);
-            object->addDatatype(datatype);
-            branchRefs[generatePath(elem)] = datatype;
-            com = datatype;
+            event->setDescription(
+                    "Notification from " + avoidNull(node->name) + ":\n\n"
+                    + event->getDescription());
         }
-        else if (elem->nodetype == LYS_LEAF)
+        object->addEvent(event);
+
+        for (sdfData *t : newTypedefsToSdfData(
+                ((lys_node_notif*)elem)->tpdf,
+                ((lys_node_notif*)elem)->tpdf_size))
+            event->addDatatype(t);
+            //object->addDatatype(typedefToSdfData(
+            //        &((lys_node_notif*)elem)->tpdf[i]));
+
+        frame.com = event;
+    }
+    else if (elem->nodetype == LYS_USES)
+    {
+        sdfData *uses = child;
+        if (((lys_node_uses*)elem)->when)
         {
-            sdfData *next = leafToSdfData((lys_node_leaf*)elem, object);
+            addOriginNote(uses, "when",
+                    avoidNull(((lys_node_uses*)elem)->when->cond));
+        }
 
-            if ((elem->flags & LYS_UNIQUE) == LYS_UNIQUE)
-                addOriginNote(next, "unique");
+        data->addObjectProperty(uses);
+        frame.com = uses;
+    }
+    frame.list = NULL;
+    frame.event = NULL;
+    frame.keepGrouping = NULL;
+}
 
-            data->addObjectProperty(next);
+void convertChildInPlace(nodeConversionFrame &frame)
+{
+    lys_node *node = frame.node;
+    lys_node *elem = frame.elem;
+    sdfObject *object = frame.object;
+    sdfData *data = frame.data;
 
-            if ((elem->flags & LYS_MAND_MASK) == LYS_MAND_TRUE)
-                data->addRequiredObjectProperty(avoidNull(elem->name));
+    // conversion note for anydata
+    if (elem->nodetype == LYS_ANYDATA)
+        addOriginNote(data, "anydata", avoidNull(elem->name));
+    // conversion note for anyxml
+    else if (elem->nodetype == LYS_ANYXML)
+        addOriginNote(data, "anyxml", avoidNull(elem->name));
 
-            com = next;
-        }
-        else if (elem->nodetype == LYS_LEAFLIST)
-        {
-            sdfData *next = leaflistToSdfData((lys_node_leaflist*)elem, object);
-            data->addObjectProperty(next);
+    // Actions, unlike RPCs, can be tied to containers or lists
+    else if (elem->nodetype == LYS_ACTION)
+    {
+        sdfAction *action = actionToSdfAction(
+                (lys_node_rpc_action*)elem, object, data);
+        action->setDescription(
+                "Action connected to " + avoidNull(node->name) + "\n\n"
+                + action->getDescription());
+        object->addAction(action);
+        frame.com = action;
+    }
+    // YANG modules cannot have actions at the top level, only rpcs
+    else if (elem->nodetype == LYS_RPC)
+    {
+        // rpcs are converted to sdfAction
+        sdfAction *action = actionToSdfAction(
+                (lys_node_rpc_action*)elem, object);
+        object->addAction(action);
 
-            for (int i = 0; i < ((lys_node_leaflist*)elem)->must_size; i++)
-            {
-                addOriginNote(next, "must",
-                        avoidNull(((lys_node_leaflist*)elem)->must[i].expr));
-            }
+        frame.com = action;
+    }
+    else if (elem->nodetype == LYS_LEAF)
+    {
+        sdfData *next = leafToSdfData((lys_node_leaf*)elem, object);
 
-            if (elem->flags & LYS_USERORDERED)
-                addOriginNote(next, "ordered-by", "user");
+        if ((elem->flags & LYS_UNIQUE) == LYS_UNIQUE)
+            addOriginNote(next, "unique");
 
-            com = next;
-        }
-        else if (elem->nodetype == LYS_LIST)
-        {
-            sdfData *next = new sdfData(avoidNull(elem->name),
-                    avoidNull(elem->dsc), json_array);
+        data->addObjectProperty(next);
 
-            // translate the status of the list node
-            next->setDescription(statusToDescription(elem->flags,
-                    next->getDescription()));
+        if ((elem->flags & LYS_MAND_MASK) == LYS_MAND_TRUE)
+            data->addRequiredObjectProperty(avoidNull(elem->name));
 
-            for (int i = 0; i < elem->ext_size; i++)
-            {
-                addOriginNote(next, avoidNull(elem->ext[i]->def->name),
-                        avoidNull(elem->ext[i]->arg_value));
-            }
+        frame.com = next;
+    }
+    else if (elem->nodetype == LYS_LEAFLIST)
+    {
+        sdfData *next = leaflistToSdfData((lys_node_leaflist*)elem, object);
+        data->addObjectProperty(next);
 
-            if (((lys_node_list*)elem)->when)
-            {
-                addOriginNote(next, "when",
-                        avoidNull(((lys_node_list*)elem)->when->cond));
-            }
-            for (int i = 0; i < ((lys_node_list*)elem)->must_size; i++)
-            {
-                addOriginNote(next, "must",
-                        avoidNull(((lys_node_list*)elem)->must[i].expr));
-            }
+        for (int i = 0; i < ((lys_node_leaflist*)elem)->must_size; i++)
+        {
+            addOriginNote(next, "must",
+                    avoidNull(((lys_node_leaflist*)elem)->must[i].expr));
+        }
 
-            sdfData *itemConstr = nodeToSdfData(elem, object);
-            itemConstr->setName("");
-            next->setItemConstr(itemConstr);
+        if (elem->flags & LYS_USERORDERED)
+            addOriginNote(next, "ordered-by", "user");
 
-            for (int i = 0; i < ((lys_node_list*)elem)->tpdf_size; i++)
-                object->addDatatype(typedefToSdfData(
-                        &((lys_node_list*)elem)->tpdf[i]));
+        frame.com = next;
+    }
+    else if (elem->nodetype == LYS_USES)
+    {
+        // the referenced grouping is not altered and can be referenced
+        sdfData *uses = new sdfData(avoidNull(elem->name),
+            avoidNull(elem->dsc), "");
+        referencesLeft.push_back(tuple<string, string, sdfCommon*>{
+            generatePath((lys_node*)((lys_node_uses*)elem)->grp),
+            generatePath((lys_node*)((lys_node_uses*)elem)->grp, NULL,
+                    true),
+           (sdfCommon*)uses});
 
-            if (((lys_node_list*)elem)->min != 0)
-                next->setMinItems(((lys_node_list*)elem)->min);
-            if (((lys_node_list*)elem)->max != 0)
-                next->setMaxItems(((lys_node_list*)elem)->max);
+        // remove the prefix on the name of the uses if there is one
+        string name = uses->getName();
+        smatch sm;
+        regex r("[^:]*:(.*)");
+        if(regex_match(name, sm, r))
+            uses->setName(sm[1].str());
 
-            // look for artificial keys, do not round trip them
-            bool artKey;
-            for (int i = 0; i < ((lys_node_list*)elem)->keys_size; i++)
-            {
-                artKey = false;
-                for (int j = 0; j < ((lys_node_list*)elem)->keys[i]->ext_size;
-                        j++)
-                {
-                    if (avoidNull(
-                            ((lys_node_list*)elem)->keys[i]->ext[j]->arg_value)
-                            == "artificial-key")
-                        artKey = true;
-                }
-                if (!artKey)
-                    addOriginNote(next, "key",
-                        avoidNull(((lys_node_list*)elem)->keys[i]->name));
-            }
+        // translate the status of the uses node
+        uses->setDescription(statusToDescription(elem->flags,
+                uses->getDescription()));
 
-            if (elem->flags & LYS_USERORDERED)
-                addOriginNote(next, "ordered-by", "user");
+        finishChildConversion(frame, uses);
+    }
+}
 
-            // look for unique leaf nodes in the sub-tree
-            lys_node *after, *now;
-            LY_TREE_DFS_BEGIN(elem, after, now)
-            {
-                if (now->nodetype == LYS_LEAF && (now->flags & LYS_UNIQUE))
-                    next->setUniqueItems(true);
-                LY_TREE_DFS_END(elem, after, now);
-            }
+void finishChildNode(nodeConversionFrame &frame)
+{
+    lys_node *elem = frame.elem;
+    sdfCommon *com = frame.com;
+    if (!com)
+        return;
 
+    if (elem->parent && elem->parent->nodetype == LYS_AUGMENT)
+    {
+        addOriginNote(com, "augment-by",
+                avoidNull(elem->parent->module->name));
+    }
 
-            data->addObjectProperty(next);
-            com = next;
-        }
-        else if (elem->nodetype == LYS_NOTIF)
-        {
-            sdfEvent *event = new sdfEvent(avoidNull(elem->name),
-                    avoidNull(elem->dsc));
 
-            // translate the status of the notification
-            event->setDescription(statusToDescription(elem->flags,
-                    event->getDescription()));
-            // transfer the must statement to the description
-            event->setDescription(
-                    mustToDescription(
-                        ((lys_node_notif*)elem)->must,
-                        ((lys_node_notif*)elem)->must_size,
-                        event->getDescription()));
-            // Transfer extensions
-            for (int i = 0; i < elem->ext_size; i++)
-            {
-                addOriginNote(event, avoidNull(elem->ext[i]->def->name),
+    // if feature
+    string iffString = "";
+    int eIndex = 0, fIndex = 0;
+    if (elem->iffeature_size > 0 && elem->iffeature->expr
+            && elem->iffeature->features[0])
+    {
+        iffString = resolve_iffeature_recursive(elem->iffeature, &eIndex,
+                &fIndex, lys_main_module(elem->module));
+        addOriginNote(com, "if feature", iffString);
+    }
+    // remove sdf-spec
+    for (int i = 0; i < elem->ext_size; i++)
+    {
+        if (avoidNull(elem->ext[i]->def->name) != "sdf-spec")
+                addOriginNote(com, avoidNull(elem->ext[i]->def->name),
                         avoidNull(elem->ext[i]->arg_value));
-            }
+    }
+}
 
-            // buffer sdfObject to not put the grouping on object
-            // this is ok because there cannot be further notifications
-            // or actions in a notification
-            sdfObject *keepGrouping = new sdfObject();
-            sdfData *output = nodeToSdfData(elem, keepGrouping);
-            for (sdfData *grp : keepGrouping->getDatatypes())
-                event->addDatatype(grp);
-            output->setName("");
-            output->setDescription("");
-            event->setOutputData(output);
-            if (strcmp(node->name, "buffer") != 0
-                    && strcmp(node->name, "") != 0)
-            {
-                event->setDescription(
-                        "Notification from " + avoidNull(node->name) + ":\n\n"
-                        + event->getDescription());
-            }
-            object->addEvent(event);
+sdfData* nodeToSdfData(struct lys_node *node, sdfObject *object)
+{
+    if (!node)
+        return NULL;
 
-            for (int i = 0; i < ((lys_node_notif*)elem)->tpdf_size; i++)
-                event->addDatatype(typedefToSdfData(
-                        &((lys_node_notif*)elem)->tpdf[i]));
-                //object->addDatatype(typedefToSdfData(
-                //        &((lys_node_notif*)elem)->tpdf[i]));
+    // The nodes that are being converted, from the given node down to the
+    // innermost node (instead of recursing once per level)
+    vector<nodeConversionFrame> stack;
+    stack.push_back(openNodeConversion(node, object));
+    sdfData *finished = NULL;
+
+    while (!stack.empty())
+    {
+        nodeConversionFrame &frame = stack.back();
 
-            com = event;
+        // a child of the frame was converted on top of it
+        if (finished)
+        {
+            finishChildConversion(frame, finished);
+            finishChildNode(frame);
+            frame.elem = frame.elem->next;
+            finished = NULL;
         }
-        else if (elem->nodetype == LYS_USES)
+
+        // iterate over the child nodes until one has to be converted in a
+        // frame of its own
+        lys_node *descend = NULL;
+        sdfObject *descendObject = NULL;
+        for (; frame.elem; frame.elem = frame.elem->next)
         {
-            sdfData *uses;
-            // if there are alterations to the referenced grouping
-            // it cannot be referenced anymore but has to be inserted fully
-            // in the altered version
-            if (((lys_node_uses*)elem)->augment_size > 0
-                    || ((lys_node_uses*)elem)->refine_size > 0)
-                uses = nodeToSdfData(elem, object);
+            // if the node is marked to be ignored
+            if (frame.node->flags & IGNORE_NODE)
+                continue;
 
-            else
-            {
-                uses = new sdfData(avoidNull(elem->name),
-                    avoidNull(elem->dsc), "");
-                referencesLeft.push_back(tuple<string, string, sdfCommon*>{
-                    generatePath((lys_node*)((lys_node_uses*)elem)->grp),
-                    generatePath((lys_node*)((lys_node_uses*)elem)->grp, NULL,
-                            true),
-                   (sdfCommon*)uses});
-
-                // remove the prefix on the name of the uses if there is one
-                string name = uses->getName();
-                smatch sm;
-                regex r("[^:]*:(.*)");
-                if(regex_match(name, sm, r))
-                    uses->setName(sm[1].str());
-
-                // translate the status of the uses node
-                uses->setDescription(statusToDescription(elem->flags,
-                        uses->getDescription()));
-            }
+            // if the node is disabled by its if-features
+            if (nodeIsPruned(frame.elem))
+                continue;
 
-            if (((lys_node_uses*)elem)->when)
+            if (nodeNeedsConversionFrame(frame.elem))
             {
-                addOriginNote(uses, "when",
-                        avoidNull(((lys_node_uses*)elem)->when->cond));
+                descend = frame.elem;
+                descendObject = startChildConversion(frame);
+                break;
             }
-
-            data->addObjectProperty(uses);
-            com = uses;
+            convertChildInPlace(frame);
+            finishChildNode(frame);
         }
 
-        if (elem->parent && elem->parent->nodetype == LYS_AUGMENT)
+        if (descend)
         {
-            addOriginNote(com, "augment-by",
-                    avoidNull(elem->parent->module->name));
+            // frame is invalidated by push_back
+            stack.push_back(openNodeConversion(descend, descendObject));
+            continue;
         }
 
-
-        // if feature
-        iffString = "";
-        eIndex = 0;
-        fIndex = 0;
-        if (elem->iffeature_size > 0 && elem->iffeature->expr
-                && elem->iffeature->features[0])
-        {
-            iffString = resolve_iffeature_recursive(elem->iffeature, &eIndex,
-                    &fIndex);
-            addOriginNote(com, "if feature", iffString);
-        }
-        // remove sdf-spec
-        for (int i = 0; i < elem->ext_size; i++)
-        {
-            if (avoidNull(elem->ext[i]->def->name) != "sdf-spec")
-                    addOriginNote(com, avoidNull(elem->ext[i]->def->name),
-                            avoidNull(elem->ext[i]->arg_value));
-        }
+        // really add tpdfs to object or rather to last parent property etc?
+        // -> yes for now
+        finished = frame.data;
+        stack.pop_back();
     }
-    // really add tpdfs to object or rather to last parent property etc?
-    // -> yes for now
-    return data;
+
+    return finished;
 }
 
 sdfData* identToSdfData(struct lys_ident _ident)
@@ -1948,8 +2382,10 @@ sdfData* identToSdfData(struct lys_ident _ident)
             ref = new sdfData();
             ref->setName("base_" + to_string(j));
 
-            if (identities[_ident.base[j]->name])
-                ref->setReference(identities[_ident.base[j]->name]);
+            sdfCommon *base = findBySymbol(identities,
+                    avoidNull(_ident.base[j]->name));
+            if (base)
+                ref->setReference(base);
             else
             {
                 cerr << "identToSdfData: identity reference is null" << endl;
@@ -1964,8 +2400,10 @@ sdfData* identToSdfData(struct lys_ident _ident)
     }
     else if (_ident.base_size == 1)
     {
-        if (identities[_ident.base[0]->name])
-            ident->setReference(identities[_ident.base[0]->name]);
+        sdfCommon *base = findBySymbol(identities,
+                avoidNull(_ident.base[0]->name));
+        if (base)
+            ident->setReference(base);
         else
         {
             cerr << "typeToSdfData: identity reference is null" << endl;
@@ -1980,26 +2418,45 @@ sdfData* identToSdfData(struct lys_ident _ident)
     return ident;
 }
 
-vector<tuple<string, string, sdfCommon*>> assignReferences(
+vector<sdfData*> newIdentsToSdfData(lys_ident *idents, uint16_t ident_size)
+{
+    vector<sdfData*> converted;
+    sdfData *ident;
+    for (int i = 0; i < ident_size && idents; i++)
+    {
+        // identities of submodules that are included more than once are
+        // converted only once
+        if (convertedIdentities.find(&idents[i]) != convertedIdentities.end())
+            continue;
+
+        ident = identToSdfData(idents[i]);
+        convertedIdentities[&idents[i]] = ident;
+        identities[internSymbol(idents[i].name)] = ident;
+        converted.push_back(ident);
+    }
+    return converted;
+}
+
+vector<tuple<string, string, sdfCommon*>> assignReferences(
         vector<tuple<string, string, sdfCommon*>> refsLeft,
-        map<string, sdfCommon*> refs)
+        const unordered_map<sdfSymbol, sdfCommon*> &refs)
 {
     // check for references left unassigned
     string str, strWRef;
-    sdfCommon *com;
+    sdfCommon *com, *def;
     vector<tuple<string, string, sdfCommon*>> stillLeft = {};
 
     for (tuple<string, string, sdfCommon*> r : refsLeft)
     {
         tie(str, strWRef, com) = r;
-        if (com && refs[str])
-            com->setReference(refs[str]);
-        else if (com && refs[strWRef])
-            com->setReference(refs[strWRef]);
+        if (com && (def = findBySymbol(refs, str)))
+            com->setReference(def);
+        else if (com && (def = findBySymbol(refs, strWRef)))
+            com->setReference(def);
         // hot fix for leafrefs where only a path and no target node is
         // defined
-        else if (com && refs["/buffer" + str])
-            com->setReference(refs["/buffer" + str]);
+        else if (com && (def = findBySymbol(refs, "/buffer" + str)))
+            com->setReference(def);
         else
         {
             // Try to remove the prefix
@@ -2012,13 +2469,14 @@ vector<tuple<string, string, sdfCommon*>> assignReferences(
                 prefix =  sm[1].str() + ":";
                 search = sm.suffix().str();
             }
-            if (com && refs[strNoPrefix])
-                com->setReference(refs[strNoPrefix]);
+            if (com && (def = findBySymbol(refs, strNoPrefix)))
+                com->setReference(def);
             // hot fix, see above
-            else if (com && refs["/buffer" + strNoPrefix])
-                com->setReference(refs["/buffer" + strNoPrefix]);
-            else if (com && refs["/" + prefix + "buffer" + strWRef])
-                com->setReference(refs["/" + prefix + "buffer" + strWRef]);
+            else if (com && (def = findBySymbol(refs, "/buffer" + strNoPrefix)))
+                com->setReference(def);
+            else if (com && (def = findBySymbol(refs,
+                    "/" + prefix + "buffer" + strWRef)))
+                com->setReference(def);
             else
             {
                 stillLeft.push_back(r);
@@ -2059,7 +2517,8 @@ vector<tuple<string, string, sdfCommon*>> assignReferences(
                         ns = it->second;
                         topFile->getNamespace()->addNamespace(def, ns);
 
-                        vector<sdfData*> dtypes = topFile->getDatatypes();
+                        const vector<sdfData*> &dtypes =
+                                topFile->getDatatypes();
                         for (int i = 0; i < dtypes.size(); i++)
                         {
                             if (topFile->getInfo() && dtypes.at(i)->getName()
@@ -2081,6 +2540,83 @@ vector<tuple<string, string, sdfCommon*>> assignReferences(
 
 sdfFile* moduleToSdfFile(lys_module *module);
 
+/*
+ * Replaces the given pointer if it points to one of the promoted sdfData
+ * objects
+ */
+void redirectPromoted(sdfCommon *&com,
+        const map<sdfCommon*, sdfCommon*> &promoted)
+{
+    map<sdfCommon*, sdfCommon*>::const_iterator it = promoted.find(com);
+    if (it != promoted.end())
+        com = it->second;
+}
+
+vector<sdfProperty*> promoteToSdfProperties(const vector<sdfData*> &data,
+        sdfData *buf, sdfCommon *owner)
+{
+    // the vector might belong to the buffer which is changed below
+    vector<sdfData*> children = data;
+    vector<sdfProperty*> props;
+    map<sdfCommon*, sdfCommon*> promoted;
+    sdfProperty *p;
+    for (int i = 0; i < children.size(); i++)
+    {
+        // children that are shared with another node (e.g. the input data
+        // copied from a container with an action) must stay intact
+        if (children.at(i)->getParentCommon() != buf)
+        {
+            p = new sdfProperty(*children.at(i));
+            props.push_back(p);
+
+            // change entry in referencesLeft to match new sdfProperty
+            for (int j = 0; j < referencesLeft.size(); j++)
+            {
+                if (children.at(i) == get<2>(referencesLeft.at(j)))
+                    get<2>(referencesLeft.at(j)) = p;
+            }
+            children.erase(children.begin() + i--);
+            continue;
+        }
+
+        p = new sdfProperty(move(*children.at(i)));
+        props.push_back(p);
+        promoted[children.at(i)] = p;
+    }
+    if (promoted.empty())
+        return props;
+
+    // remove the promoted children from the buffer
+    for (sdfData *d : children)
+        buf->removeObjectProperty(d);
+
+    // redirect the pointers that were stored during the conversion
+    for (int i = 0; i < referencesLeft.size(); i++)
+        redirectPromoted(get<2>(referencesLeft.at(i)), promoted);
+    for (int i = 0; i < typerefs.size(); i++)
+        redirectPromoted(get<2>(typerefs.at(i)), promoted);
+    for (int i = 0; i < identsLeft.size(); i++)
+        redirectPromoted(get<2>(identsLeft.at(i)), promoted);
+    unordered_map<sdfSymbol, sdfCommon*>::iterator it;
+    for (it = leafs.begin(); it != leafs.end(); it++)
+        redirectPromoted(it->second, promoted);
+    for (it = branchRefs.begin(); it != branchRefs.end(); it++)
+        redirectPromoted(it->second, promoted);
+    if (owner)
+    {
+        vector<sdfCommon*> reqs = owner->getRequired();
+        for (int i = 0; i < reqs.size(); i++)
+            redirectPromoted(reqs.at(i), promoted);
+        owner->setRequired(move(reqs));
+    }
+
+    // the moved-from sdfData objects are empty now
+    for (sdfData *d : children)
+        delete d;
+
+    return props;
+}
+
 sdfObject* containerToSdfObject(lys_node_container *cont, sdfObject *object)
 {
     if (!object)
@@ -2095,22 +2631,13 @@ sdfObject* containerToSdfObject(lys_node_container *cont, sdfObject *object)
     sdfData *buf = nodeToSdfData((lys_node*)cont, object);
     object->setDescription(buf->getDescription());
 
-    vector<sdfData*> bufProps = buf->getObjectProperties();
-    sdfProperty *p;
-    for (int i = 0; i < bufProps.size(); i++)
-    {
-        p = new sdfProperty(*bufProps.at(i));
-        object->addProperty(p);
+    vector<sdfProperty*> props = promoteToSdfProperties(
+            buf->getObjectProperties(), buf, object);
+    for (int i = 0; i < props.size(); i++)
+        object->addProperty(props.at(i));
 
-        // change entry in referencesLeft to match new sdfProperty
-        for (int j = 0; j < referencesLeft.size(); j++)
-        {
-            if (bufProps.at(i) == get<2>(referencesLeft.at(j)))
-                get<2>(referencesLeft.at(j)) = p;
-            //if (bufProps.at(i) == get<sdfCommon*>(referencesLeft.at(j)))
-            //    get<sdfCommon*>(referencesLeft.at(j)) = p;
-        }
-    }
+    // nothing refers to the buffer itself
+    delete buf;
 
     return object;
 }
@@ -2134,6 +2661,9 @@ sdfThing* containerToSdfThing(lys_node_container *cont, sdfThing *thing)
     sdfObject *o;
     for (lys_node *elem = cont->child; elem; elem = elem->next)
     {
+        if (nodeIsPruned(elem))
+            continue;
+
         origin = sdfSpecExtToString(elem->ext, elem->ext_size);
         if (elem->nodetype == LYS_CONTAINER)
         {
@@ -2161,23 +2691,16 @@ sdfThing* containerToSdfThing(lys_node_container *cont, sdfThing *thing)
 sdfFile* moduleToSdfFile(lys_module *module)
 {
     sdfFile *file = new sdfFile();
+    convertedFiles.push_back(file);
+    // all nodes converted from the module are allocated in the file's arena
+    sdfArenaScope arenaScope(file->getArena());
 
-    // The description of the module is searched for the terms 'license' and
-    // 'copyright' to transfer matching paragraphs
-    string copyright;
-    string dsc = avoidNull(module->dsc);
-    // find a paragraph that starts with 'Copyright'
-    regex copyrightRegex("[Cc]opyright.*(\n.+)*");
-    smatch sm;
-    regex_search(dsc, sm, copyrightRegex);
-    copyright = sm[0];
-    string license;
-    // find a paragraph that contains the word 'license'
-    regex licenseRegex("(.+\n)*.*[Ll]icense.*(\n.+)*");
-    regex_search(dsc, sm, licenseRegex);
-    license = sm[0];
+    // The copyright and license paragraphs of the description as well as the
+    // organization, contact and revisions are collected in a single pass
+    moduleInfo info = extractModuleInfo(module);
     file->setInfo(new sdfInfoBlock(avoidNull(module->name),
-            avoidNull(module->rev->date), copyright, license));
+            info.revisions.empty() ? "" : info.revisions[0], info.copyright,
+            info.license));
 
     // Convert the namespace information
     map<string, string> nsMap;
@@ -2185,28 +2708,33 @@ sdfFile* moduleToSdfFile(lys_module *module)
     file->setNamespace(new sdfNamespaceSection(nsMap,
             avoidNull(module->prefix)));
 
-    // add an extra sdfData for module info
+    // add an extra sdfData for module info, its conversion notes are
+    // appended to the description before it is set
     sdfData *mInfo = new sdfData();
     mInfo->setName(avoidNull(module->name) + "-info");
-    mInfo->setDescription(avoidNull(module->dsc));
+    string infoDsc = avoidNull(module->dsc);
 
     if (module->ref)
-        addOriginNote(mInfo, "reference", avoidNull(module->ref));
+        appendOriginNote(infoDsc, "reference", info.reference);
 
-    for (int i = 0; i < module->rev_size; i++)
-        addOriginNote(mInfo, "revision", avoidNull(module->rev[i].date));
+    for (const string &rev : info.revisions)
+        appendOriginNote(infoDsc, "revision", rev);
 
     if (module->org)
-        addOriginNote(mInfo, "organization", avoidNull(module->org));
+        appendOriginNote(infoDsc, "organization", info.organization);
 
     if (module->contact)
-        addOriginNote(mInfo, "contact", avoidNull(module->contact));
+        appendOriginNote(infoDsc, "contact", info.contact);
 
     if (module->augment_size > 0)
-        addOriginNote(mInfo, "augment_size", to_string(module->augment_size));
+        appendOriginNote(infoDsc, "augment_size",
+                to_string(module->augment_size));
 
     for (int i = 0; i < module->features_size; i++)
-        addOriginNote(mInfo, "feature", avoidNull(module->features[i].name));
+        appendOriginNote(infoDsc, "feature",
+                avoidNull(module->features[i].name));
+
+    mInfo->setDescription(move(infoDsc));
 
     if (!mInfo->getDescription().empty())
         file->addDatatype(mInfo);
@@ -2225,19 +2753,16 @@ sdfFile* moduleToSdfFile(lys_module *module)
     module->data = (lys_node*)topNode.get();
     for (lys_node *elem = topNode->child; elem; elem = elem->next)
         elem->parent = (lys_node*)topNode.get();
+    bufferedModules.push_back(module);
 
     // Translate typedefs of the module to sdfData of the sdfObject
-    for (int i = 0; i < module->tpdf_size; i++)
-        file->addDatatype(typedefToSdfData(&module->tpdf[i]));
+    for (sdfData *t : newTypedefsToSdfData(module->tpdf, module->tpdf_size))
+        file->addDatatype(t);
 
     // Translate identities of the module to sdfData of the sdfObject
-    sdfData *ident;
-    for (int i = 0; i < module->ident_size; i++)
-    {
-        ident = identToSdfData(module->ident[i]);
+    for (sdfData *ident : newIdentsToSdfData(module->ident,
+            module->ident_size))
         file->addDatatype(ident);
-        identities[module->ident[i].name] = ident;
-    }
 
     // Add identities and typedefs of the submodule to the sdfObject
     // What about the other members of submodule and further levels of
@@ -2246,17 +2771,13 @@ sdfFile* moduleToSdfFile(lys_module *module)
     // by libyang automatically
     for (int i = 0; i < module->inc_size; i++)
     {
-        for (int j = 0; j < module->inc[i].submodule->tpdf_size; j++)
-            file->addDatatype(typedefToSdfData(
-                    &module->inc[i].submodule->tpdf[j]));
+        lys_submodule *sub = module->inc[i].submodule;
+        for (sdfData *t : newTypedefsToSdfData(sub->tpdf, sub->tpdf_size))
+            file->addDatatype(t);
 
-        sdfData *ident;
-        for (int j = 0; j < module->inc[i].submodule->ident_size; j++)
-        {
-            ident = identToSdfData(module->inc[i].submodule->ident[j]);
+        for (sdfData *ident : newIdentsToSdfData(sub->ident,
+                sub->ident_size))
             file->addDatatype(ident);
-            identities[module->inc[i].submodule->ident[j].name] = ident;
-        }
     }
 
     // Translate imported modules
@@ -2271,8 +2792,17 @@ sdfFile* moduleToSdfFile(lys_module *module)
                 string(module->imp[i].module->name)) == alreadyImported.end())
         {
             sdfFile *importF = moduleToSdfFile(module->imp[i].module);
-            importF->toFile(outputDirString
-                    + avoidNull(module->imp[i].module->name) + ".sdf.json");
+            string importFileName = avoidNull(module->imp[i].module->name)
+                    + sdfFormatExtension(sdfFormatSetting);
+            if (importBuffers)
+            {
+                json importJson = importF->toJson(json());
+                validateJson(importJson);
+                (*importBuffers)[importFileName] =
+                        encodeSdf(importJson, sdfFormatSetting);
+            }
+            else
+                importF->toFile(outputDirString + importFileName);
 
             alreadyImported.push_back(avoidNull(module->imp[i].module->name));
         }
@@ -2292,53 +2822,42 @@ sdfFile* moduleToSdfFile(lys_module *module)
         return file;
 
     // first mark containers that are to be converted to objects or things
-    map<string, bool> alreadyAdded;
+    unordered_map<sdfSymbol, bool> alreadyAdded;
     vector<lys_node*> remove;
     for (lys_node *elem = topNode->child; elem; elem = elem->next)
     {
         if (elem->nodetype == LYS_CONTAINER)
         {
-            alreadyAdded[avoidNull(elem->name)] = true;
+            alreadyAdded[internSymbol(elem->name)] = true;
             elem->flags |= IGNORE_NODE;
         }
         else
-            alreadyAdded[avoidNull(elem->name)] = false;
+            alreadyAdded[internSymbol(elem->name)] = false;
     }
 
     // create a buffer sdfObject to be able to use existing methods
-    sdfProperty *p;
     sdfObject *bufObject = new sdfObject();
     sdfData *buf = nodeToSdfData((lys_node*)topNode.get(), bufObject);
 
-    vector<sdfData*> bufProps = buf->getObjectProperties();
-    for (int i = 0; i < bufProps.size(); i++)
-    {
-        // only add if not already added (from container)
-        if (!alreadyAdded[bufProps.at(i)->getName()])
-        {
-            p = new sdfProperty(*bufProps.at(i));
-            file->addProperty(p);
-
-            // change entry in referencesLeft to match new sdfProperty
-            for (int j = 0; j < referencesLeft.size(); j++)
-            {
-                //if (bufProps.at(i) == get<sdfCommon*>(referencesLeft.at(j)))
-                //    get<sdfCommon*>(referencesLeft.at(j)) = p;
-                if (bufProps.at(i) == get<2>(referencesLeft.at(j)))
-                    get<2>(referencesLeft.at(j)) = p;
-            }
-        }
-    }
+    // only add if not already added (from container)
+    vector<sdfData*> bufProps;
+    for (sdfData *d : buf->getObjectProperties())
+        if (!findBySymbol(alreadyAdded, d->getName()))
+            bufProps.push_back(d);
+    vector<sdfProperty*> props = promoteToSdfProperties(bufProps, buf,
+            bufObject);
+    for (int i = 0; i < props.size(); i++)
+        file->addProperty(props.at(i));
 
-    vector<sdfAction*> bufActions = bufObject->getActions();
+    const vector<sdfAction*> &bufActions = bufObject->getActions();
     for (int i = 0; i < bufActions.size(); i++)
         file->addAction(bufActions.at(i));
 
-    vector<sdfEvent*> bufEvents = bufObject->getEvents();
+    const vector<sdfEvent*> &bufEvents = bufObject->getEvents();
     for (int i = 0; i < bufEvents.size(); i++)
         file->addEvent(bufEvents.at(i));
 
-    vector<sdfData*> bufDatatypes = bufObject->getDatatypes();
+    const vector<sdfData*> &bufDatatypes = bufObject->getDatatypes();
     for (int i = 0; i < bufDatatypes.size(); i++)
         file->addDatatype(bufDatatypes.at(i));
 
@@ -2355,6 +2874,9 @@ sdfFile* moduleToSdfFile(lys_module *module)
         if (elem->nodetype == LYS_CONTAINER)
         {
             elem->flags &= ~IGNORE_NODE;
+            if (nodeIsPruned(elem))
+                continue;
+
             lys_node_container *cont = (lys_node_container*)elem;
 
             // this only happens in round trips
@@ -2372,7 +2894,7 @@ sdfFile* moduleToSdfFile(lys_module *module)
     }
 
     // check for references left unassigned
-    map<string, sdfCommon*> existingConversions;
+    unordered_map<sdfSymbol, sdfCommon*> existingConversions;
     existingConversions.insert(leafs.begin(), leafs.end());
     existingConversions.insert(branchRefs.begin(), branchRefs.end());
     referencesLeft = assignReferences(referencesLeft, existingConversions);
@@ -2384,6 +2906,26 @@ sdfFile* moduleToSdfFile(lys_module *module)
         +  to_string(referencesLeft.size()+typerefs.size()+identsLeft.size())
         + " unresolved references remaining" << endl;
 
+    // shared subtrees can only be collapsed once all references are assigned
+    if (deduplicationSetting)
+    {
+        unordered_set<sdfCommon*> keep;
+        for (auto &it : existingConversions)
+            keep.insert(it.second);
+        for (auto &it : typedefs)
+            keep.insert(it.second);
+        for (auto &it : identities)
+            keep.insert(it.second);
+        for (auto &it : convertedTypedefs)
+            keep.insert(it.second);
+        for (auto &it : convertedIdentities)
+            keep.insert(it.second);
+        for (auto *refs : {&referencesLeft, &typerefs, &identsLeft})
+            for (auto &ref : *refs)
+                keep.insert(get<2>(ref));
+        file->deduplicateData(keep);
+    }
+
     return file;
 }
 
@@ -2477,6 +3019,147 @@ vector<tuple<string, string>> extractConvNote(sdfCommon *com)
     return result;
 }
 
+/*
+ * Look up whether a feature is enabled by its (prefixed) name. The prefix is
+ * resolved to a namespace by ns, names without prefix belong to the default
+ * namespace. Features whose namespace is not that of a module in
+ * profiledModules (or cannot be resolved) count as enabled.
+ */
+static bool featureNameEnabled(const string &name, sdfNamespaceSection *ns)
+{
+    if (!ns)
+        return true;
+
+    size_t colon = name.find(':');
+    string prefix = ns->getDefaultNamespace();
+    string feature = name;
+    if (colon != string::npos)
+    {
+        prefix = name.substr(0, colon);
+        feature = name.substr(colon + 1);
+    }
+
+    map<string, string> namespaces = ns->getNamespaces();
+    map<string, string>::const_iterator it = namespaces.find(prefix);
+    if (it == namespaces.end())
+        return true;
+
+    for (const lys_module *module : profiledModules)
+    {
+        if (avoidNull(module->ns) != it->second)
+            continue;
+
+        for (int i = 0; i < module->features_size; i++)
+        {
+            if (avoidNull(module->features[i].name) == feature)
+                return lys_features_state(module, feature.c_str()) == 1;
+        }
+        return true;
+    }
+    return true;
+}
+
+/*
+ * Evaluate the tokens of an if-feature expression from position pos on,
+ * level is the precedence to parse (0: or, 1: and, 2: not and operands)
+ */
+static bool evaluateIffeatureTokens(const vector<string> &tokens, size_t &pos,
+        int level, sdfNamespaceSection *ns)
+{
+    if (level == 2)
+    {
+        if (pos >= tokens.size())
+            return true;
+
+        const string &token = tokens[pos++];
+        if (token == "not")
+            return !evaluateIffeatureTokens(tokens, pos, 2, ns);
+
+        if (token == "(")
+        {
+            bool value = evaluateIffeatureTokens(tokens, pos, 0, ns);
+            if (pos < tokens.size() && tokens[pos] == ")")
+                pos++;
+            return value;
+        }
+        return featureNameEnabled(token, ns);
+    }
+
+    string op = level == 0 ? "or" : "and";
+    bool value = evaluateIffeatureTokens(tokens, pos, level + 1, ns);
+    while (pos < tokens.size() && tokens[pos] == op)
+    {
+        pos++;
+        bool operand = evaluateIffeatureTokens(tokens, pos, level + 1,
+                ns);
+        value = level == 0 ? value || operand : value && operand;
+    }
+    return value;
+}
+
+bool iffeatureStringValue(const string &expr, sdfNamespaceSection *ns)
+{
+    // split the expression into names, operators and parentheses
+    vector<string> tokens;
+    string token;
+    for (char c : expr)
+    {
+        if (isspace(c) || c == '(' || c == ')')
+        {
+            if (token != "")
+                tokens.push_back(token);
+            token = "";
+            if (c == '(' || c == ')')
+                tokens.push_back(string(1, c));
+        }
+        else
+            token += c;
+    }
+    if (token != "")
+        tokens.push_back(token);
+
+    size_t pos = 0;
+    return evaluateIffeatureTokens(tokens, pos, 0, ns);
+}
+
+/*
+ * Find the namespace section that applies to an SDF element, i.e. that of its
+ * file or else that of the closest sdfObject or sdfThing that has one
+ */
+static sdfNamespaceSection* namespaceOfElement(sdfCommon *com)
+{
+    sdfFile *file = com->getTopLevelFile();
+    if (file && file->getNamespace())
+        return file->getNamespace();
+
+    for (sdfCommon *parent = com; parent; parent = parent->getParent())
+    {
+        sdfObject *object = dynamic_cast<sdfObject*>(parent);
+        if (object && object->getNamespace())
+            return object->getNamespace();
+        sdfThing *thing = dynamic_cast<sdfThing*>(parent);
+        if (thing && thing->getNamespace())
+            return thing->getNamespace();
+    }
+    return NULL;
+}
+
+bool sdfElementIsPruned(sdfCommon *com)
+{
+    if (featureProfile.empty() || !com)
+        return false;
+
+    // the note 'if feature expr' is split into 'if' and 'feature expr'
+    for (const tuple<string, string> &note : extractConvNote(com))
+    {
+        if (get<0>(note) == "if" && get<1>(note).compare(0, 8, "feature ") == 0
+                && !iffeatureStringValue(get<1>(note).substr(8),
+                        namespaceOfElement(com)))
+            return true;
+    }
+    return false;
+}
+
 /*
  * RFC 7950 3. Terminology: A mandatory node is
  * a leaf/choice/anydata/anyxml node with "mandatory true",
@@ -2485,41 +3168,48 @@ vector<tuple<string, string>> extractConvNote(sdfCommon *com)
  */
 bool setMandatory(lys_node *node, bool firstLevel)
 {
-    if (!node)
-        return false;
-
     // Go further until ALL child nodes are mandatory? no
 
-    // leaf/choice nodes can be assigned the mandatory flag directly
-    if (node->nodetype & (LYS_LEAF | LYS_CHOICE))
-    {
-        node->flags |= LYS_MAND_TRUE;
-        return true;
-    }
-    if (node->nodetype & (LYS_LEAFLIST | LYS_LIST))
+    // the nodes left to look at, the following siblings of a node are looked
+    // at before its children (the siblings of the first level are left out)
+    vector<lys_node*> stack = {node};
+    while (!stack.empty())
     {
-        if (((lys_node_list*)node)->min < 1)
-            ((lys_node_list*)node)->min = 1;
-        return true;
-    }
-    if (node->nodetype & LYS_CONTAINER)
-        ((lys_node_container*)node)->presence = NULL;
+        node = stack.back();
+        stack.pop_back();
+        if (!node)
+            continue;
 
-    bool success = false;
-    if (!firstLevel)
-        success = setMandatory(node->next, false);
+        // leaf/choice nodes can be assigned the mandatory flag directly
+        if (node->nodetype & (LYS_LEAF | LYS_CHOICE))
+        {
+            node->flags |= LYS_MAND_TRUE;
+            return true;
+        }
+        if (node->nodetype & (LYS_LEAFLIST | LYS_LIST))
+        {
+            if (((lys_node_list*)node)->min < 1)
+                ((lys_node_list*)node)->min = 1;
+            return true;
+        }
+        if (node->nodetype & LYS_CONTAINER)
+            ((lys_node_container*)node)->presence = NULL;
 
-    if (!success)
-        success = setMandatory(node->child, false);
+        stack.push_back(node->child);
+        if (!firstLevel)
+            stack.push_back(node->next);
+        firstLevel = false;
+    }
 
-    return success;
+    return false;
 }
 
-void sdfRequiredToNode(vector<sdfCommon*> reqs, lys_module &module)
+void sdfRequiredToNode(const vector<sdfCommon*> &reqs, lys_module &module)
 {
     for (int i = 0; i < reqs.size(); i++)
     {
-        lys_node *node = pathsToNodes[reqs[i]->generateReferenceString(true)];
+        lys_node *node = findBySymbol(pathsToNodes,
+                reqs[i]->generateReferenceString(true));
         if (!node)
             cerr << "Node " + reqs[i]->getName() + " not found" << endl;
 
@@ -2620,7 +3310,7 @@ void fillLysType(sdfData *data, struct lys_type &type,
         type.base = LY_TYPE_ENUM;
         type.der = &enumTpdf;
         int enmSize = data->getEnumString().size();
-        vector<string> enm = data->getEnumString();
+        const vector<string> &enm = data->getEnumString();
         type.info.enums.count = enmSize;
         shared_ptr<lys_type_enum[]> e(new lys_type_enum[enmSize]());
         storeVoidPointer((shared_ptr<void>)e);
@@ -2938,7 +3628,7 @@ void fillLysType(sdfData *data, struct lys_type &type,
     else if (type.base == LY_TYPE_IDENT)
     {
         type.der = &identTpdf;
-        vector<sdfData*> op = data->getObjectProperties();
+        const vector<sdfData*> &op = data->getObjectProperties();
         sdfCommon *ref = data->getReference();
         shared_ptr<lys_ident*[]> refs(new lys_ident*[ref? 1 : op.size()]());
         if (!op.empty() || ref )
@@ -2979,7 +3669,7 @@ void fillLysType(sdfData *data, struct lys_type &type,
     {
         type.der = &bitsTpdf;
 
-        vector<sdfData*> op = data->getObjectProperties();
+        const vector<sdfData*> &op = data->getObjectProperties();
         shared_ptr<lys_type_bit[]> bits(new lys_type_bit[op.size()]());
         storeVoidPointer((shared_ptr<void>)bits);
         type.info.bits.bit = bits.get();
@@ -3003,7 +3693,7 @@ void fillLysType(sdfData *data, struct lys_type &type,
     else if (type.base == LY_TYPE_UNION)
     {
         type.der = &unionTpdf;
-        vector<sdfData*> choices = data->getChoice();
+        const vector<sdfData*> &choices = data->getChoice();
 
         type.info.uni.count = choices.size();
         shared_ptr<lys_type[]> t(new lys_type[type.info.uni.count]());
@@ -3127,7 +3817,7 @@ lys_type* sdfRefToType(string refString, lys_type *type)
     // element referenced by refString
     for (int i = 0; i < tpdfStore.size(); i++)
     {
-        if (pathsToNodes[refString] == (lys_node*)tpdfStore[i])
+        if (findBySymbol(pathsToNodes, refString) == (lys_node*)tpdfStore[i])
         {
             type->der = tpdfStore[i];
             return type;
@@ -3140,24 +3830,41 @@ lys_type* sdfRefToType(string refString, lys_type *type)
 
 lys_node_leaf* findLeafInSubtreeRecursive(lys_node *node)
 {
+    // the nodes whose subtrees are searched, each with the child to look at
+    // next and whether only the used groupings are left to search
+    vector<tuple<lys_node*, lys_node*, bool>> stack;
     cout << "looking in " << avoidNull(node->name) << endl;
+    stack.push_back({node, node->child, false});
+
     lys_node_leaf* found = NULL;
-    for (lys_node *child = node->child; !found && child; child = child->next)
+    lys_node *parent, *child;
+    bool usesLeft;
+    while (!found && !stack.empty())
     {
-        if (child->nodetype == LYS_LEAF)
-            found = (lys_node_leaf*)child;
-        else
-            found = findLeafInSubtreeRecursive(child);
+        tie(parent, child, usesLeft) = stack.back();
+        if (!child)
+        {
+            // only look in used groupings if nothing else found
+            stack.pop_back();
+            if (!usesLeft)
+                stack.push_back({parent, parent->child, true});
+            continue;
+        }
+        get<1>(stack.back()) = child->next;
 
-    }
-    // only look in used groupings if nothing else found
-    for (lys_node *child = node->child; !found && child; child = child->next)
-    {
-        if (child->nodetype == LYS_USES)
+        if (!usesLeft && child->nodetype == LYS_LEAF)
+            found = (lys_node_leaf*)child;
+        else if (!usesLeft)
         {
-            cout << "uses in " << avoidNull(node->name) << endl;
-            lys_node_grp *g = ((lys_node_uses*)child)->grp;
-            found = findLeafInSubtreeRecursive((lys_node*)g);
+            cout << "looking in " << avoidNull(child->name) << endl;
+            stack.push_back({child, child->child, false});
+        }
+        else if (child->nodetype == LYS_USES)
+        {
+            cout << "uses in " << avoidNull(parent->name) << endl;
+            lys_node *g = (lys_node*)((lys_node_uses*)child)->grp;
+            cout << "looking in " << avoidNull(g->name) << endl;
+            stack.push_back({g, g->child, false});
         }
     }
 
@@ -3197,7 +3904,7 @@ lys_node* sdfRefToNode(sdfCommon *com, lys_node *node, lys_module &module,
     for (int i = 0; i < size; i++)
     {
         if (ref && nodeStore[i]
-                && pathsToNodes[refString] == nodeStore[i].get())
+                && findBySymbol(pathsToNodes, refString) == nodeStore[i].get())
         {
             // find out if the node is part of a grouping
             bool isInGrp = false;
@@ -3395,7 +4102,7 @@ lys_node* sdfRefToNode(sdfCommon *com, lys_node *node, lys_module &module,
 
                 removeNode(*node);
 
-                pathsToNodes[refString] =
+                pathsToNodes[internSymbol(refString)] =
                         (lys_node*)grp.get();
                 storeNode((shared_ptr<lys_node>&)grp);
                 storeNode((shared_ptr<lys_node>&)uses2);
@@ -3504,7 +4211,7 @@ lys_node* sdfRefToNode(sdfCommon *com, lys_node *node, lys_module &module,
     // element referenced by sdfRef (ref)
     for (int i = 0; i < tpdfStore.size(); i++)
     {
-        if (ref && pathsToNodes[refString]
+        if (ref && findBySymbol(pathsToNodes, refString)
                                 == (lys_node*)tpdfStore[i])
         {
             lys_type *type;
@@ -3558,7 +4265,7 @@ struct lys_tpdf* sdfDataToTypedef(sdfData *data, lys_tpdf *tpdf,
              tuple<sdfCommon*, lys_tpdf*>{data, tpdf});
     }
 
-    pathsToNodes[data->generateReferenceString(NULL, true)] =
+    pathsToNodes[internSymbol(data->generateReferenceString(NULL, true))] =
             (lys_node*)tpdf;
     setSdfSpecExtension(tpdf, "sdfData");
 
@@ -3575,6 +4282,10 @@ lys_node* sdfDataToNode(sdfData *data, lys_node *node, lys_module &module,
         return NULL;
     }
 
+    // the element is disabled by its if-features
+    if (sdfElementIsPruned(data))
+        return NULL;
+
     sdfData *itemConstrWithRefs = data->getItemConstrOfRefs();
     sdfData *ref = data->getSdfDataReference();
 
@@ -3622,8 +4333,8 @@ lys_node* sdfDataToNode(sdfData *data, lys_node *node, lys_module &module,
         cont->nodetype = LYS_CONTAINER;
         cont->presence = storeString(origPresence);
         lys_node *childNode;
-        vector<sdfData*> properties = data->getObjectProperties();
-        vector<string> req = data->getRequiredObjectProperties();
+        const vector<sdfData*> &properties = data->getObjectProperties();
+        const vector<string> &req = data->getRequiredObjectProperties();
         vector<sdfCommon*> reqComs = {};
         for (int i = 0; i < properties.size(); i++)
         {
@@ -3851,6 +4562,9 @@ lys_node* sdfDataToNode(sdfData *data, lys_node *node, lys_module &module,
         lys_node *n;
         for (sdfData *c : data->getChoice())
         {
+            if (sdfElementIsPruned(c))
+                continue;
+
             shared_ptr<lys_node_case> caseP =
                     shared_ptr<lys_node_case>(new lys_node_case());
 
@@ -3886,7 +4600,8 @@ lys_node* sdfDataToNode(sdfData *data, lys_node *node, lys_module &module,
 
     sdfRequiredToNode(data->getRequired(), module);
 
-    pathsToNodes[data->generateReferenceString(NULL, true)] = node;
+    pathsToNodes[internSymbol(data->generateReferenceString(NULL, true))] =
+            node;
 
     // identityrefs are separately assigned so keep them out
     lys_node_leaf *l = (lys_node_leaf*)node;
@@ -3974,7 +4689,7 @@ lys_node* sdfDataToNode(sdfData *data, lys_node *node, lys_module &module,
     return node;
 }
 
-void convertDatatypes(vector<sdfData*> datatypes, lys_module &module,
+void convertDatatypes(const vector<sdfData*> &datatypes, lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType)
@@ -4092,7 +4807,7 @@ void convertDatatypes(vector<sdfData*> datatypes, lys_module &module,
             module.ident[s].dsc = storeString(dsc);
             module.ident[s].module = &module;
 
-            vector<sdfData*> op = data->getObjectProperties();
+            const vector<sdfData*> &op = data->getObjectProperties();
             sdfCommon *ref = data->getReference();
             shared_ptr<lys_ident*[]> bases(
                     new lys_ident*[ref? 1 : op.size()]());
@@ -4136,7 +4851,8 @@ void convertDatatypes(vector<sdfData*> datatypes, lys_module &module,
 
             module.ident[s].flags |= flags;
             module.ident[s].ref = storeString(origRef);
-            identStore[data->sdfCommon::generateReferenceString(true)] =
+            identStore[internSymbol(
+                    data->sdfCommon::generateReferenceString(true))] =
                     &module.ident[s];
             module.ident_size++;
         }
@@ -4180,7 +4896,8 @@ void convertDatatypes(vector<sdfData*> datatypes, lys_module &module,
             grp->name = storeString(data->getName());
 
             addNode(*storeNode((shared_ptr<lys_node>&)grp), module);
-            pathsToNodes[data->generateReferenceString(NULL, true)] =
+            pathsToNodes[internSymbol(
+                    data->generateReferenceString(NULL, true))] =
                     (lys_node*)grp.get();
 
             setSdfSpecExtension((lys_node*)grp.get(), "sdfData");
@@ -4362,7 +5079,7 @@ void assignOpenRefs(lys_module &module,
                 removeNode((lys_node&)*aug);
                 mod->augment[mod->augment_size] = *aug;
                 aug = &mod->augment[mod->augment_size];
-                target = pathsToNodes[targetRef];
+                target = findBySymbol(pathsToNodes, targetRef);
                 aug->target = target;
                 aug->target_name = storeString(
                         generatePath(target, target->module, true));
@@ -4414,9 +5131,10 @@ void assignOpenRefs(lys_module &module,
     for (int i = 0; i < openBaseIdent.size(); i++)
     {
         tie(str, id) = openBaseIdent[i];
-        if (identStore[str])
+        lys_ident *ident = findBySymbol(identStore, str);
+        if (ident)
         {
-            *id = identStore[str];
+            *id = ident;
             openBaseIdent.erase(openBaseIdent.begin() + i--);
         }
     }
@@ -4461,7 +5179,7 @@ void importHelper(lys_module &module)
     module.imp[0].prefix = helper->prefix;
 }
 
-void convertProperties(vector<sdfProperty*> props, lys_module &module,
+void convertProperties(const vector<sdfProperty*> &props, lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType)
 {
@@ -4481,13 +5199,16 @@ void convertProperties(vector<sdfProperty*> props, lys_module &module,
     }
 }
 
-void convertActions(vector<sdfAction*> actions, lys_module &module,
+void convertActions(const vector<sdfAction*> &actions, lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType)
 {
     for (int i = 0; i < actions.size(); i++)
     {
+        if (sdfElementIsPruned(actions[i]))
+            continue;
+
         shared_ptr<lys_node_rpc_action> action(new lys_node_rpc_action());
         action->name = storeString(actions[i]->getName());
         action->dsc = storeString(actions[i]->getDescription());
@@ -4561,13 +5282,16 @@ void convertActions(vector<sdfAction*> actions, lys_module &module,
     }
 }
 
-void convertEvents(vector<sdfEvent*> events, lys_module &module,
+void convertEvents(const vector<sdfEvent*> &events, lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType)
 {
     for (int i = 0; i < events.size(); i++)
     {
+        if (sdfElementIsPruned(events[i]))
+            continue;
+
         shared_ptr<lys_node_notif> notif(new lys_node_notif());
         notif->name = storeString(events[i]->getName());
         notif->dsc = storeString(events[i]->getDescription());
@@ -4608,7 +5332,8 @@ struct lys_module* sdfThingToModule(sdfThing &thing, lys_module &module,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType);
 
-vector<lys_node*> convertThings(vector<sdfThing*> things, lys_module &module,
+vector<lys_node*> convertThings(const vector<sdfThing*> &things,
+        lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType)
@@ -4617,6 +5342,9 @@ vector<lys_node*> convertThings(vector<sdfThing*> things, lys_module &module,
 
     for (int i = 0; i < things.size(); i++)
     {
+        if (sdfElementIsPruned(things[i]))
+            continue;
+
         sdfThingToModule(*things[i], module, openRefs, openRefsTpdf,
                 openRefsType);
 
@@ -4659,7 +5387,8 @@ vector<lys_node*> convertThings(vector<sdfThing*> things, lys_module &module,
 
         conts.push_back(storeNode((shared_ptr<lys_node>&)cont));
 
-        pathsToNodes[things[i]->generateReferenceString(NULL, true)] =
+        pathsToNodes[internSymbol(
+                things[i]->generateReferenceString(NULL, true))] =
                 (lys_node*)cont.get();
 
         if (things[i]->getReference())
@@ -4734,7 +5463,8 @@ struct lys_module* sdfObjectToModule(sdfObject &object, lys_module &module,
     return &module;
 }
 
-vector<lys_node*> convertObjects(vector<sdfObject*> objects, lys_module &module,
+vector<lys_node*> convertObjects(const vector<sdfObject*> &objects,
+        lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType)
@@ -4743,6 +5473,9 @@ vector<lys_node*> convertObjects(vector<sdfObject*> objects, lys_module &module,
 
     for (int i = 0; i < objects.size(); i++)
     {
+        if (sdfElementIsPruned(objects[i]))
+            continue;
+
         sdfObjectToModule(*objects[i], module, openRefs, openRefsTpdf,
                 openRefsType);
 
@@ -4790,7 +5523,8 @@ vector<lys_node*> convertObjects(vector<sdfObject*> objects, lys_module &module,
 
         conts.push_back(storeNode((shared_ptr<lys_node>&)cont));
 
-        pathsToNodes[objects[i]->generateReferenceString(NULL, true)] =
+        pathsToNodes[internSymbol(
+                objects[i]->generateReferenceString(NULL, true))] =
                 (lys_node*)cont.get();
 
         if (objects[i]->getReference())
@@ -4934,7 +5668,21 @@ struct lys_module* sdfFileToModule(sdfFile &file, lys_module &module,
     {
         lys_module *m = module.imp[i].module;
 
-        if (m != helper)
+        if (m != helper && importBuffers)
+        {
+            char *mStr = NULL;
+            cout << "Printing imported module " << avoidNull(m->name) << endl;
+            if (lys_print_mem(&mStr, m, LYS_OUT_YANG, NULL, 0, 0) == 0
+                    && mStr)
+            {
+                (*importBuffers)[avoidNull(m->name) + ".yang"] = mStr;
+                cout << "-> successful" << endl;
+            }
+            else
+                cerr << "-> failed" << endl;
+            free(mStr);
+        }
+        else if (m != helper)
         {
             string mFileName = outputDirString + string(m->name) + ".yang";
             const char * mFileNameChar = storeString(mFileName);
@@ -4989,173 +5737,393 @@ struct lys_module* sdfFileToModule(sdfFile &file, lys_module &module,
 }
 
 
-int main(int argc, const char** argv)
+void resetConversionState()
 {
-    string usage = "Usage:\n"
-            + avoidNull(argv[0]) + " -f path/to/input/file "
-                    "[[-o path/to/output/file] | "
-                    "[-d path/to/output/directory/ [-o output_file_name]]] "
-                    "[-c path/to/yang/directory]";
-    if (argc < 2)
+    // remove the buffer top-nodes from the modules in the context before
+    // the nodes are freed
+    for (lys_module *m : bufferedModules)
     {
-        cerr << "Missing arguments\n" + usage << endl;
-        return -1;
-    }
-    // regexs to check file formats
-    std::regex yang_regex (".*\\.yang");
-    std::regex sdf_json_regex (".*\\.sdf\\.json");
+        lys_node *topNode = m->data;
+        if (!topNode || avoidNull(topNode->name) != "buffer")
+            continue;
 
-    const char *inputFileName = NULL;
-    const char *outputFileName = NULL;
-    const char *outputDir = NULL;
-    ly_ctx *ctx = NULL;
-    for (int i = 0; i < argc; i++)
-    {
-        if (strcmp(argv[i], "-c") == 0)
-        {
-            // load the required context
-            ctx = ly_ctx_new(argv[i+1], 0);
-        }
+        m->data = topNode->child;
+        for (lys_node *elem = m->data; elem; elem = elem->next)
+            elem->parent = NULL;
+    }
+    bufferedModules.clear();
+
+    // conversion direction YANG->SDF
+    typedefs.clear();
+    typerefs.clear();
+    identities.clear();
+    identsLeft.clear();
+    leafs.clear();
+    referencesLeft.clear();
+    branchRefs.clear();
+    alreadyImported.clear();
+    convertedTypedefs.clear();
+    convertedIdentities.clear();
+    // the converted files are freed together with the nodes in their arenas
+    // (imports first because they were converted last)
+    for (int i = convertedFiles.size() - 1; i >= 0; i--)
+        delete convertedFiles[i];
+    convertedFiles.clear();
+
+    // conversion direction SDF->YANG
+    identStore.clear();
+    pathsToNodes.clear();
+    openBaseIdent.clear();
+    openAugments.clear();
+    fileToModule.clear();
+    nodeStore.clear();
+    tpdfStore.clear();
+    restrStore.clear();
+    revStore.clear();
+    stringStore.clear();
+    voidPointerStore.clear();
 
-        else if (strcmp(argv[i], "-f") == 0)
-            inputFileName = argv[i+1];
+    outputDirString = "";
+    resetSdfState();
+}
 
-        else if (strcmp(argv[i], "-o") == 0)
-            outputFileName = argv[i+1];
+double millisecondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(
+            chrono::steady_clock::now() - start).count();
+}
 
-        else if (strcmp(argv[i], "-d") == 0)
-            outputDir = argv[i+1];
-    }
+void setValidationMode(validationMode mode)
+{
+    validationSetting = mode;
+}
 
-    if (!ctx)
-    {
-        // if context was not specified in arguments
-        // just load output or else current directory as context
+void setDeduplication(bool enabled)
+{
+    deduplicationSetting = enabled;
+}
 
-        if (outputDir)
-        {
-            ly_ctx_destroy(ctx, NULL);
-            ctx = ly_ctx_new(outputDir, 0);
-        }
+void setSdfFormat(sdfFormat format)
+{
+    sdfFormatSetting = format;
+}
 
-        if (!ctx)
-        {
-            ly_ctx_destroy(ctx, NULL);
-            ctx = ly_ctx_new(".", 0);
-        }
+void setCompactOutput(bool compact)
+{
+    compactOutput = compact;
+}
 
-        if (!ctx)
-        {
-            // Try loading the context from this directory with the usual name
-            ly_ctx_destroy(ctx, NULL);
-            ctx = ly_ctx_new("./yang", 0);
-        }
+bool enableFeatures(const char *spec)
+{
+    string str = avoidNull(spec);
+    size_t colon = str.find(':');
+    if (colon == string::npos || colon == 0)
+    {
+        cerr << "enableFeatures: " << str
+                << " is not of the form module:feature,..." << endl;
+        return false;
+    }
 
-        if (!ctx)
-        {
-            cerr << "Loading YANG context failed" << endl << endl;
-            return -1;
-        }
+    unordered_set<string> &features = featureProfile[str.substr(0, colon)];
+    stringstream stream(str.substr(colon + 1));
+    string feature;
+    while (getline(stream, feature, ','))
+    {
+        if (feature != "")
+            features.insert(feature);
     }
-    if (!inputFileName)
+    return true;
+}
+
+bool loadFeatureProfile(const char *path)
+{
+    string content;
+    if (!readFileToString(avoidNull(path), content))
     {
-        cerr << "No input file name specified\n" + usage << endl;
-        return -1;
+        cerr << "loadFeatureProfile: Error opening file " << avoidNull(path)
+                << endl;
+        return false;
     }
-    outputDirString = "";
-    if (outputDir)
+
+    bool success = true;
+    stringstream stream(content);
+    string line;
+    while (getline(stream, line))
     {
-        regex isPath(".*/.*");
-        if (outputFileName && regex_match(outputFileName, isPath))
-        {
-            cerr << "If a path to an output directory is given the output file"
-                    " name cannot also contain a path\n\n" + usage << endl;
-            return -1;
-        }
+        // remove surrounding whitespace
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line == "" || line[0] == '#')
+            continue;
 
-        regex isDir(".*/");
-        outputDirString = string(outputDir);
-        if (!regex_match(outputDir, isDir))
-            outputDirString += "/";
+        success = enableFeatures(line.c_str()) && success;
     }
+    return success;
+}
 
-    // choose better sizes
-    nodeStore.reserve(10000);
-    stringStore.reserve(10000);
-    revStore.reserve(500);
-    tpdfStore.reserve(10000);
-    restrStore.reserve(5000);
-    voidPointerStore.reserve(5000);
+bool applyFeatureProfile(ly_ctx *ctx)
+{
+    profiledModules.clear();
+    if (!ctx)
+        return false;
 
-    // check whether input file is a YANG file
-    if (std::regex_match(inputFileName, yang_regex))
+    bool complete = true;
+    for (auto &it : featureProfile)
     {
-        if (outputFileName && !std::regex_match(outputFileName, sdf_json_regex))
+        const lys_module *module = ly_ctx_get_module(ctx, it.first.c_str(),
+                NULL, 0);
+        if (!module)
+            module = ly_ctx_load_module(ctx, it.first.c_str(), NULL);
+        if (!module)
         {
-            cerr << "Incorrect output file format\n" << endl << endl;
-            return -1;
+            cerr << "applyFeatureProfile: module " << it.first
+                    << " not found" << endl;
+            complete = false;
+            continue;
         }
+        profiledModules.push_back(module);
 
-        cout << "Parsing YANG module ";
-        // load the module
-        const lys_module *module =
-                lys_parse_path(ctx, inputFileName, LYS_IN_YANG);
-
-        if (module == NULL)
+        lys_features_disable(module, "*");
+        for (const string &feature : it.second)
         {
-            cerr << "-> failed" << endl;
-            return -1;
+            if (lys_features_enable(module, feature.c_str()) != 0)
+            {
+                cerr << "applyFeatureProfile: feature " << feature
+                        << " of module " << it.first
+                        << " could not be enabled" << endl;
+                complete = false;
+            }
         }
-        cout << "-> succeeded" << endl << endl
-                << "Converting YANG model to SDF..." << endl;
+    }
+    return complete;
+}
 
-        sdfFile *moduleFile = moduleToSdfFile(
-                const_cast<lys_module*>(module));
-        cout << "-> finished" << endl << endl;
-        string outputFileString;
-        if (outputFileName)
-            outputFileString = outputDirString + outputFileName;
-        else
-            outputFileString = outputDirString + avoidNull(module->name)
-                                    + ".sdf.json";
+vector<string> searchDirsOf(ly_ctx *ctx)
+{
+    vector<string> dirs;
+    const char * const *searchDirs = ly_ctx_get_searchdirs(ctx);
+    for (int i = 0; searchDirs && searchDirs[i]; i++)
+        dirs.push_back(searchDirs[i]);
+    return dirs;
+}
 
-        cout << "Storing SDF model to file " + outputFileString + "..." << endl;
+bool validateYang(vector<string> searchDirs, string content, double *time)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
 
-        moduleFile->toFile(outputFileString);
-        cout << " -> successful" << endl << endl;
-
-        cout << "DONE" << endl;
-        return 0;
+    // a throwaway context with the same search directories and module index
+    ly_ctx *ctx = ly_ctx_new(NULL, 0);
+    if (!ctx)
+    {
+        cerr << "validateYang: creating a YANG context failed" << endl;
+        return false;
     }
+    for (int i = 0; i < searchDirs.size(); i++)
+        ly_ctx_set_searchdir(ctx, searchDirs[i].c_str());
+    if (!moduleIndex.empty())
+        ly_ctx_set_module_imp_clb(ctx, moduleIndexImportCallback, NULL);
 
-    // check whether input file is a SDF file
-    else if (std::regex_match(inputFileName, sdf_json_regex))
-    {
-        if (outputFileName && !std::regex_match(outputFileName, yang_regex))
+    bool valid = lys_parse_mem(ctx, content.c_str(), LYS_IN_YANG) != NULL;
+    ly_ctx_destroy(ctx, NULL);
+
+    if (time)
+        *time = millisecondsSince(start);
+    return valid;
+}
+
+int finishValidations(bool wait)
+{
+    int failed = 0;
+    for (int i = 0; i < deferredValidations.size(); i++)
+    {
+        string name = get<1>(deferredValidations[i]);
+        future<tuple<bool, double>> &validation =
+                get<2>(deferredValidations[i]);
+        if (!wait && validation.wait_for(chrono::seconds(0))
+                != future_status::ready)
+            continue;
+
+        bool valid;
+        double time;
+        tie(valid, time) = validation.get();
+        finishedValidations[get<0>(deferredValidations[i])] =
+                make_tuple(valid, time);
+        if (valid)
+            cout << "Deferred validation of " << name << " -> successful ("
+                    << time << " ms)" << endl;
+        else
         {
-            cerr << "Incorrect output file format\n" << endl;
-            return -1;
+            cerr << "Deferred validation of " << name << " -> failed ("
+                    << time << " ms)" << endl;
+            failed++;
         }
 
-        sdfObject moduleObject;
-        sdfThing moduleThing;
-        sdfFile moduleSdf;
-        lys_module module = {};
-        module.ctx = ctx;
-
-        // approximate sizes of store vectors
-        unsigned int nodeApprox = moduleObject.getDatatypes().size()
-                + moduleObject.getProperties().size()
-                + moduleObject.getActions().size()
-                + moduleObject.getEvents().size();
-        nodeStore.reserve(10000);
-        stringStore.reserve(10000);
-        revStore.reserve(500);
-        tpdfStore.reserve(10000);
-        restrStore.reserve(5000);
-        voidPointerStore.reserve(5000);
-
-        cout << "Parsing YANG conversion helper module 'sdf_extension.yang'";
+        deferredValidations.erase(deferredValidations.begin() + i--);
+    }
+
+    // the handles increase, so the oldest results are dropped first
+    while (finishedValidations.size() > MAX_FINISHED_VALIDATIONS)
+        finishedValidations.erase(finishedValidations.begin());
+    return failed;
+}
+
+int validationResult(int id, bool &valid, double &time, bool wait)
+{
+    // the validation may still be running
+    for (int i = 0; i < deferredValidations.size(); i++)
+    {
+        if (get<0>(deferredValidations[i]) != id)
+            continue;
+
+        future<tuple<bool, double>> &validation =
+                get<2>(deferredValidations[i]);
+        if (!wait && validation.wait_for(chrono::seconds(0))
+                != future_status::ready)
+            return 0;
+
+        tie(valid, time) = validation.get();
+        deferredValidations.erase(deferredValidations.begin() + i);
+        return 1;
+    }
+
+    map<int, tuple<bool, double>>::iterator it = finishedValidations.find(id);
+    if (it == finishedValidations.end())
+        return -1;
+
+    tie(valid, time) = it->second;
+    finishedValidations.erase(it);
+    return 1;
+}
+
+int moduleToSdfBuffer(lys_module *module, conversionResult &result)
+{
+    if (!module)
+    {
+        cerr << "moduleToSdfBuffer: module is null" << endl;
+        return -1;
+    }
+
+    // the nodes disabled by the feature profile are skipped
+    if (!featureProfile.empty())
+        applyFeatureProfile(module->ctx);
+
+    // collect the converted imports instead of writing them to files
+    map<string, string> *prevImportBuffers = importBuffers;
+    importBuffers = &result.imports;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    cout << "Converting YANG model to SDF..." << endl;
+    sdfFile *moduleFile = moduleToSdfFile(module);
+    cout << "-> finished" << endl << endl;
+
+    importBuffers = prevImportBuffers;
+
+    json output = moduleFile->toJson(json());
+    result.content = encodeSdf(output, sdfFormatSetting);
+    result.fileName = avoidNull(module->name)
+            + sdfFormatExtension(sdfFormatSetting);
+    result.conversionTime = millisecondsSince(start);
+
+    // SDF models are validated against the JSON schema in memory
+    if (validationSetting != validation_off)
+    {
+        start = chrono::steady_clock::now();
+        result.valid = validateJson(output);
+        result.validated = true;
+        result.validationTime = millisecondsSince(start);
+    }
+
+    resetConversionState();
+    return 0;
+}
+
+int yangToSdfBuffer(ly_ctx *ctx, const char *input, conversionResult &result)
+{
+    // the modules that were in the context before the module is parsed
+    unordered_set<const lys_module*> loadedBefore;
+    uint32_t index = 0;
+    const lys_module *loaded;
+    while ((loaded = ly_ctx_get_module_iter(ctx, &index)))
+        loadedBefore.insert(loaded);
+
+    cout << "Parsing YANG module ";
+    const lys_module *module = lys_parse_mem(ctx, input, LYS_IN_YANG);
+    if (module == NULL)
+    {
+        cerr << "-> failed" << endl;
+        return -1;
+    }
+    cout << "-> succeeded" << endl << endl;
+
+    // the conversion state that refers to the module is reset by
+    // moduleToSdfBuffer() before the module is removed
+    int ret = moduleToSdfBuffer(const_cast<lys_module*>(module), result);
+
+    // the inline module is removed again so that it does not pile up in ctx
+    // and can be parsed by a later request, the modules it imports stay
+    // loaded for the following requests
+    if (!loadedBefore.count(module))
+        ly_ctx_remove_module(module, NULL);
+    return ret;
+}
+
+int sdfToYangBuffer(ly_ctx *ctx, const char *input, conversionResult &result,
+        const char *moduleName)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    json sdfJson;
+    try
+    {
+        sdfJson = json::parse(input);
+    }
+    catch (const exception &e)
+    {
+        cerr << "sdfToYangBuffer: parsing the SDF model failed:\n"
+                << e.what() << endl;
+        return -1;
+    }
+
+    return sdfJsonToYangBuffer(ctx, sdfJson, result, moduleName, start);
+}
+
+int sdfToYangBuffer(ly_ctx *ctx, const string &input, sdfFormat format,
+        conversionResult &result, const char *moduleName)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    json sdfJson;
+    if (!decodeSdf(input, format, sdfJson))
+    {
+        cerr << "sdfToYangBuffer: decoding the SDF model failed" << endl;
+        return -1;
+    }
+
+    return sdfJsonToYangBuffer(ctx, sdfJson, result, moduleName, start);
+}
+
+int sdfJsonToYangBuffer(ly_ctx *ctx, json &sdfJson, conversionResult &result,
+        const char *moduleName, chrono::steady_clock::time_point start)
+{
+
+    if (!contextLoaded)
+        loadContext();
+
+    // the elements disabled by the feature profile are skipped
+    if (!featureProfile.empty())
+        applyFeatureProfile(ctx);
+
+    sdfObject moduleObject;
+    sdfThing moduleThing;
+    sdfFile moduleSdf;
+    lys_module module = {};
+    module.ctx = ctx;
+
+    // the helper module only has to be parsed once per context
+    helper = const_cast<lys_module*>(ly_ctx_get_module(ctx,
+            "sdf_extension", NULL, 0));
+    if (!helper)
+    {
+        cout << "Parsing YANG conversion helper module "
+                "'sdf_extension.yang'";
         helper = const_cast<lys_module*>(lys_parse_path(
                 ctx, "sdf_extension.yang", LYS_IN_YANG));
 
@@ -5163,76 +6131,956 @@ int main(int argc, const char** argv)
             cerr << "-> failed" << endl << endl;
         else
             cout << "-> succeeded" << endl << endl;
+    }
 
-        cout << "Loading SDF file..." << endl;
-        cout << endl;
+    // collect the printed imports instead of writing them to files
+    map<string, string> *prevImportBuffers = importBuffers;
+    importBuffers = &result.imports;
 
-        vector<tuple<sdfCommon*, lys_node*>> openRefs = {};
-        vector<tuple<sdfCommon*, lys_tpdf*>> openRefsTpdf = {};
-        vector<tuple<sdfCommon*, lys_type*>> openRefsType = {};
-        if (moduleSdf.fromFile(inputFileName))
+    vector<tuple<sdfCommon*, lys_node*>> openRefs = {};
+    vector<tuple<sdfCommon*, lys_tpdf*>> openRefsTpdf = {};
+    vector<tuple<sdfCommon*, lys_type*>> openRefsType = {};
+    if (moduleSdf.fromJson(sdfJson))
+    {
+        cout << "Loading SDF model -> finished" << endl << endl;
+        cout << "Converting SDF model to YANG " << endl;
+        sdfFileToModule(moduleSdf, module, openRefs, openRefsTpdf,
+                openRefsType);
+    }
+    else if (moduleObject.jsonToObject(sdfJson, true) != NULL)
+    {
+        cout << "Loading SDF JSON -> finished" << endl << endl;
+        cout << "Converting SDF model to YANG " << endl;
+        sdfObjectToModule(moduleObject, module, openRefs, openRefsTpdf,
+                openRefsType);
+    }
+    else if (moduleThing.jsonToThing(sdfJson) != NULL)
+    {
+        cout << "Loading SDF JSON -> finished" << endl << endl;
+        cout << "Converting SDF model to YANG " << endl;
+        sdfThingToModule(moduleThing, module, openRefs, openRefsTpdf,
+                openRefsType);
+    }
+    else
+    {
+        importBuffers = prevImportBuffers;
+        cerr << "No sdfObject or sdfThing could be loaded from the "
+                "input" << endl;
+        resetConversionState();
+        return -1;
+    }
+    importBuffers = prevImportBuffers;
+    cout << "-> finished" << endl << endl;
+
+    if (moduleName)
+        module.name = storeString(moduleName);
+
+    char *output = NULL;
+    cout << "Printing YANG module ";
+    if (lys_print_mem(&output, &module, LYS_OUT_YANG, NULL, 0, 0) != 0
+            || !output)
+    {
+        cerr << "-> failed" << endl << endl;
+        free(output);
+        resetConversionState();
+        return -1;
+    }
+    cout << "-> successful" << endl << endl;
+    result.content = output;
+    result.fileName = avoidNull(module.name) + ".yang";
+    free(output);
+    result.conversionTime = millisecondsSince(start);
+
+    // validate the model in a separate context so that the module does not
+    // end up in the context used for conversions
+    if (validationSetting == validation_memory)
+    {
+        cout << "Validation ";
+        result.valid = validateYang(searchDirsOf(ctx), result.content,
+                &result.validationTime);
+        result.validated = true;
+        if (result.valid)
+            cout << "-> successful (" << result.validationTime << " ms)"
+                    << endl << endl;
+        else
+            cerr << "-> failed (" << result.validationTime << " ms)"
+                    << endl << endl;
+    }
+    else if (validationSetting == validation_deferred)
+    {
+        vector<string> searchDirs = searchDirsOf(ctx);
+        string content = result.content;
+        future<tuple<bool, double>> validation = async(launch::async,
+                [searchDirs, content]()
+                {
+                    double time = 0;
+                    bool valid = validateYang(searchDirs, content, &time);
+                    return make_tuple(valid, time);
+                });
+        result.validationId = nextValidationId++;
+        deferredValidations.push_back(make_tuple(result.validationId,
+                result.fileName, move(validation)));
+        cout << "Validation of " << result.fileName << " deferred" << endl
+                << endl;
+    }
+
+    resetConversionState();
+    return 0;
+}
+
+const lys_module* parseYangFile(ly_ctx *ctx, const char *path)
+{
+    cout << "Parsing YANG module ";
+    const lys_module *module = lys_parse_path(ctx, path, LYS_IN_YANG);
+
+    // the module might have been loaded into the context by a previous
+    // conversion already (serve mode)
+    if (module == NULL)
+    {
+        cmatch cm;
+        regex r("(.*/)?([^/@]+)(@[^/]*)?\\.yang");
+        char *inputPath = realpath(path, NULL);
+        const lys_module *loaded = NULL;
+        if (inputPath && regex_match(path, cm, r))
+            loaded = ly_ctx_get_module(ctx, cm[2].str().c_str(), NULL, 0);
+        if (loaded && avoidNull(loaded->filepath) == avoidNull(inputPath))
+            module = loaded;
+        free(inputPath);
+    }
+
+    if (module == NULL)
+        cerr << "-> failed" << endl;
+    else
+        cout << "-> succeeded" << endl << endl;
+
+    return module;
+}
+
+bool readFileToString(string path, string &content)
+{
+    sdfInputBuffer buffer;
+    if (!buffer.open(path))
+        return false;
+
+    content.assign(buffer.data(), buffer.size());
+    return true;
+}
+
+bool writeStringToFile(string path, string content)
+{
+    ofstream output(path, ios::binary);
+    if (!output)
+        return false;
+
+    output << content;
+    output.close();
+    return !output.fail();
+}
+
+bool writeStringToStdout(const string &content)
+{
+    if (fwrite(content.data(), 1, content.size(), stdout) != content.size())
+        return false;
+    return fflush(stdout) == 0;
+}
+
+int benchmarkSdfParsers(const char *path, int runs)
+{
+    // collect the SDF JSON files (a single file or those in a directory)
+    vector<string> paths;
+    DIR *dir = opendir(path);
+    if (dir)
+    {
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != NULL)
         {
-            cout << "...loading " + string(inputFileName)
-                    + " -> finished" << endl << endl;
-            cout << "Converting SDF model to YANG " << endl;
-            sdfFileToModule(moduleSdf, module, openRefs, openRefsTpdf,
-                    openRefsType);
+            string name = ent->d_name;
+            if (isSdfFileName(name)
+                    && sdfFormatOfFileName(name) == sdf_format_json)
+                paths.push_back(string(path) + "/" + name);
         }
-        else if (moduleObject.fileToObject(inputFileName, true) != NULL)
+        closedir(dir);
+        sort(paths.begin(), paths.end());
+    }
+    else
+        paths.push_back(path);
+
+    vector<shared_ptr<sdfInputBuffer>> buffers;
+    size_t bytes = 0;
+    for (const string &p : paths)
+    {
+        shared_ptr<sdfInputBuffer> buffer(new sdfInputBuffer());
+        if (!buffer->open(p))
         {
-            cout << "Loading SDF JSON file -> finished" << endl << endl;
-            cout << "Converting SDF model to YANG " << endl;
-            sdfObjectToModule(moduleObject, module, openRefs, openRefsTpdf,
-                    openRefsType);
+            cerr << "benchmarkSdfParsers: Error opening file " << p << endl;
+            return -1;
+        }
+        bytes += buffer->size();
+        buffers.push_back(buffer);
+    }
+    if (buffers.empty() || runs < 1)
+    {
+        cerr << "benchmarkSdfParsers: no SDF JSON files found" << endl;
+        return -1;
+    }
+
+    cout << "Benchmarking JSON parsers on " << buffers.size()
+            << " SDF files (" << bytes / 1e6 << " MB, best of " << runs
+            << " runs)" << endl;
+
+    vector<sdfJsonParser> parsers = {json_parser_nlohmann};
+    if (simdjsonAvailable())
+        parsers.push_back(json_parser_simdjson);
+    vector<json> results(buffers.size());
+    vector<json> parsed(buffers.size());
+    for (sdfJsonParser parser : parsers)
+    {
+        double best = -1;
+        bool same = true;
+        for (int run = 0; run < runs; run++)
+        {
+            chrono::steady_clock::time_point start =
+                    chrono::steady_clock::now();
+            for (int i = 0; i < buffers.size(); i++)
+            {
+                json sdf;
+                if (!parseSdfJson(buffers[i]->data(), buffers[i]->size(), sdf,
+                        parser, buffers[i]->capacity()))
+                {
+                    cerr << "benchmarkSdfParsers: parsing " << paths[i]
+                            << " failed" << endl;
+                    return -1;
+                }
+
+                // the results of the first run are kept for the comparison
+                if (run == 0)
+                    parsed[i] = move(sdf);
+            }
+            double time = millisecondsSince(start);
+            if (best < 0 || time < best)
+                best = time;
+
+            // the results are compared outside of the timed region
+            for (int i = 0; run == 0 && i < buffers.size(); i++)
+            {
+                if (parser == json_parser_nlohmann)
+                    results[i] = move(parsed[i]);
+                else
+                    same = same && parsed[i] == results[i];
+            }
         }
-        else if (moduleThing.fileToThing(inputFileName) != NULL)
+
+        cout << (parser == json_parser_nlohmann ? "nlohmann::json" : "simdjson")
+                << ": " << best << " ms (" << bytes / (best * 1e3) << " MB/s)"
+                << (same ? "" : ", results differ from nlohmann::json")
+                << endl;
+    }
+    if (!simdjsonAvailable())
+        cout << "simdjson: not available (built without SDFCONV_WITH_SIMDJSON)"
+                << endl;
+
+    return 0;
+}
+
+bool buildModuleIndex(const char *repoPath, const char *indexPath)
+{
+    regex yangRegex(".*\\.yang");
+    regex nameRegex("(^|\\n)\\s*(sub)?module\\s+\"?([\\w.-]+)");
+    regex revisionRegex("(^|\\n)\\s*revision\\s+[\"']?(\\d{4}-\\d{2}-\\d{2})");
+    regex fileRevRegex("[^@]*@(\\d{4}-\\d{2}-\\d{2})\\.yang");
+    json index = json::object();
+    unsigned int count = 0;
+
+    cout << "Building YANG module index of " << repoPath << "..." << endl;
+
+    // store absolute paths so that the index can be used from anywhere
+    char *absRepoPath = realpath(repoPath, NULL);
+    if (!absRepoPath)
+    {
+        cerr << "buildModuleIndex: " << repoPath << ": " << strerror(errno)
+                << endl;
+        return false;
+    }
+
+    // go through the directory tree with an explicit stack of directories,
+    // each directory (by device and inode) is only visited once so that
+    // symbolic link loops end
+    vector<string> dirs = {string(absRepoPath)};
+    set<pair<dev_t, ino_t>> visitedDirs;
+    struct stat rootSt;
+    if (stat(absRepoPath, &rootSt) == 0)
+        visitedDirs.insert({rootSt.st_dev, rootSt.st_ino});
+    free(absRepoPath);
+    while (!dirs.empty())
+    {
+        string dirPath = dirs.back();
+        dirs.pop_back();
+        if (dirPath.back() != '/')
+            dirPath += "/";
+
+        DIR *dir;
+        struct dirent *ent;
+        if ((dir = opendir(dirPath.c_str())) == NULL)
+        {
+            cerr << "buildModuleIndex: opening directory " << dirPath
+                    << " failed: " << strerror(errno) << endl;
+            continue;
+        }
+        while ((ent = readdir(dir)) != NULL)
         {
-            cout << "Loading SDF JSON file -> finished" << endl << endl;
-            cout << "Converting SDF model to YANG " << endl;
-            sdfThingToModule(moduleThing, module, openRefs, openRefsTpdf,
-                    openRefsType);
+            string fileName = ent->d_name;
+            if (fileName == "." || fileName == ".." || fileName == ".git")
+                continue;
+
+            string path = dirPath + fileName;
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0)
+                continue;
+
+            if (S_ISDIR(st.st_mode))
+            {
+                if (visitedDirs.insert({st.st_dev, st.st_ino}).second)
+                    dirs.push_back(path);
+                continue;
+            }
+            if (!regex_match(fileName, yangRegex))
+                continue;
+
+            // the module header contains the name and the latest revision
+            string content;
+            if (!readFileToString(path, content))
+                continue;
+
+            smatch sm;
+            if (!regex_search(content, sm, nameRegex))
+                continue;
+            string name = sm[3].str();
+
+            string revision = "";
+            if (regex_match(fileName, sm, fileRevRegex))
+                revision = sm[1].str();
+            else if (regex_search(content, sm, revisionRegex))
+                revision = sm[2].str();
+
+            // the same module revision is often found in several places,
+            // keep the first one
+            if (index[name].find(revision) == index[name].end())
+            {
+                index[name][revision] = path;
+                count++;
+            }
         }
+        closedir(dir);
+    }
+
+    if (!writeStringToFile(indexPath, index.dump(INDENT_WIDTH) + "\n"))
+    {
+        cerr << "buildModuleIndex: writing index file " << indexPath
+                << " failed: " << strerror(errno) << endl;
+        return false;
+    }
+
+    cout << "-> finished, " << count << " module revisions indexed in "
+            << indexPath << endl;
+    return true;
+}
+
+void freeIndexedModule(void *moduleData, void * /*userData*/)
+{
+    free(moduleData);
+}
+
+const char* moduleIndexImportCallback(const char *modName,
+        const char *modRev, const char *submodName, const char *subRev,
+        void * /*userData*/, LYS_INFORMAT *format,
+        void (**freeModuleData)(void *moduleData, void *userData))
+{
+    const char *name = submodName ? submodName : modName;
+    const char *revision = submodName ? subRev : modRev;
+
+    map<string, map<string, string>>::iterator it = moduleIndex.find(
+            avoidNull(name));
+    if (it == moduleIndex.end() || it->second.empty())
+        return NULL;
+
+    // without a revision the latest revision is used (the revisions are
+    // dates and thus sorted in the map)
+    string path;
+    if (revision)
+    {
+        map<string, string>::iterator jt = it->second.find(revision);
+        if (jt == it->second.end())
+            return NULL;
+        path = jt->second;
+    }
+    else
+        path = it->second.rbegin()->second;
+
+    string content;
+    if (!readFileToString(path, content))
+        return NULL;
+
+    *format = LYS_IN_YANG;
+    *freeModuleData = freeIndexedModule;
+    return strdup(content.c_str());
+}
+
+bool loadModuleIndex(ly_ctx *ctx, const char *indexPath)
+{
+    string content;
+    if (!readFileToString(indexPath, content))
+        return false;
+
+    json index;
+    try
+    {
+        index = json::parse(content);
+    }
+    catch (const exception &e)
+    {
+        cerr << "loadModuleIndex: parsing index file " << indexPath
+                << " failed:\n" << e.what() << endl;
+        return false;
+    }
+
+    moduleIndex.clear();
+    for (json::iterator it = index.begin(); it != index.end(); ++it)
+    {
+        for (json::iterator jt = it.value().begin(); jt != it.value().end();
+                ++jt)
+        {
+            if (jt.value().is_string())
+                moduleIndex[it.key()][jt.key()] = jt.value();
+        }
+    }
+
+    ly_ctx_set_module_imp_clb(ctx, moduleIndexImportCallback, NULL);
+    cout << "Using YANG module index " << indexPath << endl;
+    return true;
+}
+
+int convertFileToBuffer(ly_ctx *ctx, const char *inputFileName,
+        conversionResult &result, const char *moduleName)
+{
+    // regex to check file formats
+    std::regex yang_regex (".*\\.yang");
+
+    // choose better sizes
+    nodeStore.reserve(10000);
+    stringStore.reserve(10000);
+    revStore.reserve(500);
+    tpdfStore.reserve(10000);
+    restrStore.reserve(5000);
+    voidPointerStore.reserve(5000);
+
+    // check whether input file is a YANG file
+    if (std::regex_match(inputFileName, yang_regex))
+    {
+        const lys_module *module = parseYangFile(ctx, inputFileName);
+        if (module == NULL)
+            return -1;
+
+        return moduleToSdfBuffer(const_cast<lys_module*>(module), result);
+    }
+
+    // check whether input file is a SDF file
+    else if (isSdfFileName(inputFileName))
+    {
+        // the model is decoded straight from the mapped file
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        sdfInputBuffer input;
+        json sdfJson;
+        cout << "Loading SDF file..." << endl << endl;
+        if (!input.open(inputFileName))
+        {
+            cerr << "convertFileToBuffer: Error opening file "
+                    << inputFileName << endl;
+            return -1;
+        }
+        if (!decodeSdf(input.data(), input.size(),
+                sdfFormatOfFileName(inputFileName), sdfJson))
+            return -1;
+        input.close();
+
+        return sdfJsonToYangBuffer(ctx, sdfJson, result, moduleName, start);
+    }
+
+    cerr << "Unknown input file format" << endl;
+    return -1;
+}
+
+bool appendResultToBundle(conversionResult &result, const string &path)
+{
+    sdfFormat format = sdfBundleFormatOfFileName(path);
+
+    // a bundle is started from scratch when it is first written to or when
+    // it has been changed since it was last written to (then the recorded
+    // contents are outdated)
+    struct stat st;
+    auto it = bundleContents.find(path);
+    bool started = it != bundleContents.end()
+            && stat(path.c_str(), &st) == 0 && st.st_size == get<0>(it->second);
+    unordered_set<string> contained;
+    if (started)
+        contained = get<1>(it->second);
+
+    vector<tuple<const string*, const string*>> models;
+    models.push_back(make_tuple(&result.fileName, &result.content));
+    for (auto const &imp : result.imports)
+        models.push_back(make_tuple(&imp.first, &imp.second));
+
+    string output;
+    vector<string> added;
+    for (auto const &model : models)
+    {
+        const string &name = *get<0>(model);
+        const string &content = *get<1>(model);
+        // only imports are shared between models, the converted model itself
+        // is always written
+        bool isImport = get<0>(model) != &result.fileName;
+        if (isImport && contained.count(name))
+            continue;
+
+        // models that are not encoded as bundle documents already (a single
+        // line of JSON or a CBOR data item) are encoded again
+        sdfFormat modelFormat = sdfFormatOfFileName(name);
+        if (modelFormat == format && (format == sdf_format_cbor
+                || content.find('\n') == content.size() - 1))
+            output += content;
+        else
+        {
+            json sdf;
+            if (!decodeSdf(content, modelFormat, sdf))
+                return false;
+            output += encodeSdfBundleDocument(sdf, format);
+        }
+        if (isImport)
+            added.push_back(name);
+    }
+
+    ofstream bundle(path, started ? ios::binary | ios::app
+            : ios::binary | ios::trunc);
+    if (!bundle)
+        return false;
+
+    bundle << output;
+    bundle.close();
+    if (bundle.fail())
+    {
+        // the state of the file is unknown, start from scratch next time
+        bundleContents.erase(path);
+        return false;
+    }
+
+    // the imports are only marked as contained once they have been written
+    contained.insert(added.begin(), added.end());
+    off_t size = stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+    bundleContents[path] = make_tuple(size, move(contained));
+    return true;
+}
+
+int writeResult(conversionResult &result, const char *outputFileName,
+        string *outputPath)
+{
+    int ret = 0;
+    bool toStdout = outputFileName && strcmp(outputFileName, "-") == 0;
+    string outputFileString;
+    if (toStdout)
+        outputFileString = "-";
+    else if (outputFileName)
+        outputFileString = outputDirString + outputFileName;
+    else
+        outputFileString = outputDirString + result.fileName;
+
+    // all models go into a single bundle file
+    if (!toStdout && isSdfBundleName(outputFileString))
+    {
+        cout << "Storing converted model and its imports to bundle "
+                + outputFileString + "...";
+        if (appendResultToBundle(result, outputFileString))
+            cout << " -> successful" << endl << endl;
+        else
+        {
+            cerr << " -> failed: " << strerror(errno) << endl << endl;
+            ret = -1;
+        }
+
+        if (outputPath)
+            *outputPath = outputFileString;
+        return ret;
+    }
+
+    bool written;
+    if (toStdout)
+    {
+        cout << "Streaming converted model to stdout...";
+        written = writeStringToStdout(result.content);
+    }
+    else
+    {
+        cout << "Storing converted model to file " + outputFileString + "...";
+        written = writeStringToFile(outputFileString, result.content);
+    }
+    if (written)
+        cout << " -> successful" << endl << endl;
+    else
+    {
+        cerr << " -> failed: " << strerror(errno) << endl << endl;
+        ret = -1;
+    }
+
+    for (auto const &imp : result.imports)
+    {
+        cout << "Storing imported model to file "
+                + outputDirString + imp.first + "...";
+        if (writeStringToFile(outputDirString + imp.first, imp.second))
+            cout << " -> successful" << endl;
         else
         {
-            cerr << "No sdfObject or sdfThing could be loaded from the "
-                    "input file\n\nDONE" << endl;
+            cerr << " -> failed: " << strerror(errno) << endl;
+            ret = -1;
+        }
+    }
+
+    if (outputPath)
+        *outputPath = outputFileString;
+
+    return ret;
+}
+
+int convertFile(ly_ctx *ctx, const char *inputFileName,
+        const char *outputFileName, string *outputPath)
+{
+    // regex to check file formats
+    std::regex yang_regex (".*\\.yang");
+
+    // "-" streams the converted model to stdout
+    bool toStdout = outputFileName && strcmp(outputFileName, "-") == 0;
+
+    string moduleName = "";
+    if (std::regex_match(inputFileName, yang_regex))
+    {
+        if (outputFileName && !toStdout && !isSdfBundleName(outputFileName)
+                && (!isSdfFileName(outputFileName)
+                || sdfFormatOfFileName(outputFileName) != sdfFormatSetting))
+        {
+            cerr << "Incorrect output file format\n" << endl << endl;
+            return -1;
+        }
+    }
+    else if (isSdfFileName(inputFileName))
+    {
+        if (outputFileName && !toStdout
+                && !std::regex_match(outputFileName, yang_regex))
+        {
+            cerr << "Incorrect output file format\n" << endl;
             return -1;
         }
-        cout << "-> finished" << endl << endl;
 
-        string outputFileString;
-        if (outputFileName)
+        // the module is named after the output file
+        if (outputFileName && !toStdout)
         {
             cmatch cm;
-            regex r("(.*)\\.yang");
+            regex r("(.*/)?(.*)\\.yang");
             regex_match(outputFileName, cm, r);
-            module.name = cm[1].str().c_str();
+            moduleName = cm[2].str();
         }
+    }
+
+    conversionResult result;
+    if (convertFileToBuffer(ctx, inputFileName, result,
+            moduleName == "" ? NULL : moduleName.c_str()) != 0)
+        return -1;
+
+    cout << "Conversion time: " << result.conversionTime << " ms" << endl;
+    if (result.validated)
+        cout << "Validation time: " << result.validationTime << " ms" << endl;
+    cout << endl;
+
+    return writeResult(result, outputFileName, outputPath);
+}
+
+json handleServeRequest(ly_ctx *ctx, json request)
+{
+    json response;
+    if (!request.is_object())
+    {
+        response["status"] = "error";
+        response["error"] = "request has to be a JSON object";
+        return response;
+    }
+    if (request.find("id") != request.end())
+        response["id"] = request["id"];
+
+    // a request for the result of a deferred validation
+    if (request.find("validationId") != request.end()
+            && request.find("input") == request.end()
+            && request.find("content") == request.end())
+    {
+        bool valid = false;
+        double time = 0;
+        int found = -1;
+        if (request["validationId"].is_number_integer())
+            found = validationResult(request["validationId"], valid, time,
+                    request.value("wait", false));
+        if (found < 0)
+        {
+            response["status"] = "error";
+            response["error"] = "unknown validationId";
+            return response;
+        }
+        response["status"] = "ok";
+        response["validationId"] = request["validationId"];
+        response["finished"] = found == 1;
+        if (found == 1)
+        {
+            response["valid"] = valid;
+            response["validationTime"] = time;
+        }
+        return response;
+    }
+
+    string direction = request.value("direction", "");
+    string input = request.value("input", "");
+    string content = request.value("content", "");
+    string output = request.value("output", "");
+    string outputDir = request.value("outputDir", "");
+    string validation = request.value("validation", "");
+
+    regex yangRegex(".*\\.yang");
+    if (direction == "" && regex_match(input, yangRegex))
+        direction = "yang-to-sdf";
+    else if (direction == "" && isSdfFileName(input))
+        direction = "sdf-to-yang";
+
+    string error = "";
+    if (direction != "yang-to-sdf" && direction != "sdf-to-yang")
+        error = "unknown or missing direction";
+    else if (input == "" && content == "")
+        error = "no input path or content given";
+    else if (input != "" && content != "")
+        error = "input path and content given";
+    else if (input != "" && direction == "yang-to-sdf"
+            && !regex_match(input, yangRegex))
+        error = "input is not a YANG file";
+    else if (input != "" && direction == "sdf-to-yang"
+            && !isSdfFileName(input))
+        error = "input is not an SDF file";
+    else if (validation != "" && validation != "off"
+            && validation != "memory" && validation != "deferred")
+        error = "unknown validation mode";
+
+    // the module is named after the output file
+    string moduleName = "";
+    if (error == "" && output != "" && direction == "sdf-to-yang")
+    {
+        smatch sm;
+        regex r("(.*/)?(.*)\\.yang");
+        if (regex_match(output, sm, r))
+            moduleName = sm[2].str();
         else
+            error = "output is not a YANG file";
+    }
+    else if (error == "" && output != "" && !isSdfFileName(output)
+            && !isSdfBundleName(output))
+        error = "output is not an SDF file";
+
+    // converted SDF models are encoded as given by the output file name,
+    // models returned as content are JSON text
+    sdfFormat prevFormat = sdfFormatSetting;
+    bool prevCompact = compactOutput;
+    if (output != "" && direction == "yang-to-sdf" && isSdfBundleName(output))
+    {
+        sdfFormatSetting = sdfBundleFormatOfFileName(output);
+        compactOutput = true;
+    }
+    else
+        sdfFormatSetting = output == "" || direction == "sdf-to-yang"
+                ? sdf_format_json : sdfFormatOfFileName(output);
+
+    // the validation mode can be chosen per request
+    validationMode prevValidation = validationSetting;
+    if (validation == "off")
+        validationSetting = validation_off;
+    else if (validation == "memory")
+        validationSetting = validation_memory;
+    else if (validation == "deferred")
+        validationSetting = validation_deferred;
+
+    conversionResult result;
+    if (error == "")
+    {
+        int ret;
+        if (input != "")
+            ret = convertFileToBuffer(ctx, input.c_str(), result,
+                    moduleName == "" ? NULL : moduleName.c_str());
+        else if (direction == "yang-to-sdf")
+            ret = yangToSdfBuffer(ctx, content.c_str(), result);
+        else
+            ret = sdfToYangBuffer(ctx, content.c_str(), result,
+                    moduleName == "" ? NULL : moduleName.c_str());
+
+        if (ret != 0)
+            error = "conversion failed";
+    }
+    validationSetting = prevValidation;
+    sdfFormatSetting = prevFormat;
+    compactOutput = prevCompact;
+
+    if (error == "")
+    {
+        response["conversionTime"] = result.conversionTime;
+        if (result.validated)
         {
-            outputFileString = outputDirString + avoidNull(module.name)
-                    + ".yang";
-            outputFileName = outputFileString.c_str();
+            response["valid"] = result.valid;
+            response["validationTime"] = result.validationTime;
         }
+        else if (result.validationId != 0)
+            response["validationId"] = result.validationId;
+    }
 
-        cout << "Printing to file " << outputFileString;
-        if (lys_print_path(outputFileName, &module, LYS_OUT_YANG, NULL,
-                0, 0) == 0)
-            cout << "-> successful" << endl << endl;
-        else
-            cerr << "-> failed: " << strerror(errno) << endl << endl;
+    // the result is returned as content if there is no output path
+    if (error == "" && output == "" && outputDir == "")
+    {
+        response["content"] = result.content;
+        response["imports"] = result.imports;
+    }
+    else if (error == "")
+    {
+        outputDirString = outputDir;
+        if (outputDirString != "" && outputDirString.back() != '/')
+            outputDirString += "/";
 
-        // validate the model
-        cout << "Validation ";
-        if (lys_parse_path(ctx, outputFileName, LYS_IN_YANG))
-            cout << "-> successful" << endl << endl;
+        string outputPath;
+        if (writeResult(result, output == "" ? NULL : output.c_str(),
+                &outputPath) == 0)
+            response["output"] = outputPath;
         else
-            cerr << "-> failed" << endl << endl;
+            error = "writing the result failed";
+    }
+
+    if (error == "")
+        response["status"] = "ok";
+    else
+    {
+        response["status"] = "error";
+        response["error"] = error;
+    }
 
-        ly_ctx_destroy(ctx, NULL);
-        cout << "DONE" << endl;
+    resetConversionState();
+    return response;
+}
+
+json handleServeLine(ly_ctx *ctx, string line)
+{
+    // the results that have been collected before this request are dropped
+    // after it unless it has asked for them
+    vector<int> unfetched;
+    for (auto const &finished : finishedValidations)
+        unfetched.push_back(finished.first);
+
+    // report deferred validations that have finished in the meantime
+    finishValidations(false);
+
+    json request;
+    json response;
+    try
+    {
+        request = json::parse(line);
+    }
+    catch (const exception &e)
+    {
+        response["status"] = "error";
+        response["error"] = "invalid request: " + string(e.what());
+    }
+    if (response.empty())
+        response = handleServeRequest(ctx, request);
+
+    for (int id : unfetched)
+        finishedValidations.erase(id);
+    return response;
+}
+
+int serve(ly_ctx *ctx, const char *socketPath)
+{
+    // the responses are the only output on stdout, the usual progress
+    // messages are redirected to stderr
+    streambuf *stdoutBuf = cout.rdbuf(cerr.rdbuf());
+    ostream responses(stdoutBuf);
+
+    // keep the SDF context and the validator warm
+    loadContext();
+    prepareValidator();
+
+    if (!socketPath)
+    {
+        string line;
+        while (getline(cin, line))
+        {
+            if (line.empty())
+                continue;
+            responses << handleServeLine(ctx, line).dump() << endl;
+        }
+        finishValidations();
+        cout.rdbuf(stdoutBuf);
         return 0;
     }
 
-    return -1;
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path))
+    {
+        cerr << "serve: socket path is too long" << endl;
+        cout.rdbuf(stdoutBuf);
+        return -1;
+    }
+    strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath);
+    if (fd < 0 || ::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0
+            || listen(fd, 16) != 0)
+    {
+        cerr << "serve: opening socket " << socketPath << " failed: "
+                << strerror(errno) << endl;
+        if (fd >= 0)
+            close(fd);
+        cout.rdbuf(stdoutBuf);
+        return -1;
+    }
+    cerr << "Serving on " << socketPath << endl;
+
+    // connections are handled one after another, each one can send any
+    // number of requests (one per line)
+    int conn;
+    char chunk[4096];
+    while ((conn = accept(fd, NULL, NULL)) >= 0)
+    {
+        string buffer, response;
+        ssize_t n;
+        size_t pos;
+        while ((n = read(conn, chunk, sizeof(chunk))) > 0)
+        {
+            buffer.append(chunk, n);
+            while ((pos = buffer.find('\n')) != string::npos)
+            {
+                string line = buffer.substr(0, pos);
+                buffer.erase(0, pos + 1);
+                if (line.empty())
+                    continue;
+
+                response = handleServeLine(ctx, line).dump() + "\n";
+                if (write(conn, response.c_str(), response.size()) < 0)
+                    cerr << "serve: writing response failed: "
+                            << strerror(errno) << endl;
+            }
+        }
+        close(conn);
+    }
+
+    close(fd);
+    unlink(socketPath);
+    finishValidations();
+    cout.rdbuf(stdoutBuf);
+    return 0;
 }
@@ -19,12 +19,22 @@
 #include <math.h>
 #include <ctype.h>
 #include <algorithm>
+#include <unordered_set>
+#include <set>
 #include <libyang/libyang.h>
 #include <nlohmann/json.hpp>
 #include <nlohmann/json-schema.hpp>
 #include <dirent.h>
 #include <limits>
+#include <chrono>
+#include <future>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
 #include "sdf.hpp"
+#include "sdfconv.hpp"
 
 //#define MAX_NUM 3.4e+38                
 #define MAX_NUM numeric_limits<float>::max() /**< Maximal value for float numbers
@@ -51,6 +61,14 @@
 #define IGNORE_NODE 0x8000             /**< Flag to mark a node that is to be
                                         *   ignored
                                         */
+#define MODULE_INDEX_FILE "yang-module-index.json"
+                                       /**< Default file name of the YANG
+                                        *   module index in the YANG directory
+                                        */
+#define MAX_FINISHED_VALIDATIONS 256   /**< Maximal number of collected
+                                        *   deferred validation results that
+                                        *   are kept for validationResult()
+                                        */
 
 using nlohmann::json_schema::json_validator;
 using namespace std;
@@ -59,19 +77,20 @@ using json = nlohmann::json;
  * Uses nlohmann/json, call it json for convenience
  */
 
-string outputDirString;
+extern string outputDirString;
 /**<
  * Global variable to hold the name of the output directory (used for both
  * conversion directions).
  */
 
-map<string, sdfCommon*> typedefs;
+extern unordered_map<sdfSymbol, sdfCommon*> typedefs;
 /**<
- * Globally maps the names of YANG typedefs to their SDF equivalents.
+ * Globally maps the names of YANG typedefs (interned by internSymbol()) to
+ * their SDF equivalents.
  * This map is used together with the typerefs vector to assign sdfRef
  * references (conversion direction YANG->SDF).
  */
-vector<tuple<string, string, sdfCommon*>> typerefs;
+extern vector<tuple<string, string, sdfCommon*>> typerefs;
 /**<
  * Global vector of tuples which each link a typedef name (with and without
  * prefix) to a pointer to an sdfCommon object that uses the typedef's SDF
@@ -81,14 +100,15 @@ vector<tuple<string, string, sdfCommon*>> typerefs;
  * the typedefs vector (conversion direction YANG->SDF).
  */
 
-map<string, sdfCommon*> identities;
+extern unordered_map<sdfSymbol, sdfCommon*> identities;
 /**<
- * Globally maps the names of YANG identities to their SDF equivalents.
+ * Globally maps the names of YANG identities (interned by internSymbol()) to
+ * their SDF equivalents.
  * This map is used together with the identsLeft vector to assign sdfRef
  * references (conversion direction YANG->SDF).
  */
 
-vector<tuple<string, string, sdfCommon*>> identsLeft;
+extern vector<tuple<string, string, sdfCommon*>> identsLeft;
 /**<
  * Global vector of tuples which each link an identity name (with and without
  * prefix) to a pointer to an sdfCommon object that uses the identitie's SDF
@@ -98,14 +118,14 @@ vector<tuple<string, string, sdfCommon*>> identsLeft;
  * the identities vector (conversion direction YANG->SDF).
  */
 
-map<string, sdfCommon*> leafs;
+extern unordered_map<sdfSymbol, sdfCommon*> leafs;
 /**<
- * Globally maps the names of YANG leafs to their SDF equivalents. This map is
- * used together with the referencesLeft vector to assign sdfRef references
- * (conversion direction YANG->SDF).
+ * Globally maps the names of YANG leafs (interned by internSymbol()) to their
+ * SDF equivalents. This map is used together with the referencesLeft vector
+ * to assign sdfRef references (conversion direction YANG->SDF).
  */
 
-vector<tuple<string, string, sdfCommon*>> referencesLeft;
+extern vector<tuple<string, string, sdfCommon*>> referencesLeft;
 /**<
  * Global vector of tuples which each link a leaf name (with and without prefix)
  * to a pointer to an sdfCommon object that uses the leaf's SDF equivalent in
@@ -115,67 +135,69 @@ vector<tuple<string, string, sdfCommon*>> referencesLeft;
  */
 
 
-map<string, sdfCommon*> branchRefs;
+extern unordered_map<sdfSymbol, sdfCommon*> branchRefs;
 /**<
- * Globally maps the names of YANG branches to their SDF equivalents (conversion
- * direction YANG->SDF).
+ * Globally maps the names of YANG branches (interned by internSymbol()) to
+ * their SDF equivalents (conversion direction YANG->SDF).
  */
 
-vector<string> alreadyImported;
+extern vector<string> alreadyImported;
 /**<
  * This vector is used to globally keep track of already converted and imported
  * modules by globally storing their names (conversion direction YANG->SDF).
  */
 
-vector<shared_ptr<void>> voidPointerStore;
+extern vector<shared_ptr<void>> voidPointerStore;
 /**<
  * This vector is used as a global storage for smart void pointers
  * (conversion direction SDF->YANG).
  */
 
-vector<string> stringStore;
+extern vector<string> stringStore;
 /**<
  * This vector is used as a global storage for strings
  * (conversion direction SDF->YANG).
  */
 
-vector<lys_revision> revStore;
+extern vector<lys_revision> revStore;
 /**<
  * This vector is used as a global storage for lys_revision objects
  * (conversion direction SDF->YANG).
  */
 
-vector<shared_ptr<lys_node>> nodeStore;
+extern vector<shared_ptr<lys_node>> nodeStore;
 /**<
  * This vector is used as a global storage for smart pointers to lys_nodes
  * (conversion direction SDF->YANG).
  */
 
-vector<lys_tpdf*> tpdfStore;
+extern vector<lys_tpdf*> tpdfStore;
 /**<
  * This vector is used as a global storage for pointers to lys_tpdfs
  * (conversion direction SDF->YANG).
  */
 
-vector<lys_restr> restrStore;
+extern vector<lys_restr> restrStore;
 /**<
  * This vector is used as a global storage for lys_restrs
  * (conversion direction SDF->YANG).
  */
 
-map<string, lys_ident*> identStore;
+extern unordered_map<sdfSymbol, lys_ident*> identStore;
 /**<
- * Globally maps sdfRef reference strings of sdfCommon objects to pointers to their YANG
- * lys_ident equivalents (conversion direction SDF->YANG).
+ * Globally maps sdfRef reference strings of sdfCommon objects (interned by
+ * internSymbol()) to pointers to their YANG lys_ident equivalents (conversion
+ * direction SDF->YANG).
  */
 
-map<string, lys_node*> pathsToNodes;
+extern unordered_map<sdfSymbol, lys_node*> pathsToNodes;
 /**<
- * Globally maps the references in sdfRefs to pointers to the lys_nodes equivalent to the
- * sdfRef's targets (conversion direction SDF->YANG).
+ * Globally maps the references in sdfRefs (interned by internSymbol()) to
+ * pointers to the lys_nodes equivalent to the sdfRef's targets (conversion
+ * direction SDF->YANG).
  */
 
-vector<tuple<string, lys_ident**>> openBaseIdent;
+extern vector<tuple<string, lys_ident**>> openBaseIdent;
 /**<
  * Global vector with tuples of sdfRef reference strings and their equivalent
  * referenced pointers to lys_ident pointers.
@@ -183,7 +205,7 @@ vector<tuple<string, lys_ident**>> openBaseIdent;
  * equivalent to the SDF elements (conversion direction SDF->YANG).
  */
 
-vector<tuple<string, lys_node_augment*, string>> openAugments;
+extern vector<tuple<string, lys_node_augment*, string>> openAugments;
 /**<
  * Global vector with tuples of name of the module of the open augmentation, pointer
  * to the lys_node_augment and the sdfRef reference to the target node's SDF
@@ -191,168 +213,221 @@ vector<tuple<string, lys_node_augment*, string>> openAugments;
  * that have not been converted back (conversion direction SDF->YANG).
  */
 
-vector<tuple<sdfFile*, lys_module*>> fileToModule;
+extern vector<tuple<sdfFile*, lys_module*>> fileToModule;
 /**<
  * Global vector to store tuples of pointers to sdfFiles and pointers to their
  * equivalent, converted lys_module (conversion direction SDF->YANG)
  */
 
-lys_module *helper;
+extern vector<sdfFile*> convertedFiles;
+/**<
+ * Global vector of the sdfFiles created by moduleToSdfFile(). The files and
+ * the nodes in their arenas are freed by resetConversionState() (conversion
+ * direction YANG->SDF).
+ */
+
+extern unordered_map<lys_tpdf*, sdfData*> convertedTypedefs;
+/**<
+ * Globally maps the YANG typedefs that have already been converted to their
+ * SDF equivalents, so that every typedef is converted only once (conversion
+ * direction YANG->SDF).
+ */
+
+extern unordered_map<lys_ident*, sdfData*> convertedIdentities;
+/**<
+ * Globally maps the YANG identities that have already been converted to their
+ * SDF equivalents, so that every identity is converted only once (conversion
+ * direction YANG->SDF).
+ */
+
+extern lys_module *helper;
 /**<
  * Global variable to hold the helper module that contains the sdf-spec
  * extension (conversion direction SDF->YANG).
  */
 
-struct lys_tpdf stringTpdf = {
-        .name = "string",
-        .type = {.base = LY_TYPE_STRING}
-};
+extern vector<lys_module*> bufferedModules;
+/**<
+ * Global vector of the modules that have been given a buffer top-node in
+ * moduleToSdfFile(). The buffer top-nodes are removed again by
+ * resetConversionState() (conversion direction YANG->SDF).
+ */
+
+extern map<string, string> *importBuffers;
+/**<
+ * Global pointer to the map that converted imports are stored in, mapped by
+ * their file names. If it is NULL, converted imports are written to files in
+ * the output directory instead (used for both conversion directions).
+ */
+
+extern map<string, map<string, string>> moduleIndex;
+/**<
+ * Global YANG module index that maps module names to their revisions and
+ * these to the paths of the files containing them (loaded by
+ * loadModuleIndex()).
+ */
+
+extern validationMode validationSetting;
+/**<
+ * Global variable to hold the mode in which converted models are validated
+ * (set by setValidationMode()).
+ */
+
+extern bool deduplicationSetting;
+/**<
+ * Global variable to hold whether identical sdfData subtrees of converted SDF
+ * models are collapsed by sdfFile::deduplicateData() (set by
+ * setDeduplication(), conversion direction YANG->SDF).
+ */
+
+extern sdfFormat sdfFormatSetting;
+/**<
+ * Global variable to hold the encoding of converted SDF models and their
+ * imports (set by setSdfFormat(), conversion direction YANG->SDF).
+ */
+
+extern map<string, unordered_set<string>> featureProfile;
+/**<
+ * Global map of YANG module names to the names of their enabled features (set
+ * by enableFeatures() and loadFeatureProfile()). Nodes whose if-feature
+ * expressions are false under these features are skipped in both conversion
+ * directions, all other features of these modules count as disabled.
+ */
+
+extern vector<const lys_module*> profiledModules;
+/**<
+ * Global vector of the modules in featureProfile as found in the YANG context
+ * by applyFeatureProfile()
+ */
+
+extern map<string, tuple<off_t, unordered_set<string>>> bundleContents;
+/**<
+ * Global map of the SDF bundles written by appendResultToBundle() to their
+ * size after the last write and the file names of the imports they contain.
+ * A bundle is truncated when it is first written to (or when its size has
+ * changed since) and appended to afterwards, so that a batch of conversions
+ * (e.g. in serve mode) produces one bundle without duplicate imports.
+ */
+
+extern vector<tuple<int, string, future<tuple<bool, double>>>>
+        deferredValidations;
+/**<
+ * Global vector of the validations running in the background in mode
+ * validation_deferred. Each tuple holds the handle of the validation, the
+ * file name of the validated model and the future validation result and
+ * duration (conversion direction SDF->YANG).
+ */
+
+extern map<int, tuple<bool, double>> finishedValidations;
+/**<
+ * Global map of the handles of deferred validations that have been collected
+ * by finishValidations() to their results and durations, kept until they are
+ * fetched by validationResult(). Only the newest MAX_FINISHED_VALIDATIONS
+ * results are kept, in serve mode results are dropped if they have not been
+ * fetched by the request following their collection.
+ */
+
+extern int nextValidationId;
+/**<
+ * Global variable to hold the handle of the next deferred validation
+ */
+
+extern struct lys_tpdf stringTpdf;
 /**<
  * Used to mark lys_types as type string (conversion direction SDF->YANG).
  */
 
-struct lys_tpdf dec64Tpdf = {
-        .name = "decimal64",
-        .type = {.base = LY_TYPE_DEC64}
-};
+extern struct lys_tpdf dec64Tpdf;
 /**<
  * Used to mark lys_types as type decimal64 (conversion direction SDF->YANG).
  */
 
-struct lys_tpdf intTpdf = {
-        .name = "int64",
-        .type = {.base = LY_TYPE_INT64}
-};
+extern struct lys_tpdf intTpdf;
 /**<
  * Used to mark lys_types as type int64 (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf uint64Tpdf = {
-        .name = "uint64",
-        .type = {.base = LY_TYPE_UINT64}
-};
+extern struct lys_tpdf uint64Tpdf;
 /**<
  * Used to mark lys_types as type uint64 (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf int32Tpdf = {
-        .name = "int32",
-        .type = {.base = LY_TYPE_INT32}
-};
+extern struct lys_tpdf int32Tpdf;
 /**<
  * Used to mark lys_types as type int32 (conversion direction SDF->YANG).
  */
 
-struct lys_tpdf uint32Tpdf = {
-        .name = "uint32",
-        .type = {.base = LY_TYPE_UINT32}
-};
+extern struct lys_tpdf uint32Tpdf;
 /**<
  * Used to mark lys_types as type uint32 (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf int16Tpdf = {
-        .name = "int16",
-        .type = {.base = LY_TYPE_INT16}
-};
+extern struct lys_tpdf int16Tpdf;
 /**<
  * Used to mark lys_types as type int16 (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf uint16Tpdf = {
-        .name = "uint16",
-        .type = {.base = LY_TYPE_UINT16}
-};
+extern struct lys_tpdf uint16Tpdf;
 /**<
  * Used to mark lys_types as type uint16 (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf int8Tpdf = {
-        .name = "int8",
-        .type = {.base = LY_TYPE_INT8}
-};
+extern struct lys_tpdf int8Tpdf;
 /**<
  * Used to mark lys_types as type int8 (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf uint8Tpdf = {
-        .name = "uint8",
-        .type = {.base = LY_TYPE_UINT8}
-};
+extern struct lys_tpdf uint8Tpdf;
 /**<
  * Used to mark lys_types as type uint8 (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf booleanTpdf = {
-        .name = "boolean",
-        .type = {.base = LY_TYPE_BOOL}
-};
+extern struct lys_tpdf booleanTpdf;
 /**<
  * Used to mark lys_types as type boolean (conversion direction SDF->YANG).
  */
 
-struct lys_tpdf enumTpdf = {
-        .name = "enumeration",
-        .type = {.base = LY_TYPE_ENUM}
-};
+extern struct lys_tpdf enumTpdf;
 /**<
  * Used to mark lys_types as type enumeration (conversion direction SDF->YANG).
  */
 
-struct lys_tpdf leafrefTpdf = {
-        .name = "leafref",
-        .type = {.base = LY_TYPE_LEAFREF}
-};
+extern struct lys_tpdf leafrefTpdf;
 /**<
  * Used to mark lys_types as type leafref (conversion direction SDF->YANG).
  */
 
-struct lys_tpdf unionTpdf = {
-        .name = "union",
-        .type = {.base = LY_TYPE_UNION}
-};
+extern struct lys_tpdf unionTpdf;
 /**<
  * Used to mark lys_types as type union (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf emptyTpdf = {
-        .name = "empty",
-        .type = {.base = LY_TYPE_EMPTY}
-};
+extern struct lys_tpdf emptyTpdf;
 /**<
  * Used to mark lys_types as type empty (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf bitsTpdf = {
-        .name = "bits",
-        .type = {.base = LY_TYPE_BITS}
-};
+extern struct lys_tpdf bitsTpdf;
 /**<
  * Used to mark lys_types as type bits (only needed for round trips,
  * conversion direction SDF->YANG).
  */
 
-struct lys_tpdf binaryTpdf = {
-        .name = "binary",
-        .type = {.base = LY_TYPE_BINARY}
-};
+extern struct lys_tpdf binaryTpdf;
 /**<
  * Used to mark lys_types as type binary (conversion direction SDF->YANG).
  */
 
-struct lys_tpdf identTpdf = {
-        .name = "identityref",
-        .type = {.base = LY_TYPE_IDENT}
-};
+extern struct lys_tpdf identTpdf;
 /**<
  * Used to mark lys_types as type identityref (only needed for round trips,
  * conversion direction SDF->YANG).
@@ -470,7 +545,7 @@ bool subTreeUsesModule(lys_node *node, lys_module *wanted);
 bool moduleUsesModule(lys_module *module, lys_module *wanted);
 
 /**
- * Recursively generate the path of a lys_node
+ * Generate the path of a lys_node
  * 
  * If the given lys_module differs from the module of the node, or if stated 
  * through the addPrefix parameter, add a prefix
@@ -531,7 +606,7 @@ string expandPath(lys_tpdf *tpdf, bool addPrefix = false);
 
 
 /**
- * Recursively check all parent nodes of a lys_node for given type
+ * Check all parent nodes of a lys_node for given type
  * 
  * @param _node The lys_node that is the starting point of the search
  * @param type the LYS_NODE type to check for
@@ -556,7 +631,7 @@ jsonDataType parseBaseType(LY_DATA_TYPE type);
  * 
  * @return The deduced libyang base type
  */
-LY_DATA_TYPE stringToLType(std::string type);
+LY_DATA_TYPE stringToLType(const std::string &type);
 
 /**
  * Deduce from a given JSON type the corresponding libyang base type.
@@ -585,6 +660,57 @@ string parseTypeToString(struct lys_type *type);
  */
 void addOriginNote(sdfCommon *com, string stmt, string arg = "");
 
+/**
+ * Append a conversion note to a given description
+ *
+ * @param dsc  The description to append the conversion note to
+ * @param stmt The statement part of the conversion note
+ * @param arg  The argument part of the conversion note
+ *
+ * @sa addOriginNote()
+ */
+void appendOriginNote(string &dsc, const string &stmt, const string &arg = "");
+
+/**
+ * The metadata of a YANG module that is transferred to the info block and the
+ * module info sdfData of the converted SDF model
+ */
+struct moduleInfo
+{
+    string copyright;         /**< The copyright notice of the description */
+    string license;           /**< The license paragraph of the description */
+    string organization;      /**< The organization statement */
+    string contact;           /**< The contact statement */
+    string reference;         /**< The reference statement */
+    vector<string> revisions; /**< The revision dates, newest first */
+};
+
+/**
+ * Scan a module description paragraph by paragraph (in linear time) for the
+ * copyright notice, i.e. the rest of the first paragraph from the word
+ * 'copyright' on, and for the first paragraph that contains the word
+ * 'license'. Paragraphs are separated by empty lines.
+ *
+ * @param dsc       The description to scan
+ * @param copyright The string to store the copyright notice in (empty if
+ *                  there is none)
+ * @param license   The string to store the license paragraph in (empty if
+ *                  there is none)
+ */
+void scanDescriptionParagraphs(const string &dsc, string &copyright,
+        string &license);
+
+/**
+ * Collect the metadata of a given YANG module
+ *
+ * @param module A pointer to the lys_module
+ *
+ * @return The metadata of the module
+ *
+ * @sa scanDescriptionParagraphs()
+ */
+moduleInfo extractModuleInfo(lys_module *module);
+
 /**
  * Transform a range in const char array form into an integer vector
  * 
@@ -678,6 +804,18 @@ sdfData* typeToSdfData(struct lys_type *type, sdfData *data,
  */
 sdfData* typedefToSdfData(struct lys_tpdf *tpdf);
 
+/**
+ * Convert the typedefs in a given array that have not been converted yet
+ * (see convertedTypedefs). Uses of an already converted typedef are assigned
+ * an sdfRef to its single SDF definition.
+ * 
+ * @param tpdfs     An array with the lys_tpdfs to be converted
+ * @param tpdf_size The size of the lys_tpdfs array
+ * 
+ * @return The newly generated sdfData objects
+ */
+vector<sdfData*> newTypedefsToSdfData(lys_tpdf *tpdfs, uint16_t tpdf_size);
+
 /**
  * The information is extracted from the given lys_node_leaf struct and
  * a corresponding sdfProperty object is generated
@@ -772,20 +910,131 @@ uint8_t iff_getop(uint8_t *list, int pos);
 
 /**
  * This function is borrowed and modified from resolve.c of libyang and resolves
- * the lys_iffeature back into a string recursively.
+ * the lys_iffeature back into a string recursively. Operands are put in
+ * parentheses where the precedence of not, and and or would change the
+ * meaning of the string otherwise.
  * 
  * @param expr    The lys_iffeature struct to resolve
  * @param index_e The current position in expr
  * @param index_f The current position in the features array of expr
+ * @param module  Optionally the module the expression belongs to, features
+ *                of other modules are prefixed with the prefix of their module
  * 
  * @return An if-feature string as it would be printed in a YANG module
  */
 string resolve_iffeature_recursive(struct lys_iffeature *expr, int *index_e, 
-        int *index_f);
+        int *index_f, const lys_module *module = NULL);
+
+/**
+ * Evaluate a lys_iffeature recursively like resolve_iffeature_recursive()
+ * does. Features of modules in featureProfile are looked up in the feature
+ * state of libyang, features of all other modules count as enabled.
+ * 
+ * @param expr    The lys_iffeature struct to evaluate
+ * @param index_e The current position in expr
+ * @param index_f The current position in the features array of expr
+ * 
+ * @return The value of the if-feature expression
+ */
+bool iffeatureValue(struct lys_iffeature *expr, int *index_e, int *index_f);
+
+/**
+ * Determine whether a lys_node is skipped in the conversion because one of
+ * its if-feature expressions (or those of the augment it belongs to) is false
+ * under the features given in featureProfile
+ * 
+ * @param node A pointer to the lys_node in question
+ * 
+ * @return True if the node is skipped, false otherwise (always false if no
+ *         features are given)
+ */
+bool nodeIsPruned(lys_node *node);
+
+/**
+ * The state of the conversion of a lys_node into an sdfData object. The frames
+ * of all nodes that are being converted are kept on an explicit stack by
+ * nodeToSdfData() instead of on the call stack.
+ */
+struct nodeConversionFrame
+{
+    lys_node *node = NULL;          /**< The node that is converted */
+    sdfObject *object = NULL;       /**< The sdfObject the node belongs to */
+    sdfData *data = NULL;           /**< The sdfData object converted from the
+                                         node */
+    lys_node *elem = NULL;          /**< The child node converted next */
+    sdfCommon *com = NULL;          /**< The SDF element converted from the
+                                         last child node */
+    sdfData *list = NULL;           /**< The array converted from elem if
+                                         elem is a list */
+    sdfEvent *event = NULL;         /**< The sdfEvent converted from elem if
+                                         elem is a notification */
+    sdfObject *keepGrouping = NULL; /**< The buffer sdfObject for the
+                                         groupings of a notification */
+};
+
+/**
+ * Open the conversion of a lys_node, i.e. create the sdfData object and
+ * convert everything but the child nodes
+ *
+ * @param node   A pointer to the lys_node to be converted
+ * @param object A pointer to the sdfObject the sdfData element belongs to
+ *
+ * @return The conversion frame of the node
+ */
+nodeConversionFrame openNodeConversion(lys_node *node, sdfObject *object);
+
+/**
+ * Determine whether a child node has to be converted in a conversion frame of
+ * its own (because its own child nodes have to be converted)
+ *
+ * @param elem A pointer to the child lys_node
+ *
+ * @return True if the child needs a conversion frame, false otherwise
+ */
+bool nodeNeedsConversionFrame(lys_node *elem);
+
+/**
+ * Prepare the conversion of the current child node (elem) of a conversion
+ * frame that needs a conversion frame of its own
+ *
+ * @param frame The conversion frame of the parent node
+ *
+ * @return A pointer to the sdfObject the child belongs to
+ */
+sdfObject* startChildConversion(nodeConversionFrame &frame);
+
+/**
+ * Insert the converted current child node (elem) of a conversion frame into
+ * the sdfData object of the frame
+ *
+ * @param frame The conversion frame of the parent node
+ * @param child The sdfData object converted from the child node
+ */
+void finishChildConversion(nodeConversionFrame &frame, sdfData *child);
+
+/**
+ * Convert the current child node (elem) of a conversion frame that does not
+ * need a conversion frame of its own
+ *
+ * @param frame The conversion frame of the parent node
+ */
+void convertChildInPlace(nodeConversionFrame &frame);
+
+/**
+ * Transfer the augment, if-feature and extension statements of the current
+ * child node (elem) of a conversion frame to the last converted SDF element
+ *
+ * @param frame The conversion frame of the parent node
+ */
+void finishChildNode(nodeConversionFrame &frame);
 
 /**
  * Convert the content of a given lys_node into an sdfData object
  * 
+ * The subtree of the node is traversed with an explicit stack of conversion
+ * frames, so that the depth of the call stack does not grow with the depth
+ * of the subtree.
+ * 
  * @param node   A pointer to the lys_node to be converted
  * @param object A pointer to the sdfObject the sdfData element belongs to (if 
  *               any)
@@ -804,6 +1053,17 @@ sdfData* nodeToSdfData(struct lys_node *node, sdfObject *object);
  */
 sdfData* identToSdfData(struct lys_ident _ident);
 
+/**
+ * Convert the identities in a given array that have not been converted yet
+ * (see convertedIdentities) and map them by name in identities
+ * 
+ * @param idents     An array with the lys_idents to be converted
+ * @param ident_size The size of the lys_idents array
+ * 
+ * @return The newly generated sdfData objects
+ */
+vector<sdfData*> newIdentsToSdfData(lys_ident *idents, uint16_t ident_size);
+
 /**
  * Looks in a map of reference strings and corresponding sdfCommon objects to assign the given open references if possible
  * 
@@ -815,7 +1075,7 @@ sdfData* identToSdfData(struct lys_ident _ident);
  */
 vector<tuple<string, string, sdfCommon*>> assignReferences(
         vector<tuple<string, string, sdfCommon*>> refsLeft,
-        map<string, sdfCommon*> refs);
+        const unordered_map<sdfSymbol, sdfCommon*> &refs);
 
 sdfFile* moduleToSdfFile(lys_module *module);
 
@@ -832,6 +1092,24 @@ sdfFile* moduleToSdfFile(lys_module *module);
 sdfObject* moduleToSdfObject(const struct lys_module *module,
         sdfObject *object =  NULL);
 
+/**
+ * Promotes the given children of a buffer sdfData to sdfProperties. The
+ * sdfData objects are moved into the new sdfProperties, removed from the
+ * buffer and freed, and the pointers to them that were stored during the
+ * conversion (referencesLeft, typerefs, identsLeft, leafs, branchRefs and the
+ * sdfRequired of the owner) are redirected to the sdfProperties.
+ * Children that are shared with another node (i.e. do not have the buffer as
+ * their parent) are copied instead.
+ *
+ * @param data  The children of the buffer to promote
+ * @param buf   The buffer sdfData
+ * @param owner The sdfCommon whose sdfRequired may list the children
+ *
+ * @return The sdfProperties, in the order of the given children
+ */
+vector<sdfProperty*> promoteToSdfProperties(const vector<sdfData*> &data,
+        sdfData *buf, sdfCommon *owner);
+
 /**
  * The information is extracted from the given lys_node_container struct and
  * a corresponding sdfOjbect object is generated or filled
@@ -936,6 +1214,46 @@ string removeConvNote(char *dsc);
  */
 vector<tuple<string, string>> extractConvNote(sdfCommon *com);
 
+/**
+ * Evaluate an if-feature expression in string form (as produced by
+ * resolve_iffeature_recursive()) with the usual YANG precedence of not, and
+ * and or. The prefixes of the features are resolved to namespaces by ns
+ * (features without prefix belong to its default namespace). A feature counts
+ * as disabled if the module in featureProfile with that namespace defines it
+ * and libyang reports it as disabled, features with unresolvable prefixes
+ * count as enabled.
+ * 
+ * @param expr The if-feature expression
+ * @param ns   The namespace section of the SDF model the expression belongs
+ *             to (all features count as enabled if it is NULL)
+ * 
+ * @return The value of the expression
+ */
+bool iffeatureStringValue(const string &expr, sdfNamespaceSection *ns);
+
+/**
+ * Determine whether an SDF element is skipped in the conversion because the
+ * if-feature expression recorded in its conversion notes is false under the
+ * features given in featureProfile
+ * 
+ * @param com A pointer to the sdfCommon object in question
+ * 
+ * @return True if the element is skipped, false otherwise (always false if no
+ *         features are given)
+ */
+bool sdfElementIsPruned(sdfCommon *com);
+
+/**
+ * Set the feature state of the modules in featureProfile in a YANG context:
+ * all features of a module are disabled except for the given ones. Modules
+ * that are not in the context yet are loaded from its search directories.
+ * 
+ * @param ctx The YANG context
+ * 
+ * @return True if all modules and features were found, false otherwise
+ */
+bool applyFeatureProfile(ly_ctx *ctx);
+
 /**
  * Set a given lys_node to mandatory according to the rules from RFC 7950
  * 
@@ -958,7 +1276,7 @@ bool setMandatory(lys_node *node, bool firstLevel = true);
  *               sdfRequired list
  * @param module The address of the module in question
  */
-void sdfRequiredToNode(vector<sdfCommon*> reqs, lys_module &module);
+void sdfRequiredToNode(const vector<sdfCommon*> &reqs, lys_module &module);
 
 /**
  * Fill the information of an sdfData element into lys_type
@@ -1077,7 +1395,7 @@ lys_node* sdfDataToNode(sdfData *data, lys_node *node, lys_module &module,
  *                     to
  * @param openRefsType The address of the vector to add open type references to
  */
-void convertDatatypes(vector<sdfData*> datatypes, lys_module &module,
+void convertDatatypes(const vector<sdfData*> &datatypes, lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType);
@@ -1138,7 +1456,7 @@ void importHelper(lys_module &module);
  * @param openRefs     The address of the vector to add open node references to
  * @param openRefsType The address of the vector to add open type references to
  */
-void convertProperties(vector<sdfProperty*> props, lys_module &module,
+void convertProperties(const vector<sdfProperty*> &props, lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType);
 
@@ -1153,7 +1471,7 @@ void convertProperties(vector<sdfProperty*> props, lys_module &module,
  *                     to
  * @param openRefsType The address of the vector to add open type references to
  */
-void convertActions(vector<sdfAction*> actions, lys_module &module,
+void convertActions(const vector<sdfAction*> &actions, lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType);
@@ -1169,7 +1487,7 @@ void convertActions(vector<sdfAction*> actions, lys_module &module,
  *                     to
  * @param openRefsType The address of the vector to add open type references to
  */
-void convertEvents(vector<sdfEvent*> events, lys_module &module,
+void convertEvents(const vector<sdfEvent*> &events, lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType);
@@ -1193,7 +1511,8 @@ struct lys_module* sdfThingToModule(sdfThing &thing, lys_module &module,
  * 
  * @return A vector of lys_node pointers populated with the information
  */
-vector<lys_node*> convertThings(vector<sdfThing*> things, lys_module &module,
+vector<lys_node*> convertThings(const vector<sdfThing*> &things,
+        lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType);
@@ -1230,7 +1549,8 @@ struct lys_module* sdfObjectToModule(sdfObject &object, lys_module &module,
  * 
  * @return A vector of lys_node pointers populated with the information
  */
-vector<lys_node*> convertObjects(vector<sdfObject*> objects, lys_module &module,
+vector<lys_node*> convertObjects(const vector<sdfObject*> &objects,
+        lys_module &module,
         vector<tuple<sdfCommon*, lys_node*>> &openRefs,
         vector<tuple<sdfCommon*, lys_tpdf*>> &openRefsTpdf,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType);
@@ -1275,13 +1595,294 @@ struct lys_module* sdfFileToModule(sdfFile &file, lys_module &module,
         vector<tuple<sdfCommon*, lys_type*>> &openRefsType);
 
 /**
- * The main function that is executed on execution of the tool
- * 
- * @param argc Number of elements in argv
- * @param argv Input to the tool (array of C-strings)
- * 
- * @return 0 on successful execution, -1 else
+ * Reads the content of a file into a string
+ *
+ * @param path    The path to the file
+ * @param content The string to store the content in
+ *
+ * @return True if the file could be read, false otherwise
+ */
+bool readFileToString(string path, string &content);
+
+/**
+ * Returns the time that has passed since a given point in time
+ *
+ * @param start The point in time
+ *
+ * @return The passed time in milliseconds
+ */
+double millisecondsSince(chrono::steady_clock::time_point start);
+
+/**
+ * Converts an already decoded SDF model into a YANG module (used by both
+ * variants of sdfToYangBuffer()).
+ *
+ * @param ctx        The YANG context that is used to resolve imports and to
+ *                   validate the resulting module
+ * @param sdfJson    The SDF model as JSON object
+ * @param result     The conversion result to store the YANG module and its
+ *                   imports in
+ * @param moduleName Optionally the name of the resulting YANG module (the name
+ *                   is derived from the SDF model otherwise)
+ * @param start      The point in time the conversion started at (including
+ *                   decoding the model)
+ *
+ * @return 0 on successful conversion, -1 else
+ */
+int sdfJsonToYangBuffer(ly_ctx *ctx, json &sdfJson, conversionResult &result,
+        const char *moduleName, chrono::steady_clock::time_point start);
+
+/**
+ * Returns the search directories of a YANG context
+ *
+ * @param ctx The YANG context
+ *
+ * @return The search directories
+ */
+vector<string> searchDirsOf(ly_ctx *ctx);
+
+/**
+ * Validates a YANG module given as text by parsing it into a throwaway YANG
+ * context. The context uses the given search directories and the global
+ * module index to resolve imports. This function does not touch any other
+ * global state and can thus run in the background.
+ *
+ * @param searchDirs The search directories of the throwaway context
+ * @param content    The YANG module as text
+ * @param time       If given, the duration of the validation in milliseconds
+ *                   is stored here
+ *
+ * @return The validation result
+ */
+bool validateYang(vector<string> searchDirs, string content,
+        double *time = NULL);
+
+/**
+ * Writes a string into a file
+ *
+ * @param path    The path to the file
+ * @param content The string to write
+ *
+ * @return True if the file could be written, false otherwise
+ */
+bool writeStringToFile(string path, string content);
+
+/**
+ * Writes a string to stdout and flushes it
+ *
+ * @param content The string to write
+ *
+ * @return True if the string could be written, false otherwise
+ */
+bool writeStringToStdout(const string &content);
+
+/**
+ * Parses a YANG module from a file. If the module has already been loaded
+ * from the same file into the context (e.g. in serve mode), the loaded module
+ * is returned.
+ *
+ * @param ctx  The YANG context to use
+ * @param path The path to the YANG file
+ *
+ * @return A pointer to the module or NULL if parsing failed
+ */
+const lys_module* parseYangFile(ly_ctx *ctx, const char *path);
+
+/**
+ * Builds an index of all YANG modules and submodules in a directory tree
+ * (e.g. a copy of the YANG GitHub repository) and stores it in a file.
+ * The index maps module names to their revisions and these to the paths of
+ * the files containing them. Modules without revision are stored with the
+ * empty string as revision.
+ *
+ * @param repoPath  The path to the directory to index
+ * @param indexPath The path to the index file to write
+ *
+ * @return True if the index could be built and stored, false otherwise
+ */
+bool buildModuleIndex(const char *repoPath, const char *indexPath);
+
+/**
+ * Benchmarks the available parsers for SDF models in JSON text (see
+ * parseSdfJson()) on a single .sdf.json file or on all .sdf.json files in a
+ * directory. The files are loaded before the measurement, the fastest of the
+ * runs is reported per parser together with the throughput. The results of
+ * simdjson are compared to those of nlohmann::json.
+ *
+ * @param path The path to the file or directory
+ * @param runs The number of times every file is parsed per parser
+ *
+ * @return 0 if all files could be read and parsed, -1 else
+ */
+int benchmarkSdfParsers(const char *path, int runs = 5);
+
+/**
+ * Frees module data returned by moduleIndexImportCallback()
+ *
+ * @param moduleData The module data to free
+ * @param userData   Unused
+ */
+void freeIndexedModule(void *moduleData, void *userData);
+
+/**
+ * Module import callback for libyang that looks up imported and included
+ * modules in the global module index instead of searching the directories
+ * of the context.
+ *
+ * @param modName        The name of the module to load
+ * @param modRev         The revision of the module to load (optional, the
+ *                       latest revision is loaded otherwise)
+ * @param submodName     The name of the submodule to load (optional)
+ * @param subRev         The revision of the submodule to load (optional)
+ * @param userData       Unused
+ * @param format         The format of the returned module data is stored
+ *                       here
+ * @param freeModuleData The function to free the returned module data is
+ *                       stored here
+ *
+ * @return The content of the module file or NULL if the module is not in the
+ *         index (libyang then searches the directories of the context)
+ *
+ * @sa loadModuleIndex()
+ */
+const char* moduleIndexImportCallback(const char *modName,
+        const char *modRev, const char *submodName, const char *subRev,
+        void *userData, LYS_INFORMAT *format,
+        void (**freeModuleData)(void *moduleData, void *userData));
+
+/**
+ * Loads a YANG module index built by buildModuleIndex() into the global
+ * module index and registers moduleIndexImportCallback() as module import
+ * callback of a YANG context.
+ *
+ * @param ctx       The YANG context
+ * @param indexPath The path to the index file
+ *
+ * @return True if the index was loaded, false otherwise
+ */
+bool loadModuleIndex(ly_ctx *ctx, const char *indexPath);
+
+/**
+ * Converts a YANG file to SDF or an SDF file to YANG in memory, depending on
+ * the file extension of the input file.
+ *
+ * @param ctx           The YANG context to use
+ * @param inputFileName The path to the input file
+ * @param result        The conversion result to store the converted model and
+ *                      its imports in
+ * @param moduleName    Optionally the name of the resulting YANG module
+ *                      (conversion direction SDF->YANG)
+ *
+ * @return 0 on successful conversion, -1 else
+ */
+int convertFileToBuffer(ly_ctx *ctx, const char *inputFileName,
+        conversionResult &result, const char *moduleName = NULL);
+
+/**
+ * Writes a converted SDF model and its imports into an SDF bundle file.
+ * Imports that the bundle already contains (by file name) are skipped, the
+ * converted model itself is always written.
+ *
+ * @param result The conversion result
+ * @param path   The path to the bundle file (.sdf.jsonl or .sdf.cborseq)
+ *
+ * @return True if the bundle could be written, false otherwise
+ *
+ * @sa bundleContents and sdfBundle
+ */
+bool appendResultToBundle(conversionResult &result, const string &path);
+
+/**
+ * Writes a conversion result and its imports to files in the output directory
+ * given by outputDirString. If the output file name is the name of an SDF
+ * bundle, all models are written into the bundle instead.
+ *
+ * @param result         The conversion result
+ * @param outputFileName The name of the output file (optional, the file name
+ *                       of the result is used otherwise), "-" writes the
+ *                       converted model to stdout
+ * @param outputPath     If given, the path of the output file is stored here
+ *
+ * @return 0 if all files could be written, -1 else
+ */
+int writeResult(conversionResult &result, const char *outputFileName = NULL,
+        string *outputPath = NULL);
+
+/**
+ * Converts a YANG file to SDF or an SDF file to YANG, depending on the file
+ * extension of the input file. Output files are stored in the output
+ * directory given by outputDirString.
+ *
+ * @param ctx            The YANG context to use
+ * @param inputFileName  The path to the input file
+ * @param outputFileName The name of the output file (optional, the name is
+ *                       derived from the converted model otherwise), "-"
+ *                       writes the converted model to stdout
+ * @param outputPath     If given, the path of the output file is stored here
+ *
+ * @return 0 on successful conversion, -1 else
+ */
+int convertFile(ly_ctx *ctx, const char *inputFileName,
+        const char *outputFileName = NULL, string *outputPath = NULL);
+
+/**
+ * Handles a single conversion request in serve mode. A request is a JSON
+ * object with the members
+ *   - "id": optional, is copied into the response
+ *   - "direction": "yang-to-sdf" or "sdf-to-yang" (optional if "input" has
+ *     the file extension .yang, .sdf.json, .sdf.cbor or .sdf.msgpack)
+ *   - "input": the path to the input file, or
+ *   - "content": the input model itself
+ *   - "output": optional, the path (or name) of the output file (converted
+ *     SDF models are encoded as given by its extension, JSON otherwise)
+ *   - "outputDir": optional, the output directory
+ *
+ * The response contains "status" ("ok" or "error") and either the path of
+ * the output file ("output") or, if neither an output nor an output directory
+ * was given, the converted model ("content") and the converted imports by
+ * file name ("imports"). If the validation was deferred, the response
+ * contains its handle ("validationId").
+ *
+ * A request that only contains "validationId" (and optionally "id" and
+ * "wait") asks for the result of a deferred validation. The response contains
+ * "finished" and, if the validation is finished, "valid" and
+ * "validationTime". A result that has been collected before a request has
+ * to be asked for by that request, it is dropped afterwards.
+ * The global conversion state is reset after each request.
+ *
+ * @param ctx     The YANG context to use
+ * @param request The request
+ *
+ * @return The response
+ */
+json handleServeRequest(ly_ctx *ctx, json request);
+
+/**
+ * Parses a single line of input in serve mode as a request and handles it
+ *
+ * @param ctx  The YANG context to use
+ * @param line The line containing the request
+ *
+ * @return The response (an error response if the line is not valid JSON)
+ *
+ * @sa handleServeRequest()
+ */
+json handleServeLine(ly_ctx *ctx, string line);
+
+/**
+ * Serves conversion requests as JSON lines (one request and one response per
+ * line) until the input ends. The YANG context, the SDF context and the
+ * validator are kept loaded between requests.
+ *
+ * @param ctx        The YANG context to use
+ * @param socketPath The path to a Unix domain socket to listen on. If NULL,
+ *                   requests are read from stdin and responses are written to
+ *                   stdout.
+ *
+ * @return 0 on success, -1 else
+ *
+ * @sa handleServeRequest()
  */
-int main(int argc, const char** argv);
+int serve(ly_ctx *ctx, const char *socketPath = NULL);
 
 #endif
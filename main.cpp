@@ -0,0 +1,266 @@
+/*!
+ * @file main.cpp
+ * @brief The command line interface of the converter tool
+ *
+ * The command line interface parses the arguments of the tool, loads the YANG
+ * context and runs the conversion of the given input file (or serves
+ * conversion requests in serve mode) with the help of the libsdfconv library.
+ */
+#include "converter.hpp"
+
+/**
+ * The main function that is executed on execution of the tool
+ *
+ * @param argc Number of elements in argv
+ * @param argv Input to the tool (array of C-strings)
+ *
+ * @return 0 on successful execution, -1 else
+ */
+int main(int argc, const char** argv)
+{
+    string usage = "Usage:\n"
+            + avoidNull(argv[0]) + " -f path/to/input/file "
+                    "[[-o path/to/output/file] | "
+                    "[-d path/to/output/directory/ [-o output_file_name]]] "
+                    "[-c path/to/yang/directory] [-i path/to/index] "
+                    "[--validate off|memory|deferred] [--dedup] "
+                    "[-F json|cbor|msgpack] [--compact] "
+                    "[--features module:feature,...] "
+                    "[--feature-profile path/to/profile]\n"
+            + avoidNull(argv[0]) + " --serve [path/to/socket] "
+                    "[-c path/to/yang/directory] [-i path/to/index] "
+                    "[--validate off|memory|deferred] [--dedup] "
+                    "[--features module:feature,...] "
+                    "[--feature-profile path/to/profile]\n"
+            + avoidNull(argv[0]) + " --build-index -c path/to/yang/directory "
+                    "[-i path/to/index]\n"
+            + avoidNull(argv[0]) + " --bench-parse "
+                    "path/to/sdf/file/or/directory [-n runs]";
+    if (argc < 2)
+    {
+        cerr << "Missing arguments\n" + usage << endl;
+        return -1;
+    }
+
+    const char *inputFileName = NULL;
+    const char *outputFileName = NULL;
+    const char *outputDir = NULL;
+    const char *socketPath = NULL;
+    const char *yangDir = NULL;
+    const char *indexFileName = NULL;
+    bool serveMode = false;
+    bool formatGiven = false;
+    bool buildIndex = false;
+    const char *benchPath = NULL;
+    int benchRuns = 5;
+    ly_ctx *ctx = NULL;
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-c") == 0)
+        {
+            // load the required context
+            yangDir = argv[i+1];
+            ctx = ly_ctx_new(yangDir, 0);
+        }
+
+        else if (strcmp(argv[i], "-i") == 0)
+            indexFileName = argv[i+1];
+
+        else if (strcmp(argv[i], "--build-index") == 0)
+            buildIndex = true;
+
+        else if (strcmp(argv[i], "--bench-parse") == 0 && i+1 < argc)
+            benchPath = argv[i+1];
+
+        else if (strcmp(argv[i], "-n") == 0 && i+1 < argc)
+            benchRuns = atoi(argv[i+1]);
+
+        else if (strcmp(argv[i], "--validate") == 0 && i+1 < argc)
+        {
+            if (strcmp(argv[i+1], "off") == 0)
+                setValidationMode(validation_off);
+            else if (strcmp(argv[i+1], "memory") == 0)
+                setValidationMode(validation_memory);
+            else if (strcmp(argv[i+1], "deferred") == 0)
+                setValidationMode(validation_deferred);
+            else
+            {
+                cerr << "Unknown validation mode " << argv[i+1] << "\n"
+                        + usage << endl;
+                return -1;
+            }
+        }
+
+        else if (strcmp(argv[i], "--dedup") == 0)
+            setDeduplication(true);
+
+        else if (strcmp(argv[i], "--compact") == 0)
+            setCompactOutput(true);
+
+        else if (strcmp(argv[i], "--features") == 0 && i+1 < argc)
+        {
+            if (!enableFeatures(argv[i+1]))
+            {
+                cerr << usage << endl;
+                return -1;
+            }
+        }
+
+        else if (strcmp(argv[i], "--feature-profile") == 0 && i+1 < argc)
+        {
+            if (!loadFeatureProfile(argv[i+1]))
+                return -1;
+        }
+
+        else if (strcmp(argv[i], "-F") == 0 && i+1 < argc)
+        {
+            formatGiven = true;
+            if (strcmp(argv[i+1], "json") == 0)
+                setSdfFormat(sdf_format_json);
+            else if (strcmp(argv[i+1], "cbor") == 0)
+                setSdfFormat(sdf_format_cbor);
+            else if (strcmp(argv[i+1], "msgpack") == 0)
+                setSdfFormat(sdf_format_msgpack);
+            else
+            {
+                cerr << "Unknown SDF format " << argv[i+1] << "\n"
+                        + usage << endl;
+                return -1;
+            }
+        }
+
+        else if (strcmp(argv[i], "-f") == 0)
+            inputFileName = argv[i+1];
+
+        else if (strcmp(argv[i], "-o") == 0)
+            outputFileName = argv[i+1];
+
+        else if (strcmp(argv[i], "-d") == 0)
+            outputDir = argv[i+1];
+
+        else if (strcmp(argv[i], "--serve") == 0)
+        {
+            serveMode = true;
+            if (i+1 < argc && argv[i+1][0] != '-')
+                socketPath = argv[i+1];
+        }
+    }
+
+    // the module index is stored in the YANG directory by default
+    string indexFileString = "";
+    if (indexFileName)
+        indexFileString = indexFileName;
+    else if (yangDir)
+        indexFileString = string(yangDir) + "/" + MODULE_INDEX_FILE;
+
+    // the parser benchmark needs neither a YANG context nor an SDF context
+    if (benchPath)
+    {
+        ly_ctx_destroy(ctx, NULL);
+        return benchmarkSdfParsers(benchPath, benchRuns);
+    }
+
+    if (buildIndex)
+    {
+        ly_ctx_destroy(ctx, NULL);
+        if (!yangDir)
+        {
+            cerr << "No YANG directory to index specified\n" + usage << endl;
+            return -1;
+        }
+        return buildModuleIndex(yangDir, indexFileString.c_str()) ? 0 : -1;
+    }
+
+    if (!ctx)
+    {
+        // if context was not specified in arguments
+        // just load output or else current directory as context
+
+        if (outputDir)
+        {
+            ly_ctx_destroy(ctx, NULL);
+            ctx = ly_ctx_new(outputDir, 0);
+        }
+
+        if (!ctx)
+        {
+            ly_ctx_destroy(ctx, NULL);
+            ctx = ly_ctx_new(".", 0);
+        }
+
+        if (!ctx)
+        {
+            // Try loading the context from this directory with the usual name
+            ly_ctx_destroy(ctx, NULL);
+            ctx = ly_ctx_new("./yang", 0);
+        }
+
+        if (!ctx)
+        {
+            cerr << "Loading YANG context failed" << endl << endl;
+            return -1;
+        }
+    }
+
+    // look up imports in the module index if there is one
+    if (indexFileString != "" && !loadModuleIndex(ctx, indexFileString.c_str())
+            && indexFileName)
+        cerr << "Loading YANG module index " << indexFileName
+                << " failed" << endl;
+
+    if (serveMode)
+    {
+        int ret = serve(ctx, socketPath);
+        ly_ctx_destroy(ctx, NULL);
+        return ret;
+    }
+
+    if (!inputFileName)
+    {
+        cerr << "No input file name specified\n" + usage << endl;
+        return -1;
+    }
+    outputDirString = "";
+    if (outputDir)
+    {
+        regex isPath(".*/.*");
+        if (outputFileName && regex_match(outputFileName, isPath))
+        {
+            cerr << "If a path to an output directory is given the output file"
+                    " name cannot also contain a path\n\n" + usage << endl;
+            return -1;
+        }
+
+        regex isDir(".*/");
+        outputDirString = string(outputDir);
+        if (!regex_match(outputDir, isDir))
+            outputDirString += "/";
+    }
+
+    // without -F SDF models are encoded as the output file name says
+    if (!formatGiven && outputFileName && isSdfFileName(outputFileName))
+        setSdfFormat(sdfFormatOfFileName(outputFileName));
+
+    // the models of a JSON Lines bundle take a single line each
+    if (outputFileName && isSdfBundleName(outputFileName))
+    {
+        if (!formatGiven)
+            setSdfFormat(sdfBundleFormatOfFileName(outputFileName));
+        setCompactOutput(true);
+    }
+
+    // with -o - stdout only carries the converted model, progress messages
+    // are redirected to stderr
+    streambuf *stdoutBuffer = cout.rdbuf();
+    if (outputFileName && strcmp(outputFileName, "-") == 0)
+        cout.rdbuf(cerr.rdbuf());
+
+    int ret = convertFile(ctx, inputFileName, outputFileName);
+    finishValidations();
+
+    ly_ctx_destroy(ctx, NULL);
+    if (ret == 0)
+        cout << "DONE" << endl;
+    cout.rdbuf(stdoutBuffer);
+    return ret;
+}
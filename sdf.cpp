@@ -6,7 +6,15 @@
  * deserialize them was implemented as part of building a SDF/YANG converter.
  */
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef SDFCONV_WITH_SIMDJSON
+#include <simdjson.h>
+#endif
 #include "sdf.hpp"
+#include "sdfconv.hpp"
 
 using nlohmann::json_schema::json_validator;
 using namespace std;
@@ -15,12 +23,34 @@ using json = nlohmann::json;
  * Uses nlohmann/json, call it json for convenience
  */
 
-map<string, sdfCommon*> existingDefinitons;
-map<string, sdfCommon*> existingDefinitonsGlobal;
+unordered_map<sdfSymbol, sdfCommon*> existingDefinitons;
+unordered_map<sdfSymbol, sdfCommon*> existingDefinitonsGlobal;
 vector<tuple<string, sdfCommon*>> unassignedRefs;
 vector<tuple<string, sdfCommon*>> unassignedReqs;
-map<string, sdfFile*> prefixToFile;
+unordered_map<sdfSymbol, sdfFile*> prefixToFile;
+map<string, shared_ptr<json_validator>> validators;
+/**<
+ * Global storage of compiled validators, mapped by their schema file names
+ */
+sdfArena *currentArena = NULL;
+unsigned long qualityGeneration = 1;
+/**<
+ * Global counter that is incremented whenever an sdfData object or an sdfRef
+ * is changed. Resolved qualities cached in an older generation are stale.
+ */
+unsigned long referenceGeneration = 1;
+/**<
+ * Global counter that is incremented whenever an sdfCommon is renamed or
+ * reparented (or a default namespace changes). Reference strings cached in an
+ * older generation are stale.
+ */
+map<const char*, tuple<size_t, sdfArena*>> sdfArena::allBlocks;
 
+bool compactOutput = false;
+/**<
+ * Global variable to determine whether SDF JSON output is printed without
+ * indentation and line breaks
+ */
 bool contextLoaded = false;
 /**<
  * Global variable to determine whether directory has been searched for other
@@ -33,103 +63,309 @@ bool isContext = true;
  * used on.
  */
 
-string jsonDTypeToString(jsonDataType type)
-{
-    switch (type)
-    {
-    case json_number:
-        return "number";
-        break;
-    case json_string:
-        return "string";
-        break;
-    case json_boolean:
-        return "boolean";
-        break;
-    case json_integer:
-        return "integer";
-        break;
-    case json_array:
-        return "array";
-        break;
-    case json_object:
-        return "object";
-        break;
-    case json_type_undef:
-        return "";
-        break;
-    default:
+const string& jsonDTypeToString(jsonDataType type)
+{
+    // indexed by jsonDataType
+    static const string names[] = {"number", "string", "boolean", "integer",
+            "array", "object", ""};
+
+    if (type < json_number || type > json_type_undef)
+    {
         cerr << "jsonDTypeToString(): parameter is invalid type" << endl;
-        return "";
-        break;
+        return names[json_type_undef];
+    }
+    return names[type];
+}
+
+jsonDataType stringToJsonDType(const string &str)
+{
+    switch (keywordHash(str))
+    {
+    case keywordHash("number"):
+        return str == "number" ? json_number : json_type_undef;
+    case keywordHash("decimal64"):
+        return str == "decimal64" ? json_number : json_type_undef;
+    case keywordHash("string"):
+        return str == "string" ? json_string : json_type_undef;
+    case keywordHash("boolean"):
+        return str == "boolean" ? json_boolean : json_type_undef;
+    case keywordHash("bool"):
+        return str == "bool" ? json_boolean : json_type_undef;
+    case keywordHash("integer"):
+        return str == "integer" ? json_integer : json_type_undef;
+    case keywordHash("int"):
+        return str == "int" ? json_integer : json_type_undef;
+    case keywordHash("int8"):
+        return str == "int8" ? json_integer : json_type_undef;
+    case keywordHash("uint8"):
+        return str == "uint8" ? json_integer : json_type_undef;
+    case keywordHash("int16"):
+        return str == "int16" ? json_integer : json_type_undef;
+    case keywordHash("uint16"):
+        return str == "uint16" ? json_integer : json_type_undef;
+    case keywordHash("int32"):
+        return str == "int32" ? json_integer : json_type_undef;
+    case keywordHash("uint32"):
+        return str == "uint32" ? json_integer : json_type_undef;
+    case keywordHash("int64"):
+        return str == "int64" ? json_integer : json_type_undef;
+    case keywordHash("uint64"):
+        return str == "uint64" ? json_integer : json_type_undef;
+    case keywordHash("array"):
+        return str == "array" ? json_array : json_type_undef;
+    case keywordHash("object"):
+        return str == "object" ? json_object : json_type_undef;
+    default:
+        return json_type_undef;
+    }
+}
+
+sdfKeyword stringToSdfKeyword(const string &key)
+{
+    switch (keywordHash(key))
+    {
+    case keywordHash("label"):
+        return key == "label" ? key_label : key_undef;
+    case keywordHash("description"):
+        return key == "description" ? key_description : key_undef;
+    case keywordHash("sdfRef"):
+        return key == "sdfRef" ? key_sdfRef : key_undef;
+    case keywordHash("sdfRequired"):
+        return key == "sdfRequired" ? key_sdfRequired : key_undef;
+    case keywordHash("type"):
+        return key == "type" ? key_type : key_undef;
+    case keywordHash("enum"):
+        return key == "enum" ? key_enum : key_undef;
+    case keywordHash("sdfChoice"):
+        return key == "sdfChoice" ? key_sdfChoice : key_undef;
+    case keywordHash("required"):
+        return key == "required" ? key_required : key_undef;
+    case keywordHash("properties"):
+        return key == "properties" ? key_properties : key_undef;
+    case keywordHash("const"):
+        return key == "const" ? key_const : key_undef;
+    case keywordHash("default"):
+        return key == "default" ? key_default : key_undef;
+    case keywordHash("minimum"):
+        return key == "minimum" ? key_minimum : key_undef;
+    case keywordHash("maximum"):
+        return key == "maximum" ? key_maximum : key_undef;
+    case keywordHash("exclusiveMinimum"):
+        return key == "exclusiveMinimum" ? key_exclusiveMinimum : key_undef;
+    case keywordHash("exclusiveMaximum"):
+        return key == "exclusiveMaximum" ? key_exclusiveMaximum : key_undef;
+    case keywordHash("multipleOf"):
+        return key == "multipleOf" ? key_multipleOf : key_undef;
+    case keywordHash("minLength"):
+        return key == "minLength" ? key_minLength : key_undef;
+    case keywordHash("maxLength"):
+        return key == "maxLength" ? key_maxLength : key_undef;
+    case keywordHash("pattern"):
+        return key == "pattern" ? key_pattern : key_undef;
+    case keywordHash("format"):
+        return key == "format" ? key_format : key_undef;
+    case keywordHash("minItems"):
+        return key == "minItems" ? key_minItems : key_undef;
+    case keywordHash("maxItems"):
+        return key == "maxItems" ? key_maxItems : key_undef;
+    case keywordHash("uniqueItems"):
+        return key == "uniqueItems" ? key_uniqueItems : key_undef;
+    case keywordHash("items"):
+        return key == "items" ? key_items : key_undef;
+    case keywordHash("unit"):
+        return key == "unit" ? key_unit : key_undef;
+    case keywordHash("units"):
+        return key == "units" ? key_unit : key_undef;
+    case keywordHash("scaleMinimum"):
+        return key == "scaleMinimum" ? key_scaleMinimum : key_undef;
+    case keywordHash("scaleMaximum"):
+        return key == "scaleMaximum" ? key_scaleMaximum : key_undef;
+    case keywordHash("readable"):
+        return key == "readable" ? key_readable : key_undef;
+    case keywordHash("writable"):
+        return key == "writable" ? key_writable : key_undef;
+    case keywordHash("observable"):
+        return key == "observable" ? key_observable : key_undef;
+    case keywordHash("nullable"):
+        return key == "nullable" ? key_nullable : key_undef;
+    case keywordHash("contentFormat"):
+        return key == "contentFormat" ? key_contentFormat : key_undef;
+    case keywordHash("sdfType"):
+        return key == "sdfType" ? key_sdfType : key_undef;
+    case keywordHash("subtype"):
+        return key == "subtype" ? key_sdfType : key_undef;
+    case keywordHash("sdfInputData"):
+        return key == "sdfInputData" ? key_sdfInputData : key_undef;
+    case keywordHash("sdfRequiredInputData"):
+        return key == "sdfRequiredInputData" ? key_sdfRequiredInputData : key_undef;
+    case keywordHash("sdfOutputData"):
+        return key == "sdfOutputData" ? key_sdfOutputData : key_undef;
+    case keywordHash("sdfData"):
+        return key == "sdfData" ? key_sdfData : key_undef;
+    case keywordHash("sdfProperty"):
+        return key == "sdfProperty" ? key_sdfProperty : key_undef;
+    case keywordHash("sdfAction"):
+        return key == "sdfAction" ? key_sdfAction : key_undef;
+    case keywordHash("sdfEvent"):
+        return key == "sdfEvent" ? key_sdfEvent : key_undef;
+    case keywordHash("sdfObject"):
+        return key == "sdfObject" ? key_sdfObject : key_undef;
+    case keywordHash("sdfThing"):
+        return key == "sdfThing" ? key_sdfThing : key_undef;
+    case keywordHash("info"):
+        return key == "info" ? key_info : key_undef;
+    case keywordHash("namespace"):
+        return key == "namespace" ? key_namespace : key_undef;
+    case keywordHash("defaultNamespace"):
+        return key == "defaultNamespace" ? key_defaultNamespace : key_undef;
+    default:
+        return key_undef;
     }
 }
 
-jsonDataType stringToJsonDType(string str)
+/**
+ * The global symbol table. The IDs index the interned strings, the strings
+ * are stored as keys of symbolIds (their addresses do not change when the map
+ * grows).
+ */
+static unordered_map<string, sdfSymbol> symbolIds = {{"", emptySymbol}};
+static vector<const string*> symbolStrings = {&symbolIds.begin()->first};
+/** The number of symbols that are kept by releaseSymbols() */
+static size_t persistentSymbols = 1;
+
+sdfSymbol internSymbol(const string &str)
+{
+    unordered_map<string, sdfSymbol>::iterator it = symbolIds.find(str);
+    if (it != symbolIds.end())
+        return it->second;
+
+    it = symbolIds.emplace(str, (sdfSymbol)symbolStrings.size()).first;
+    symbolStrings.push_back(&it->first);
+    return it->second;
+}
+
+sdfSymbol internSymbol(const char *str)
+{
+    if (!str)
+        return emptySymbol;
+    return internSymbol(string(str));
+}
+
+sdfSymbol findSymbol(const string &str)
+{
+    unordered_map<string, sdfSymbol>::const_iterator it = symbolIds.find(str);
+    if (it == symbolIds.end())
+        return emptySymbol;
+    return it->second;
+}
+
+const string& symbolToString(sdfSymbol sym)
+{
+    if (sym >= symbolStrings.size())
+        return *symbolStrings[emptySymbol];
+    return *symbolStrings[sym];
+}
+
+void markPersistentSymbols()
+{
+    persistentSymbols = symbolStrings.size();
+}
+
+void releaseSymbols()
 {
-    if (str == "number" || str == "decimal64")
-        return json_number;
-    else if (str == "string")
-        return json_string;
-    else if (str == "boolean" || str == "bool")
-        return json_boolean;
-    else if (str == "integer" || str == "int"
-            || str == "int8" || str == "uint8"
-            || str == "int16" || str == "uint16"
-            || str == "int32" || str == "uint32"
-            || str == "int64" || str == "uint64")
-        return json_integer;
-    else if (str == "array")
-        return json_array;
-    else if (str == "object")
-        return json_object;
+    // the newest symbols have the highest IDs, so they are removed from the
+    // back (the key is looked up before the string it points to is erased)
+    while (symbolStrings.size() > persistentSymbols)
+    {
+        symbolIds.erase(symbolIds.find(*symbolStrings.back()));
+        symbolStrings.pop_back();
+    }
+}
 
-    return json_type_undef;
+/*
+ * Makes the definitions of a context file available under its default
+ * namespace prefix.
+ */
+static void registerContextFile(sdfFile *file, string &prefix)
+{
+    if (file->getNamespace())
+        prefix = file->getNamespace()->getDefaultNamespace();
+    if (prefix != "")
+        prefixToFile[internSymbol(prefix)] = file;
 }
 
-void loadContext(const char *path = ".")
+void loadContext(const char *path)
 {
     contextLoaded = true;
     isContext = true;
 
+    // the bundles of the context stay loaded until the program ends (like
+    // the other context files) because their definitions are made global
+    // while they are loaded, even if a bundle is only loaded in part
+    static vector<shared_ptr<sdfBundle>> bundles;
+    vector<sdfFile*> loaded;
+    string prefix = "";
+
     cout << "Searching for SDF context files..." << endl;
     DIR *dir;
     struct dirent *ent;
-    if ((dir = opendir (path)) != NULL)
+    if (isSdfBundleName(path))
+    {
+        // a whole context in a single bundle file
+        cout << "...found: " + string(path) << endl;
+        shared_ptr<sdfBundle> bundle(new sdfBundle());
+        bundles.push_back(bundle);
+        if (!bundle->fromFile(path))
+            cerr << "loadContext: bundle " << path << " could not be split"
+                    << endl;
+        for (sdfFile *file : bundle->getFiles())
+        {
+            registerContextFile(file, prefix);
+            loaded.push_back(file);
+        }
+        cout << "-> finished" << endl << endl;
+    }
+    else if ((dir = opendir (path)) != NULL)
     {
-        std::regex sdfRegex (".*\\.sdf\\.json");
         string fileName = "";
         vector<string> names;
+        vector<string> bundleNames;
         while ((ent = readdir (dir)) != NULL)
         {
             fileName = string(ent->d_name);
-            if (regex_match(fileName, sdfRegex))
+            if (isSdfFileName(fileName))
                 names.push_back(fileName);
+            else if (isSdfBundleName(fileName))
+                bundleNames.push_back(fileName);
         }
         closedir (dir);
 
-        string prefix = "";
         static shared_ptr<sdfFile[]> files(new sdfFile[names.size()]());
         for (int i = 0; i < names.size(); i++)
         {
             cout << "...found: " + names[i] << endl;
             files[i].fromFile(names[i]);
-            if (files[i].getNamespace())
-                prefix = files[i].getNamespace()->getDefaultNamespace();
-            if (prefix != "")
-                prefixToFile[prefix] = &files[i];
+            registerContextFile(&files[i], prefix);
+            loaded.push_back(&files[i]);
+        }
+        for (const string &name : bundleNames)
+        {
+            cout << "...found: " + name << endl;
+            shared_ptr<sdfBundle> bundle(new sdfBundle());
+            bundles.push_back(bundle);
+            if (!bundle->fromFile(string(path) + "/" + name))
+                cerr << "loadContext: bundle " << name << " could not be split"
+                        << endl;
+            for (sdfFile *file : bundle->getFiles())
+            {
+                registerContextFile(file, prefix);
+                loaded.push_back(file);
+            }
         }
-        if (names.size() == 0)
+        if (names.size() == 0 && bundleNames.size() == 0)
             cout <<  "...no files found" << endl;
 
         cout << "-> finished" << endl << endl;
-
-        // update named files in namespaces after all files are loaded
-        for (int i = 0; i < names.size(); i++)
-        {
-            if (files[i].getNamespace())
-                files[i].getNamespace()->updateNamedFiles();
-        }
     }
     else
     {
@@ -138,7 +374,25 @@ void loadContext(const char *path = ".")
         perror ("");
     }
 
+    // update named files in namespaces after all files are loaded
+    for (sdfFile *file : loaded)
+    {
+        if (file->getNamespace())
+            file->getNamespace()->updateNamedFiles();
+    }
+
+    // the global definitions of the context are keyed by these symbols
+    markPersistentSymbols();
+    isContext = false;
+}
+
+void resetSdfState()
+{
+    existingDefinitons.clear();
+    unassignedRefs.clear();
+    unassignedReqs.clear();
     isContext = false;
+    releaseSymbols();
 }
 
 sdfCommon* refToCommon(string ref, std::string nsPrefix)
@@ -161,17 +415,18 @@ sdfCommon* refToCommon(string ref, std::string nsPrefix)
 //    cout << refAlter << endl;
 
     // Look through definitions for ref / alternative ref
-    if (existingDefinitonsGlobal[ref])
-        return existingDefinitonsGlobal[ref];
+    sdfCommon *def;
+    if ((def = findBySymbol(existingDefinitonsGlobal, ref)))
+        return def;
 
-    else if (existingDefinitonsGlobal[refAlter])
-        return existingDefinitonsGlobal[refAlter];
+    else if ((def = findBySymbol(existingDefinitonsGlobal, refAlter)))
+        return def;
 
-    else if (existingDefinitons[ref])
-        return existingDefinitons[ref];
+    else if ((def = findBySymbol(existingDefinitons, ref)))
+        return def;
 
-    else if (existingDefinitons[refAlter])
-        return existingDefinitons[ref];
+    else if (findBySymbol(existingDefinitons, refAlter))
+        return findBySymbol(existingDefinitons, ref);
 
 //    else
 //        cerr << "refToCommon(): definition for reference "
@@ -208,7 +463,7 @@ vector<tuple<string, sdfCommon*>> assignRefs(
             //cout << com->getName()+" refs "+ref->getName()<<endl;
         }
 
-        vector<sdfCommon*> reqs = com->getRequired();
+        const vector<sdfCommon*> &reqs = com->getRequired();
         if (!com || (r == REF && !com->getReference()) ||
                 (r == REQ && find(reqs.begin(), reqs.end(), ref) == reqs.end()))
             stillLeft.push_back(unRefs);
@@ -233,6 +488,136 @@ string correctValue(string val)
     return correct;
 }
 
+sdfArena::sdfArena(size_t _blockSize)
+    : blockSize(_blockSize), next(NULL), left(0)
+{}
+
+sdfArena::~sdfArena()
+{
+    this->clear();
+}
+
+void* sdfArena::allocate(size_t size)
+{
+    // keep every node aligned like memory returned by operator new
+    size_t align = alignof(max_align_t);
+    size = (size + align - 1) / align * align;
+
+    if (size > left)
+    {
+        // nodes larger than a block get a block of their own
+        size_t newSize = max(size, blockSize);
+        char *block = new char[newSize];
+        blocks.push_back(block);
+        allBlocks[block] = make_tuple(newSize, this);
+        next = block;
+        left = newSize;
+    }
+    void *ptr = next;
+    next += size;
+    left -= size;
+    return ptr;
+}
+
+size_t sdfArena::adopt(sdfCommon *node)
+{
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+void sdfArena::release(size_t slot)
+{
+    if (slot < nodes.size())
+        nodes[slot] = NULL;
+}
+
+void sdfArena::clear()
+{
+    // destroy the nodes in reverse order of their construction, their
+    // destructors do not touch other nodes of the arena
+    for (size_t i = nodes.size(); i > 0; i--)
+    {
+        sdfCommon *node = nodes[i-1];
+        if (node)
+            node->~sdfCommon();
+    }
+    nodes.clear();
+
+    for (char *block : blocks)
+    {
+        allBlocks.erase(block);
+        delete[] block;
+    }
+    blocks.clear();
+    next = NULL;
+    left = 0;
+}
+
+sdfArena* sdfArena::arenaOf(const void *ptr)
+{
+    const char *p = (const char*)ptr;
+
+    // find the last block that starts at or before ptr
+    auto it = allBlocks.upper_bound(p);
+    if (it == allBlocks.begin())
+        return NULL;
+    --it;
+
+    if (p < it->first + get<0>(it->second))
+        return get<1>(it->second);
+    return NULL;
+}
+
+/*
+ * Deletes a child node unless it is owned by an arena (nodes owned by an arena
+ * are destroyed together with the arena)
+ */
+template<typename T>
+static void deleteChild(T *&child)
+{
+    if (child && !child->getArena())
+        delete child;
+    child = NULL;
+}
+
+/*
+ * Deletes the child nodes in the given vector, see deleteChild()
+ */
+template<typename T>
+static void deleteChildren(vector<T*> &children)
+{
+    for (T *&child : children)
+        deleteChild(child);
+    children.clear();
+}
+
+sdfArenaScope::sdfArenaScope(sdfArena *arena) : previous(currentArena)
+{
+    currentArena = arena;
+}
+
+sdfArenaScope::~sdfArenaScope()
+{
+    currentArena = previous;
+}
+
+void* sdfCommon::operator new(size_t size)
+{
+    if (currentArena)
+        return currentArena->allocate(size);
+
+    return ::operator new(size);
+}
+
+void sdfCommon::operator delete(void *ptr)
+{
+    // the memory of nodes in an arena is freed together with the arena
+    if (!ptr || sdfArena::arenaOf(ptr))
+        return;
+
+    ::operator delete(ptr);
+}
+
 sdfCommon::sdfCommon(
         std::string _name,
         std::string _description,
@@ -240,15 +625,32 @@ sdfCommon::sdfCommon(
         std::vector<sdfCommon*> _required,
         sdfFile *_file
         )
-            : description(_description), name(_name), reference(_reference),
-              required(_required), parentFile(_file)
+            : description(move(_description)), name(move(_name)),
+              reference(_reference), required(move(_required)),
+              parentFile(_file)
 {
     label = "";
     //this->parent = NULL;
+
+    // nodes constructed in the memory of an arena are owned by it
+    arena = sdfArena::arenaOf(this);
+    arenaSlot = 0;
+    if (arena)
+        arenaSlot = arena->adopt(this);
+}
+
+sdfCommon::sdfCommon(sdfCommon &&common)
+    : sdfCommon(move(common.name), move(common.description), common.reference,
+            move(common.required), common.parentFile)
+{
+    label = move(common.label);
 }
 
 sdfCommon::~sdfCommon()
 {
+    if (arena)
+        arena->release(arenaSlot);
+
     // items in required cannot be deleted because they are deleted somewhere
     // else as sdfData pointers already which are somehow not affected by the
     // i = NULL command and then cause a segfault
@@ -264,9 +666,17 @@ sdfCommon::~sdfCommon()
     parentFile = NULL;
 }
 
+sdfArena* sdfCommon::getArena() const
+{
+    return arena;
+}
+
 void sdfCommon::setLabel(string _label)
 {
-    this->label = _label;
+    // getName() falls back to the label, so references may change
+    if (label != _label)
+        referenceGeneration++;
+    this->label = move(_label);
 }
 
 string sdfCommon::getDescription()
@@ -284,12 +694,12 @@ const char* sdfCommon::getLabelAsArray()
     return label.c_str();
 }
 
-sdfCommon* sdfCommon::getReference()
+sdfCommon* sdfCommon::getReference() const
 {
     return this->reference;
 }
 
-vector<sdfCommon*> sdfCommon::getRequired()
+const vector<sdfCommon*>& sdfCommon::getRequired()
 {
     return required;
 }
@@ -316,8 +726,14 @@ void sdfCommon::addRequired(sdfCommon *common)
     this->required.push_back(common);
 }
 
+void sdfCommon::setRequired(vector<sdfCommon*> _required)
+{
+    this->required = move(_required);
+}
+
 void sdfCommon::setReference(sdfCommon *common)
 {
+    qualityGeneration++;
     this->reference = common;
 }
 
@@ -353,7 +769,8 @@ sdfObjectElement::sdfObjectElement(
         std::vector<sdfCommon*> _required,
         sdfObject *_parentObject
         )
-            : sdfCommon(_name, _description, _reference, _required),
+            : sdfCommon(move(_name), move(_description), _reference,
+                    move(_required)),
               parentObject(_parentObject)
 {
 }
@@ -371,6 +788,8 @@ sdfObject* sdfObjectElement::getParentObject() const
 
 void sdfObjectElement::setParentObject(sdfObject *_parentObject)
 {
+    if (this->parentObject != _parentObject)
+        referenceGeneration++;
     this->parentObject = _parentObject;
 }
 
@@ -398,8 +817,8 @@ sdfInfoBlock::sdfInfoBlock(
         std::string _copyright,
         std::string _license
         )
-            : title(_title), version(_version), copyright(_copyright),
-              license(_license)
+            : title(move(_title)), version(move(_version)),
+              copyright(move(_copyright)), license(move(_license))
 {}
 
 string sdfInfoBlock::getTitle()
@@ -449,7 +868,7 @@ sdfNamespaceSection::sdfNamespaceSection(
     // link files no foreign namespaces
     map<string, string>::iterator it;
     for (it = namespaces.begin(); it != namespaces.end(); it++)
-        namedFiles[it->first] = prefixToFile[it->first];
+        namedFiles[it->first] = findBySymbol(prefixToFile, it->first);
 
     if (!default_ns.empty())
         namedFiles[default_ns] = NULL;
@@ -500,76 +919,28 @@ sdfData::sdfData(
         sdfCommon *_parentCommon,
         std::vector<sdfData*> _choice
         )
-            : sdfCommon(_name, _description, _reference, _required),
+            : sdfCommon(move(_name), move(_description), _reference,
+                    move(_required)),
               parent(_parentCommon)
 {
     simpleType = stringToJsonDType(_type);
-    derType = _type;
+    derType = move(_type);
 
     this->setParentCommon(_parentCommon);
 
-    readable = NAN;
-    writable = NAN;
-    observable = NAN;
-    nullable = NAN;
-    readableDefined = false;
-    writableDefined = false;
-    observableDefined = false;
-    nullableDefined = false;
+    // readable, writable, observable, nullable and uniqueItems are true
+    // unless stated otherwise (they are only printed if they are defined)
+    flags = 0;
+    setFlag(flag_readable, true);
+    setFlag(flag_writable, true);
+    setFlag(flag_observable, true);
+    setFlag(flag_nullable, true);
+    setFlag(flag_unique_items, true);
     subtype = sdf_subtype_undef;
-    format = json_format_undef;
-    constDefined = false;
-    defaultDefined = false;
-    constBoolDefined = false;
-    defaultBoolDefined = false;
-    constIntDefined = false;
-    defaultIntDefined = false;
-    constantBool = false;
-    defaultBool = false;
-    constantString = "";
-    defaultString = "";
-    constantNumber = NAN;
-    defaultNumber = NAN;
-    constantInt = -1;
-    defaultInt = -1;
-    //defaultObject = NULL;
-    //constantObject = NULL;
-    defaultBoolArray = {};
-    constantBoolArray = {};
-    defaultStringArray = {};
-    constantStringArray = {};
-    defaultNumberArray = {};
-    constantNumberArray = {};
-    defaultIntArray = {};
-    constantIntArray = {};
-    //constantAsCharArray = NULL;
-    //defaultAsCharArray = NULL;
-    exclusiveMaximum_bool = false;
-    exclusiveMinimum_bool = false;
-    minLength = NAN;
-    maxLength = NAN;
-    minimum = NAN;
-    maximum = NAN;
-    minInt = 0;
-    maxInt = 0;
-    minIntSet = false;
-    maxIntSet = false;
-    multipleOf = NAN;
-    exclusiveMinimum_number = NAN;
-    exclusiveMaximum_number = NAN;
-    pattern = "";
-    maxItems = NAN;
-    minItems = NAN;
-    uniqueItems = NAN;
-    uniqueItemsDefined = false;
+    // constantValue, defaultValue and the constraints start out undefined
     item_constr = NULL;
-    units = "";
-    scaleMinimum = NAN;
-    scaleMaximum = NAN;
-    contentFormat = "";
-    sdfChoice = _choice;
+    sdfChoice = move(_choice);
     objectProperties = {};
-    requiredObjectProperties = {};
 }
 
 sdfData::sdfData(
@@ -580,115 +951,135 @@ sdfData::sdfData(
         std::vector<sdfCommon*> _required,
         sdfCommon *_parentCommon,
         std::vector<sdfData*> _choice)
-            : sdfData(_name, _description, jsonDTypeToString(_type), _reference,
-                    _required, _parentCommon, _choice)
+            : sdfData(move(_name), move(_description), jsonDTypeToString(_type),
+                    _reference, move(_required), _parentCommon, move(_choice))
 {}
 
 sdfData::sdfData(sdfData &data)
     : sdfData(data.getName(), data.getDescription(), data.getType(),
             data.getReference(), data.getRequired(), NULL, data.getChoice())
 {
-    readable = data.getReadable();
-    writable = data.getWritable();
-    observable = data.getObservable();
-    nullable = data.getNullable();
-    readableDefined = data.getReadableDefined();
-    writableDefined = data.getWritableDefined();
-    observableDefined = data.getObservableDefined();
-    nullableDefined = data.getNullableDefined();
+    flags = data.flags;
+    setFlag(flag_exclusive_maximum, false);
+    setFlag(flag_exclusive_minimum, false);
     subtype = data.getSubtype();
-    format = data.getFormat();
-    constDefined = data.getConstantDefined();
-    defaultDefined = data.getDefaultDefined();
-    constBoolDefined = data.getConstantBoolDefined();
-    defaultBoolDefined = data.getDefaultBoolDefined();
-    constIntDefined = data.getConstantIntDefined();
-    defaultIntDefined = data.getDefaultIntDefined();
-    constantBool = data.getConstantBool();
-    defaultBool = data.getDefaultBool();
-    constantString = data.getDefaultString();
-    defaultString = data.getDefaultString();
-    constantNumber = data.getConstantNumber();
-    defaultNumber = data.getDefaultNumber();
-    constantInt = data.getConstantInt();
-    defaultInt = data.getDefaultInt();
-    //defaultObject = data.getDefaultObject();
-    //constantObject = data.getConstantObject();
-    defaultBoolArray = data.getDefaultBoolArray();
-    constantBoolArray = data.getConstantBoolArray();
-    defaultStringArray = data.getDefaultStringArray();
-    constantStringArray = data.getConstantStringArray();
-    defaultNumberArray = data.getDefaultNumberArray();
-    constantNumberArray = data.getConstantNumberArray();
-    defaultIntArray = data.getDefaultIntArray();
-    constantIntArray = data.getConstantIntArray();
-    //constantAsCharArray = data.getConstantAsCharArray();
-    //defaultAsCharArray = data.getDefaultAsCharArray();
-    exclusiveMaximum_bool = false;
-    exclusiveMinimum_bool = false;
-    minLength = data.getMinLength();
-    maxLength = data.getMaxLength();
-    minimum = data.getMinimum();
-    maximum = data.getMaximum();
-    minInt = data.getMinInt();
-    maxInt = data.getMaxInt();
-    minIntSet = data.getMinIntSet();
-    maxIntSet = data.getMaxIntSet();
-    multipleOf = data.getMultipleOf();
-    exclusiveMinimum_number = data.getExclusiveMinimumNumber();
-    exclusiveMaximum_number = data.getExclusiveMaximumNumber();
-    pattern = data.getPattern();
-    maxItems = data.getMaxItems();
-    minItems = data.getMinItems();
-    uniqueItems = data.getUniqueItems();
-    uniqueItemsDefined = data.getUniqueItemsDefined();
+    constantValue = data.constantValue;
+    defaultValue = data.defaultValue;
+    if (data.constraints)
+        constraints.reset(new sdfDataConstraints(*data.constraints));
     if (data.getItemConstr())
     this->setItemConstr(data.getItemConstr()); // deep or shallow copy?
     //this->setItemConstr(new sdfData(*data.getItemConstr()));
-    units = data.getUnits(true);
-    scaleMinimum = data.getScaleMinimum();
-    scaleMaximum = data.getScaleMaximum();
-    contentFormat = data.getContentFormat();
     this->setChoice(data.getChoice());
     //for (sdfData *d : data.getChoice())
     //    this->addChoice(new sdfData(*d));
     this->setObjectProperties(data.getObjectProperties());
     //for (sdfData *d : data.getObjectProperties())
     //    this->addObjectProperty(new sdfData(*d));
-    requiredObjectProperties = data.getRequiredObjectProperties();
-    enumString = data.getEnumString();
 }
 sdfData::sdfData(sdfProperty &prop)
     : sdfData((sdfData&)prop)
 {
 }
 
+sdfData::sdfData(sdfData &&data)
+    : sdfCommon(move(data)), parent(NULL)
+{
+    // like the copy constructor, the type is taken over as resolved through
+    // the sdfRef
+    this->setType(data.getType());
+    flags = data.flags;
+    setFlag(flag_exclusive_maximum, false);
+    setFlag(flag_exclusive_minimum, false);
+    subtype = data.getSubtype();
+    constantValue = move(data.constantValue);
+    defaultValue = move(data.defaultValue);
+    constraints = move(data.constraints);
+
+    // take over the children, the moved-from object must not delete them
+    // (the setters below invalidate the cached resolved qualities)
+    item_constr = NULL;
+    this->setItemConstr(data.item_constr);
+    data.item_constr = NULL;
+    this->setChoice(move(data.sdfChoice));
+    data.sdfChoice.clear();
+    this->setObjectProperties(move(data.objectProperties));
+    data.objectProperties.clear();
+}
+
 sdfData::~sdfData()
 {
-    for (int i = 0; i < objectProperties.size(); i++)
-    {
-        delete objectProperties[i];
-        objectProperties[i] = NULL;
-    }
-    objectProperties.clear();
+    // cached resolved qualities might point to this object
+    qualityGeneration++;
 
-    for (int i = 0; i < sdfChoice.size(); i++)
+    // the children of a node in an arena belong to the arena as well
+    if (!this->getArena())
     {
-        delete sdfChoice[i];
-        sdfChoice[i] = NULL;
+        deleteChildren(objectProperties);
+        deleteChildren(sdfChoice);
+        deleteChild(item_constr);
     }
-    sdfChoice.clear();
-
-    //delete[] objectProperties.data();
-    //delete[] sdfChoice.data();
-
-    delete item_constr;
-    item_constr = NULL;
 
     // if parent was deleted a loop would be created
     parent = NULL;
 }
 
+bool sdfData::flag(sdfDataFlag f) const
+{
+    return flags & (1u << f);
+}
+
+void sdfData::setFlag(sdfDataFlag f, bool value)
+{
+    if (value)
+        flags |= (1u << f);
+    else
+        flags &= ~(1u << f);
+}
+
+const sdfDataConstraints& sdfData::getConstraints() const
+{
+    // shared by all sdfData objects without constraints
+    static const sdfDataConstraints undefinedConstraints;
+
+    if (constraints)
+        return *constraints;
+    return undefinedConstraints;
+}
+
+sdfDataConstraints& sdfData::editConstraints()
+{
+    qualityGeneration++;
+    if (!constraints)
+        constraints.reset(new sdfDataConstraints());
+    return *constraints;
+}
+
+/*
+ * Checks whether a constraint value equals the value of an undefined
+ * constraint
+ */
+static bool isUndefinedConstraint(float value) { return isnan(value); }
+static bool isUndefinedConstraint(double value) { return isnan(value); }
+static bool isUndefinedConstraint(int64_t value) { return value == 0; }
+static bool isUndefinedConstraint(uint64_t value) { return value == 0; }
+static bool isUndefinedConstraint(jsonSchemaFormat value)
+{
+    return value == json_format_undef;
+}
+template<typename T>
+static bool isUndefinedConstraint(const T &value) { return value.empty(); }
+
+template<typename T, typename U>
+void sdfData::setConstraint(T sdfDataConstraints::*member, U &&value)
+{
+    T converted = std::forward<U>(value);
+    // do not allocate the constraints just to store an undefined value
+    if (!constraints && isUndefinedConstraint(converted))
+        return;
+    editConstraints().*member = move(converted);
+}
+
 void sdfData::setNumberData(float _constant,
         float _default, float _min, float _max, float _multipleOf)
 {
@@ -704,19 +1095,19 @@ void sdfData::setNumberData(float _constant,
                 "maximum value: " << _min << " > " << _max << endl;
     this->setType(json_number);
     //enumNumber = _enum;
-    constantNumber = _constant;
-    defaultNumber = _default;
-    minimum = _min;
-    maximum = _max;
-    multipleOf = _multipleOf;
+    constantValue = _constant;
+    defaultValue = _default;
+    setConstraint(&sdfDataConstraints::minimum, _min);
+    setConstraint(&sdfDataConstraints::maximum, _max);
+    setConstraint(&sdfDataConstraints::multipleOf, _multipleOf);
     if(isnan(_constant))
-        constDefined = false;
+        setFlag(flag_const_defined, false);
     else
-        constDefined = true;
+        setFlag(flag_const_defined, true);
     if (isnan(_default))
-        defaultDefined = false;
+        setFlag(flag_default_defined, false);
     else
-        defaultDefined = true;
+        setFlag(flag_default_defined, true);
 }
 
 void sdfData::setStringData(string _constant, string _default,
@@ -731,21 +1122,16 @@ void sdfData::setStringData(string _constant, string _default,
         return;
     }
     this->setType(json_string);
-    enumString = _enum;
-    constantString = _constant;
-    defaultString = _default;
-    minLength = _minLength;
-    maxLength = _maxLength;
-    pattern = _pattern;
-    format = _format;
-    if(_constant == "")
-        constDefined = false;
-    else
-        constDefined = true;
-    if (_default == "")
-        defaultDefined = false;
-    else
-        defaultDefined = true;
+    setConstraint(&sdfDataConstraints::enumString, move(_enum));
+    // the flags are set before the values are moved away
+    setFlag(flag_const_defined, _constant != "");
+    setFlag(flag_default_defined, _default != "");
+    constantValue = move(_constant);
+    defaultValue = move(_default);
+    setConstraint(&sdfDataConstraints::minLength, _minLength);
+    setConstraint(&sdfDataConstraints::maxLength, _maxLength);
+    setConstraint(&sdfDataConstraints::pattern, move(_pattern));
+    setConstraint(&sdfDataConstraints::format, _format);
 }
 
 void sdfData::setBoolData(bool _constant, bool defineConst, bool _default,
@@ -760,12 +1146,12 @@ void sdfData::setBoolData(bool _constant, bool defineConst, bool _default,
     }
     this->setType(json_boolean);
     //enumBool = _enum;
-    constDefined = defineConst;
-    constBoolDefined = defineConst;
-    constantBool = _constant;
-    defaultDefined = defineDefault;
-    defaultBoolDefined = defineDefault;
-    defaultBool = _default;
+    setFlag(flag_const_defined, defineConst);
+    setFlag(flag_const_bool_defined, defineConst);
+    constantValue = _constant;
+    setFlag(flag_default_defined, defineDefault);
+    setFlag(flag_default_bool_defined, defineDefault);
+    defaultValue = _default;
 }
 
 void sdfData::setIntData(int _constant, bool defineConst, int _default,
@@ -783,19 +1169,20 @@ void sdfData::setIntData(int _constant, bool defineConst, int _default,
                 "maximum value: " << _min << " > " << _max << endl;
     this->setType(json_integer);
     //enumInt = _enum;
-    constDefined = defineConst;
-    constIntDefined = defineConst;
-    constantInt = _constant;
-    defaultDefined = defineDefault;
-    defaultIntDefined = defineDefault;
-    defaultInt = _default;
-    minimum = _min;
-    maximum = _max;
+    setFlag(flag_const_defined, defineConst);
+    setFlag(flag_const_int_defined, defineConst);
+    constantValue = (int64_t)_constant;
+    setFlag(flag_default_defined, defineDefault);
+    setFlag(flag_default_int_defined, defineDefault);
+    defaultValue = (int64_t)_default;
+    setConstraint(&sdfDataConstraints::minimum, _min);
+    setConstraint(&sdfDataConstraints::maximum, _max);
 }
 
 void sdfData::setArrayData(float _minItems, float _maxItems,
         bool _uniqueItems, sdfData *_itemConstr)
 {
+    qualityGeneration++;
     if (simpleType != json_array && simpleType != json_type_undef)
     {
         cerr << this->getName() + " cannot be instantiated as type array"
@@ -810,20 +1197,20 @@ void sdfData::setArrayData(float _minItems, float _maxItems,
         //return;
     }
     if (_itemConstr != NULL &&
-            (_itemConstr->constDefined
-            || _itemConstr->defaultDefined
-            || _itemConstr->pattern != ""
-            || !isnan(_itemConstr->multipleOf)
-            || !isnan(_itemConstr->exclusiveMaximum_number)
-            || !isnan(_itemConstr->exclusiveMinimum_number)
-            || _itemConstr->exclusiveMaximum_bool
-            || _itemConstr->exclusiveMinimum_bool))
+            (_itemConstr->flag(flag_const_defined)
+            || _itemConstr->flag(flag_default_defined)
+            || _itemConstr->getConstraints().pattern != ""
+            || !isnan(_itemConstr->getConstraints().multipleOf)
+            || !isnan(_itemConstr->getConstraints().exclusiveMaximum_number)
+            || !isnan(_itemConstr->getConstraints().exclusiveMinimum_number)
+            || _itemConstr->flag(flag_exclusive_maximum)
+            || _itemConstr->flag(flag_exclusive_minimum)))
         cerr << "setArrayData(): item constraints contain invalid attributes"
         << endl;
     this->setType(json_array);
-    minItems = _minItems;
-    maxItems = _maxItems;
-    uniqueItems = _uniqueItems;
+    setConstraint(&sdfDataConstraints::minItems, _minItems);
+    setConstraint(&sdfDataConstraints::maxItems, _maxItems);
+    setFlag(flag_unique_items, _uniqueItems);
     item_constr = _itemConstr;
 }
 /*
@@ -831,13 +1218,14 @@ void sdfData::setArrayData(vector<string> enm, float _minItems,
         float _maxItems, bool _uniqueItems, string item_type, sdfCommon *ref,
         float minLength, float maxLength, jsonSchemaFormat format)
 {
+    qualityGeneration++;
     this->setArrayData(_minItems, _maxItems, _uniqueItems, item_type, ref);
 
     item_constr = new sdfData("", "", item_type, ref);
     if (item_constr->getSimpType() == json_string)
     {
         item_constr->setStringData("", "", minLength, maxLength,
-                "", format, enm);
+                "", format, move(enm));
     }
 }
 
@@ -845,6 +1233,7 @@ void sdfData::setArrayData(vector<float> enm, float _minItems,
         float _maxItems, bool _uniqueItems, string item_type, sdfCommon *ref,
         float min, float max)
 {
+    qualityGeneration++;
     this->setArrayData(_minItems, _maxItems, _uniqueItems, item_type, ref);
 
     item_constr = new sdfData("", "", item_type, ref);
@@ -858,6 +1247,7 @@ void sdfData::setArrayData(vector<int> enm, float _minItems,
         float _maxItems, bool _uniqueItems, string item_type, sdfCommon *ref,
         float min, float max)
 {
+    qualityGeneration++;
     this->setArrayData(_minItems, _maxItems, _uniqueItems, item_type, ref);
 
     item_constr = new sdfData("", "", item_type, ref);
@@ -869,26 +1259,26 @@ void sdfData::setArrayData(vector<int> enm, float _minItems,
 */
 void sdfData::setUnits(string _units, float _scaleMin, float _scaleMax)
 {
-    units = _units;
-    scaleMinimum = _scaleMin;
-    scaleMaximum = _scaleMax;
+    setConstraint(&sdfDataConstraints::units, move(_units));
+    setConstraint(&sdfDataConstraints::scaleMinimum, _scaleMin);
+    setConstraint(&sdfDataConstraints::scaleMaximum, _scaleMax);
 }
 
 void sdfData::setReadWrite(bool _readable, bool _writable)
 {
-    readable = _readable;
-    writable = _writable;
+    setFlag(flag_readable, _readable);
+    setFlag(flag_writable, _writable);
 }
 
 void sdfData::setObserveNull(bool _observable, bool _nullable)
 {
-    observable = _observable;
-    nullable = _nullable;
+    setFlag(flag_observable, _observable);
+    setFlag(flag_nullable, _nullable);
 }
 
 void sdfData::setFormat(jsonSchemaFormat _format)
 {
-    format = _format;
+    setConstraint(&sdfDataConstraints::format, _format);
 }
 
 void sdfData::setSubtype(sdfSubtype _subtype)
@@ -896,49 +1286,60 @@ void sdfData::setSubtype(sdfSubtype _subtype)
     subtype = _subtype;
 }
 
+/*
+ * Returns the value held by an sdfValue if it is of the requested type and the
+ * given undefined value otherwise
+ */
+template<typename T>
+static T valueOr(const sdfValue &value, T undefined)
+{
+    const T *held = std::get_if<T>(&value);
+    return held ? *held : undefined;
+}
+
 bool sdfData::getConstantBool()
 {
-    return constantBool;
+    return valueOr<bool>(constantValue, false);
 }
 
 int64_t sdfData::getConstantInt()
 {
-    return constantInt;
+    return valueOr<int64_t>(constantValue, -1);
 }
 
 float sdfData::getConstantNumber()
 {
-    return constantNumber;
+    return valueOr<float>(constantValue, NAN);
 }
 
 string sdfData::getConstantString()
 {
-    return constantString;
+    return valueOr<string>(constantValue, "");
 }
 
 string sdfData::getContentFormat()
 {
-    return contentFormat;
+    return getConstraints().contentFormat;
 }
 
 bool sdfData::getDefaultBool()
 {
-    return defaultBool;
+    return valueOr<bool>(defaultValue, false);
 }
 
 int64_t sdfData::getDefaultInt()
 {
-    return defaultInt;
+    return valueOr<int64_t>(defaultValue, -1);
 }
 
 float sdfData::getDefaultNumber()
 {
-    return defaultNumber;
+    return valueOr<float>(defaultValue, NAN);
 }
 
 string sdfData::getDefaultString()
 {
-    return defaultString;
+    return valueOr<string>(defaultValue, "");
 }
 /*
 vector<bool> sdfData::getEnumBool()
@@ -956,112 +1357,104 @@ vector<float> sdfData::getEnumNumber()
     return enumNumber;
 }
 */
-vector<string> sdfData::getEnumString()
+const vector<string>& sdfData::getEnumString()
 {
-    return enumString;
+    return getConstraints().enumString;
 }
 
 bool sdfData::isExclusiveMaximumBool()
 {
-    return exclusiveMaximum_bool;
+    return flag(flag_exclusive_maximum);
 }
 
 float sdfData::getExclusiveMaximumNumber()
 {
-    return exclusiveMaximum_number;
+    return getConstraints().exclusiveMaximum_number;
 }
 
 bool sdfData::isExclusiveMinimumBool()
 {
-    return exclusiveMinimum_bool;
+    return flag(flag_exclusive_minimum);
 }
 
 float sdfData::getExclusiveMinimumNumber()
 {
-    return exclusiveMinimum_number;
+    return getConstraints().exclusiveMinimum_number;
 }
 
 jsonSchemaFormat sdfData::getFormat()
 {
-    return format;
+    return getConstraints().format;
 }
 
 float sdfData::getMaximum()
 {
-    return maximum;
+    return getConstraints().maximum;
 }
 
 float sdfData::getMaxItems()
 {
-    return maxItems;
+    return getConstraints().maxItems;
 }
 
-float sdfData::getMaxItemsOfRef()
+float sdfData::getMaxItemsOfRef() const
 {
-    sdfData *ref = this->getSdfDataReference();
-    if (isnan(maxItems) && ref)
-        return ref->getMaxItemsOfRef();
-
-    return maxItems;
+    return getResolved().maxItems;
 }
 
 float sdfData::getMaxLength()
 {
-    return maxLength;
+    return getConstraints().maxLength;
 }
 
 float sdfData::getMinimum()
 {
-    return minimum;
+    return getConstraints().minimum;
 }
 
 float sdfData::getMinItems()
 {
-    return minItems;
+    return getConstraints().minItems;
 }
 
-float sdfData::getMinItemsOfRef()
+float sdfData::getMinItemsOfRef() const
 {
-    sdfData *ref = this->getSdfDataReference();
-    if (isnan(minItems) && ref)
-        return ref->getMinItemsOfRef();
-
-    return minItems;
+    return getResolved().minItems;
 }
 
 float sdfData::getMinLength()
 {
-    return minLength;
+    return getConstraints().minLength;
 }
 
 float sdfData::getMultipleOf()
 {
-    return multipleOf;
+    return getConstraints().multipleOf;
 }
 
 bool sdfData::getNullable()
 {
-    return nullable;
+    return flag(flag_nullable);
 }
 
 bool sdfData::getObservable()
 {
-    return observable;
+    return flag(flag_observable);
 }
 
 string sdfData::getPattern()
 {
-    return pattern;
+    return getConstraints().pattern;
 }
 
 float sdfData::getScaleMaximum()
 {
-    return scaleMaximum;
+    return getConstraints().scaleMaximum;
 }
 
 float sdfData::getScaleMinimum()
 {
-    return scaleMinimum;
+    return getConstraints().scaleMinimum;
 }
 
 sdfSubtype sdfData::getSubtype()
@@ -1069,89 +1462,105 @@ sdfSubtype sdfData::getSubtype()
     return subtype;
 }
 
-string sdfData::getType()
+const sdfResolvedQualities& sdfData::getResolved() const
 {
+    if (resolved && resolved->generation == qualityGeneration)
+        return *resolved;
+    if (!resolved)
+        resolved.reset(new sdfResolvedQualities());
+    sdfResolvedQualities &res = *resolved;
+
+    sdfData *ref = NULL;
     if (this->getReference())
     {
-//        if (simpleType != json_type_undef)
-//            cerr << "sdfData::getType: " + this->getName() +
-//            " has an sdfRef and a type given (sdfRef to "
-//            + this->getReference()->getName() + " and own type "
-//            + jsonDTypeToString(simpleType) + ")" << endl;
-
-        sdfData *ref = dynamic_cast<sdfData*>(this->getReference());
-        if (ref)
-            return ref->getType();
-        else
-            cerr << "sdfData::getType: reference is of wrong type" << endl;
+        ref = dynamic_cast<sdfData*>(this->getReference());
+        if (!ref)
+            cerr << "sdfData::getResolved: reference of " + this->getName()
+                    + " is of wrong type" << endl;
     }
 
-    if (this->simpleType != json_type_undef)
-        return jsonDTypeToString(simpleType);
-
-    return this->derType;
-}
-
-jsonDataType sdfData::getSimpType()
-{
-    if (this->getReference())
+    if (ref)
+    {
+        const sdfResolvedQualities &refRes = ref->getResolved();
+        res.type = refRes.type;
+        res.simpleType = refRes.simpleType;
+    }
+    else
     {
-//        if (simpleType != json_type_undef)
-//            cerr << "sdfData::getSimpType: " + this->getName() +
-//            " has an sdfRef and a type given (sdfRef to "
-//            + this->getReference()->getName() + " and own type "
-//            + jsonDTypeToString(simpleType) + ")" << endl;
+        res.type = simpleType != json_type_undef ?
+                jsonDTypeToString(simpleType) : derType;
 
-        sdfData *ref = dynamic_cast<sdfData*>(this->getReference());
-        if (ref)
-            return ref->getSimpType();
-        else
+        // if all choices have the same type that type is used
+        res.simpleType = simpleType;
+        jsonDataType choiceType = json_type_undef;
+        bool sameTypes = true;
+        for (int i = 0; i < sdfChoice.size() && sameTypes; i++)
         {
-            cerr << "sdfData::getSimpType: reference is of wrong type" << endl;
-            cout << this->getReference()->getName();
+            if (i == 0)
+                choiceType = sdfChoice[0]->getSimpType();
+            else if (sdfChoice[i]->getSimpType() != choiceType)
+                sameTypes = false;
         }
+        if (!sdfChoice.empty() && sameTypes)
+            res.simpleType = choiceType;
     }
 
-    // if all choices have the same type return that type
-    jsonDataType choiceType;
-    bool sameTypes = true;
-    for (int i = 0; i < sdfChoice.size() && sameTypes; i++)
-    {
-        if (i == 0)
-            choiceType = sdfChoice[0]->getSimpType();
+    res.minItems = getConstraints().minItems;
+    if (isnan(res.minItems) && ref)
+        res.minItems = ref->getMinItemsOfRef();
+    res.maxItems = getConstraints().maxItems;
+    if (isnan(res.maxItems) && ref)
+        res.maxItems = ref->getMaxItemsOfRef();
+
+    res.itemConstr = item_constr;
+    if (ref && !item_constr)
+        res.itemConstr = ref->getItemConstrOfRefs();
 
-        else if (sdfChoice[i]->getSimpType() != choiceType)
-            sameTypes = false;
+    res.objectProperties = objectProperties;
+    if (ref)
+    {
+        const vector<sdfData*> &refObjProps = ref->getObjectProperties();
+        res.objectProperties.insert(res.objectProperties.end(),
+                refObjProps.begin(), refObjProps.end());
     }
-    if (!sdfChoice.empty() && sameTypes)
-        return choiceType;
 
-    return simpleType;
+    res.generation = qualityGeneration;
+    return res;
+}
+
+const string& sdfData::getType() const
+{
+    return getResolved().type;
+}
+
+jsonDataType sdfData::getSimpType() const
+{
+    return getResolved().simpleType;
 }
 
 bool sdfData::getUniqueItems()
 {
-    return uniqueItems;
+    return flag(flag_unique_items);
 }
 
 string sdfData::getUnits(bool forCopy)
 {
-    if (units != "" || forCopy)
-        return units;
+    if (getConstraints().units != "" || forCopy)
+        return getConstraints().units;
 
     else if (subtype == sdf_unix_time)
         return "unix-time";
-    else if (format == json_date_time)
+    else if (getConstraints().format == json_date_time)
         return "date-time";
-    else if (format == json_date)
+    else if (getConstraints().format == json_date)
         return "date";
-    else if (format == json_time)
+    else if (getConstraints().format == json_time)
         return "time";
-    else if (format == json_uri)
+    else if (getConstraints().format == json_uri)
         return "uri";
-    else if (format == json_uri_reference)
+    else if (getConstraints().format == json_uri_reference)
         return "uri-reference";
-    else if (format == json_uuid)
+    else if (getConstraints().format == json_uuid)
         return "uuid";
 
     return "";
@@ -1204,10 +1613,10 @@ string sdfData::generateReferenceString(sdfCommon *child, bool import)
         + " does not belong to " + this->getName()
         + " but references it as parent" << endl;
 
-    if (parent)
-        return parent->generateReferenceString(this, import) + childRef;
-    else if (parentFile)
-        return parentFile->generateReferenceString(this, import) + childRef;
+    // the (cached) reference string of this object is the parent's
+    // reference string for it
+    if (parent || parentFile)
+        return this->sdfCommon::generateReferenceString(import) + childRef;
     else
         cerr << "sdfData::generateReferenceString(): sdfData object "
                 + this->getName() + " has no assigned parent" << endl;
@@ -1252,12 +1661,12 @@ string sdfData::generateReferenceString(sdfCommon *child, bool import)
     return "";
 }
 
-json sdfData::dataToJson(json prefix)
+json sdfData::dataToJson(json prefix, bool children)
 {
     json data;
     data = this->commonToJson(data);
 
-    if (units != "")
+    if (getConstraints().units != "")
         data["unit"] = this->getUnits(true);
     if (this->getSubtype() == sdf_byte_string)
         data["sdfType"] = "byte-string";
@@ -1265,13 +1674,13 @@ json sdfData::dataToJson(json prefix)
             data["sdfType"] = "unix-time";
     if (this->getContentFormat() != "")
         data["contentFormat"] = this->getContentFormat();
-    if (this->readableDefined)
+    if (this->flag(flag_readable_defined))
         data["readable"] = this->getReadable();
-    if (this->writableDefined)
+    if (this->flag(flag_writable_defined))
         data["writable"] = this->getWritable();
-    if (this->observableDefined)
+    if (this->flag(flag_observable_defined))
         data["observable"] = this->getObservable();
-    if (this->nullableDefined)
+    if (this->flag(flag_nullable_defined))
         data["nullable"] = this->getNullable();
     if (!this->sdfChoice.empty())
     {
@@ -1279,6 +1688,8 @@ json sdfData::dataToJson(json prefix)
         {
             if (i->getSimpType() == json_type_undef)
                 i->setType(simpleType);
+            if (!children)
+                continue;
 
             json tmpJson;
             data["sdfChoice"][i->getName()]
@@ -1288,24 +1699,24 @@ json sdfData::dataToJson(json prefix)
     }
 
     // TODO: test?
-    if (!isnan(exclusiveMinimum_number))
+    if (!isnan(getConstraints().exclusiveMinimum_number))
         data["exclusiveMinimum"] = this->getExclusiveMinimumNumber();
-    if (!isnan(exclusiveMaximum_number))
+    if (!isnan(getConstraints().exclusiveMaximum_number))
         data["exclusiveMaximum"] = this->getExclusiveMaximumNumber();
-    if (exclusiveMinimum_bool)
+    if (flag(flag_exclusive_minimum))
         data["exclusiveMinimum"] = "true";
-    if (exclusiveMaximum_bool)
+    if (flag(flag_exclusive_maximum))
         data["exclusiveMaximum"] = "true";
 
-    if (constDefined)
+    if (flag(flag_const_defined))
     {
         if (!isnan(this->getConstantNumber()))
             data["const"] = this->getConstantNumber();
         else if (this->getConstantString() != "")
             data["const"] = this->getConstantString();
-        else if (constBoolDefined)
+        else if (flag(flag_const_bool_defined))
             data["const"] = this->getConstantBool();
-        else if (constIntDefined)
+        else if (flag(flag_const_int_defined))
             data["const"] = this->getConstantInt();
         else if (!this->getConstantNumberArray().empty())
             data["const"] = this->getConstantNumberArray();
@@ -1316,15 +1727,15 @@ json sdfData::dataToJson(json prefix)
         else if (!this->getConstantIntArray().empty())
             data["const"] = this->getConstantIntArray();
     }
-    if (defaultDefined)
+    if (flag(flag_default_defined))
     {
         if (!isnan(this->getDefaultNumber()))
             data["default"] = this->getDefaultNumber();
         else if (this->getDefaultString() != "")
             data["default"] = this->getDefaultString();
-        else if (defaultBoolDefined)
+        else if (flag(flag_default_bool_defined))
             data["default"] = this->getDefaultBool();
-        else if (defaultIntDefined)
+        else if (flag(flag_default_int_defined))
             data["default"] = this->getDefaultInt();
         else if (!this->getDefaultNumberArray().empty())
             data["default"] = this->getDefaultNumberArray();
@@ -1339,9 +1750,9 @@ json sdfData::dataToJson(json prefix)
         data["minimum"] = this->getMinimum();
     if (!isnan(this->getMaximum()))
         data["maximum"] = this->getMaximum();
-    if (minIntSet)
+    if (flag(flag_min_int_set))
         data["minimum"] = this->getMinInt();
-    if (maxIntSet)
+    if (flag(flag_max_int_set))
         data["maximum"] = this->getMaxInt();
     if (!isnan(this->getMultipleOf()))
         data["multipleOf"] = this->getMultipleOf();
@@ -1362,9 +1773,9 @@ json sdfData::dataToJson(json prefix)
     if (!isnan(this->getMaxItems()))
         data["maxItems"] = this->getMaxItems();
     //if (this->getUniqueItems())
-    if (this->uniqueItemsDefined)
+    if (this->flag(flag_unique_items_defined))
         data["uniqueItems"] = this->getUniqueItems();
-    if (this->item_constr != NULL)
+    if (this->item_constr != NULL && children)
     {
         json tmpJson;
         data["items"] = item_constr->dataToJson(tmpJson)
@@ -1372,6 +1783,8 @@ json sdfData::dataToJson(json prefix)
     }
     for (sdfData *i : this->getObjectProperties())
     {
+        if (!children)
+            break;
         json tmpJson;
         data["properties"][i->getName()]
                  = i->dataToJson(tmpJson)["sdfData"][i->getName()];
@@ -1380,8 +1793,8 @@ json sdfData::dataToJson(json prefix)
     if (simpleType == json_object && objectProperties.empty())
         data["properties"] = tmpJson;
 
-    if (!requiredObjectProperties.empty())
-        data["required"] = requiredObjectProperties;
+    if (!getConstraints().requiredObjectProperties.empty())
+        data["required"] = getConstraints().requiredObjectProperties;
 
     if (simpleType != json_type_undef && !this->getReference())
         data["type"] = jsonDTypeToString(simpleType);//derType;
@@ -1395,9 +1808,9 @@ json sdfData::dataToJson(json prefix)
         if (!isnan(this->getMaximum()))
             data["maximum"] = (int)this->getMaximum();
 
-        if (minIntSet)
+        if (flag(flag_min_int_set))
             data["minimum"] = this->getMinInt();
-        if (maxIntSet)
+        if (flag(flag_max_int_set))
             data["maximum"] = this->getMaxInt();
     }
 
@@ -1411,25 +1824,23 @@ sdfEvent::sdfEvent(std::string _name, std::string _description,
         sdfObject *_parentObject, sdfData* _outputData,
         vector<sdfData*> _datatypes)
             : sdfObjectElement(_name, _description, _reference, _required),
-              sdfCommon(_name, _description, _reference, _required),
-              outputData(_outputData), datatypes(_datatypes)
+              // the virtual base is initialised first, so the arguments can
+              // be moved from even though sdfObjectElement lists them too
+              sdfCommon(move(_name), move(_description), _reference,
+                    move(_required)),
+              outputData(_outputData), datatypes(move(_datatypes))
 {
     this->setParentObject(_parentObject);
 }
 
 sdfEvent::~sdfEvent()
 {
-    delete outputData;
-    outputData = NULL;
-
-    for (int i = 0; i < datatypes.size(); i++)
+    // the children of a node in an arena belong to the arena as well
+    if (!this->getArena())
     {
-        delete datatypes[i];
-        datatypes[i] = NULL;
+        deleteChild(outputData);
+        deleteChildren(datatypes);
     }
-    datatypes.clear();
-
-    //delete[] datatypes.data();
 }
 
 void sdfEvent::setOutputData(sdfData *outputData)
@@ -1447,7 +1858,7 @@ void sdfEvent::addDatatype(sdfData *datatype)
     datatype->setParentCommon((sdfCommon*)this);
 }
 
-vector<sdfData*> sdfEvent::getDatatypes()
+const vector<sdfData*>& sdfEvent::getDatatypes()
 {
     return this->datatypes;
 }
@@ -1484,7 +1895,7 @@ string sdfEvent::generateReferenceString(sdfCommon *child, bool import)
     }
     else if (outputData)
     {
-        vector<sdfData*> outOPs = outputData->getObjectProperties();
+        const vector<sdfData*> &outOPs = outputData->getObjectProperties();
         if (outputData->getItemConstr() == child
                 || find(outOPs.begin(), outOPs.end(), child) != outOPs.end())
             childRef = "/sdfOutputData/" + child->getName();
@@ -1500,16 +1911,8 @@ string sdfEvent::generateReferenceString(sdfCommon *child, bool import)
         + " but references it as parent" << endl;
     }
 
-    if (this->getParent())
-    {
-        return this->getParent()->generateReferenceString(this, import)
-                + childRef;
-    }
-    else if (this->getParentFile())
-    {
-        return this->getParentFile()->generateReferenceString(this, import)
-                + childRef;
-    }
+    if (this->getParent() || this->getParentFile())
+        return this->sdfCommon::generateReferenceString(import) + childRef;
     else
     {
         cerr << "Event " + this->getName() + " has no assigned parent" << endl;
@@ -1580,37 +1983,25 @@ sdfAction::sdfAction(
         vector<sdfData*> _requiredInputData,
         sdfData* _outputData,
         vector<sdfData*> _datatypes)
-            : sdfCommon(_name, _description, _reference, _required),
-              inputData(_inputData), requiredInputData(_requiredInputData),
-              outputData(_outputData), datatypes(_datatypes)
+            : sdfCommon(move(_name), move(_description), _reference,
+                    move(_required)),
+              inputData(_inputData),
+              requiredInputData(move(_requiredInputData)),
+              outputData(_outputData), datatypes(move(_datatypes))
 {
     this->setParentObject(_parentObject);
 }
 
 sdfAction::~sdfAction()
 {
-    delete inputData;
-    inputData = NULL;
-
-    for (int i = 0; i < requiredInputData.size(); i++)
-    {
-        delete requiredInputData[i];
-        requiredInputData[i] = NULL;
-    }
-    requiredInputData.clear();
-
-    for (int i = 0; i < datatypes.size(); i++)
+    // the children of a node in an arena belong to the arena as well
+    if (!this->getArena())
     {
-        delete datatypes[i];
-        datatypes[i] = NULL;
+        deleteChild(inputData);
+        deleteChildren(requiredInputData);
+        deleteChildren(datatypes);
+        deleteChild(outputData);
     }
-    datatypes.clear();
-
-    delete outputData;
-    outputData = NULL;
-
-    //delete[] requiredInputData.data();
-    //delete[] datatypes.data();
 }
 
 sdfData* sdfAction::getInputData()
@@ -1618,7 +2009,7 @@ sdfData* sdfAction::getInputData()
     return this->inputData;
 }
 
-vector<sdfData*> sdfAction::getRequiredInputData()
+const vector<sdfData*>& sdfAction::getRequiredInputData()
 {
     return this->requiredInputData;
 }
@@ -1628,7 +2019,7 @@ sdfData* sdfAction::getOutputData()
     return this->outputData;
 }
 
-vector<sdfData*> sdfAction::getDatatypes()
+const vector<sdfData*>& sdfAction::getDatatypes()
 {
     return this->datatypes;
 }
@@ -1665,7 +2056,7 @@ string sdfAction::generateReferenceString(sdfCommon *child, bool import)
         childRef = "/sdfInputData";
     else if (inputData)
     {
-        vector<sdfData*> inOPs = inputData->getObjectProperties();
+        const vector<sdfData*> &inOPs = inputData->getObjectProperties();
         if (inputData->getItemConstr() == child
                 || find(inOPs.begin(), inOPs.end(), child) != inOPs.end())
             childRef = "/sdfInputData/" + child->getName();
@@ -1674,7 +2065,7 @@ string sdfAction::generateReferenceString(sdfCommon *child, bool import)
         childRef = "/sdfOutputData";
     else if (outputData)
     {
-        vector<sdfData*> outOPs = outputData->getObjectProperties();
+        const vector<sdfData*> &outOPs = outputData->getObjectProperties();
         if (outputData->getItemConstr() == child
                 || find(outOPs.begin(), outOPs.end(), child) != outOPs.end())
             childRef = "/sdfOutputData/" + child->getName();
@@ -1688,13 +2079,8 @@ string sdfAction::generateReferenceString(sdfCommon *child, bool import)
         + " does not belong to " + this->getName()
         + " but references it as parent" << endl;
 
-    if (this->getParent())
-        return this->getParent()->generateReferenceString(this, import)
-                + childRef;
-
-    else if (this->getParentFile())
-        return this->getParentFile()->generateReferenceString(this, import)
-                + childRef;
+    if (this->getParent() || this->getParentFile())
+        return this->sdfCommon::generateReferenceString(import) + childRef;
 
     else
     {
@@ -1748,7 +2134,9 @@ sdfProperty::sdfProperty(
         )
             : sdfData(_name, _description, _type, _reference, _required),
               sdfObjectElement(_name, _description, _reference, _required),
-              sdfCommon(_name, _description, _reference, _required)
+              // the virtual base is initialised first (see sdfEvent)
+              sdfCommon(move(_name), move(_description), _reference,
+                    move(_required))
 {
     this->setParentObject(_parentObject);
     this->setParentCommon(NULL);
@@ -1763,13 +2151,11 @@ sdfProperty::sdfProperty(sdfData &data)
 {
     this->setParentObject(NULL);
     this->setParentCommon(NULL);
-    vector<sdfData*> d = this->getObjectProperties();
-    for (int i = 0; i < d.size(); i++)
-        d.at(i)->setParentCommon((sdfCommon*)this);
+    for (sdfData *d : this->getObjectProperties())
+        d->setParentCommon((sdfCommon*)this);
 
-    d = this->getChoice();
-    for (int i = 0; i < d.size(); i++)
-        d.at(i)->setParentCommon((sdfCommon*)this);
+    for (sdfData *d : this->getChoice())
+        d->setParentCommon((sdfCommon*)this);
 
     sdfData *ic = this->getItemConstr();
     if (ic)
@@ -1778,6 +2164,15 @@ sdfProperty::sdfProperty(sdfData &data)
     }
 }
 
+sdfProperty::sdfProperty(sdfData &&data)
+    : sdfData(move(data)),
+      // the virtual base is initialised first (see sdfEvent)
+      sdfCommon(move(data))
+{
+    this->setParentObject(NULL);
+    this->setParentCommon(NULL);
+}
+
 string sdfProperty::generateReferenceString(sdfCommon *child, bool import)
 {
     /*return this->sdfObjectElement::generateReferenceString()
@@ -1806,9 +2201,10 @@ sdfObject::sdfObject(
         vector<sdfData*> _datatypes,
         sdfThing *_parentThing
         )
-            : sdfCommon(_name, _description, _reference, _required),
-              properties(_properties), actions(_actions), events(_events),
-              datatypes(_datatypes)
+            : sdfCommon(move(_name), move(_description), _reference,
+                    move(_required)),
+              properties(move(_properties)), actions(move(_actions)),
+              events(move(_events)), datatypes(move(_datatypes))
 {
     this->ns = NULL;
     this->info = NULL;
@@ -1817,38 +2213,14 @@ sdfObject::sdfObject(
 
 sdfObject::~sdfObject()
 {
-    for (int i = 0; i < properties.size(); i++)
-    {
-        delete properties[i];
-        properties[i] = NULL;
-    }
-    properties.clear();
-
-    for (int i = 0; i < actions.size(); i++)
-    {
-        delete actions[i];
-        actions[i] = NULL;
-    }
-    actions.clear();
-
-    for (int i = 0; i < events.size(); i++)
-    {
-        delete events[i];
-        events[i] = NULL;
-    }
-    events.clear();
-
-    for (int i = 0; i < datatypes.size(); i++)
+    // the children of a node in an arena belong to the arena as well
+    if (!this->getArena())
     {
-        delete datatypes[i];
-        datatypes[i] = NULL;
+        deleteChildren(properties);
+        deleteChildren(actions);
+        deleteChildren(events);
+        deleteChildren(datatypes);
     }
-    datatypes.clear();
-
-    /*delete[] properties.data();
-    delete[] actions.data();
-    delete[] events.data();
-    delete[] datatypes.data();*/
 
     delete ns;
     ns = NULL;
@@ -1906,22 +2278,22 @@ sdfNamespaceSection* sdfObject::getNamespace()
     return this->ns;
 }
 
-vector<sdfProperty*> sdfObject::getProperties()
+const vector<sdfProperty*>& sdfObject::getProperties()
 {
     return this->properties;
 }
 
-vector<sdfAction*> sdfObject::getActions()
+const vector<sdfAction*>& sdfObject::getActions()
 {
     return this->actions;
 }
 
-vector<sdfEvent*> sdfObject::getEvents()
+const vector<sdfEvent*>& sdfObject::getEvents()
 {
     return this->events;
 }
 
-vector<sdfData*> sdfObject::getDatatypes()
+const vector<sdfData*>& sdfObject::getDatatypes()
 {
     return this->datatypes;
 }
@@ -1933,6 +2305,8 @@ sdfThing* sdfObject::getParentThing() const
 
 void sdfObject::setParentThing(sdfThing *parentThing)
 {
+    if (this->parent != parentThing)
+        referenceGeneration++;
     this->parent = parentThing;
     // also add this to parentThings object list?
     // make sure the object is in the list only once
@@ -1981,21 +2355,23 @@ string sdfObject::objectToString(bool print_info_namespace)
 {
     json json_output;
     return this->objectToJson(
-            json_output, print_info_namespace).dump(INDENT_WIDTH);
+            json_output, print_info_namespace).dump(outputIndentWidth());
 }
 
 void sdfObject::objectToFile(string path)
 {
+    json json_output = this->objectToJson(json(), true);
     std::ofstream output(path);
     if (output)
     {
-        output << this->objectToString(true) << std::endl;
+        output << json_output.dump(outputIndentWidth()) << std::endl;
         output.close();
     }
     else
         cerr << "sdfObject::objectToFile: Error opening file" << endl;
 
-    validateFile(path);
+    cout << path << ": ";
+    validateJson(json_output);
 }
 
 string sdfObject::generateReferenceString(sdfCommon *child, bool import)
@@ -2017,14 +2393,10 @@ string sdfObject::generateReferenceString(sdfCommon *child, bool import)
     else if (find(events.begin(), events.end(), child) != events.end())
         childRef = "/sdfEvent/";
 
-    if (parent)
-        return parent->generateReferenceString(this, import) + childRef
+    if (parent || this->getParentFile())
+        return this->sdfCommon::generateReferenceString(import) + childRef
                 + child->getName();
 
-    else if (this->getParentFile())
-        return this->getParentFile()->generateReferenceString(this, import)
-                + childRef + child->getName();
-
     else if (import && this->getNamespace()
             && this->getNamespace()->getDefaultNamespace() != "")
         return this->getNamespace()->getDefaultNamespace() + ":/sdfObject/"
@@ -2055,8 +2427,9 @@ sdfThing::sdfThing(
         vector<sdfObject*> _objects,
         sdfThing *_parentThing
         )
-            : sdfCommon(_name, _description, _reference, _required),
-              childThings(_things)//, childObjects(_objects)
+            : sdfCommon(move(_name), move(_description), _reference,
+                    move(_required)),
+              childThings(move(_things))//, childObjects(_objects)
 {
     this->ns = NULL;
     this->info = NULL;
@@ -2065,22 +2438,12 @@ sdfThing::sdfThing(
 
 sdfThing::~sdfThing()
 {
-    for (int i = 0; i < childThings.size(); i++)
-    {
-        delete childThings[i];
-        childThings[i] = NULL;
-    }
-    childThings.clear();
-
-    for (int i = 0; i < childObjects.size(); i++)
+    // the children of a node in an arena belong to the arena as well
+    if (!this->getArena())
     {
-        delete childObjects[i];
-        childObjects[i] = NULL;
+        deleteChildren(childThings);
+        deleteChildren(childObjects);
     }
-    childObjects.clear();
-
-    //delete[] childThings.data();
-    //delete[] childObjects.data();
 
     delete ns;
     ns = NULL;
@@ -2124,12 +2487,12 @@ void sdfThing::addObject(sdfObject *object)
     object->setParentThing(this);
 }
 
-vector<sdfThing*> sdfThing::getThings() const
+const vector<sdfThing*>& sdfThing::getThings() const
 {
     return this->childThings;
 }
 
-vector<sdfObject*> sdfThing::getObjects() const
+const vector<sdfObject*>& sdfThing::getObjects() const
 {
     return this->childObjects;
 }
@@ -2165,21 +2528,23 @@ string sdfThing::thingToString(bool print_info_namespace)
 {
     json json_output;
     return this->thingToJson(
-            json_output, print_info_namespace).dump(INDENT_WIDTH);
+            json_output, print_info_namespace).dump(outputIndentWidth());
 }
 
 void sdfThing::thingToFile(string path)
 {
+    json json_output = this->thingToJson(json(), true);
     ofstream output(path);
     if (output)
     {
-        output << this->thingToString() << endl;
+        output << json_output.dump(outputIndentWidth()) << endl;
         output.close();
     }
     else
         cerr << "sdfThing::thingToFile: Error opening file" << endl;
 
-    validateFile(path);
+    cout << path << ": ";
+    validateJson(json_output);
 }
 
 sdfThing* sdfThing::getParentThing() const
@@ -2189,6 +2554,8 @@ sdfThing* sdfThing::getParentThing() const
 
 void sdfThing::setParentThing(sdfThing *parentThing)
 {
+    if (this->parent != parentThing)
+        referenceGeneration++;
     this->parent = parentThing;
 }
 
@@ -2211,14 +2578,10 @@ string sdfThing::generateReferenceString(sdfCommon *child, bool import)
         + " does not belong to " + this->getName()
         + " but references it as parent" << endl;
 
-    if (parent)
-        return parent->generateReferenceString(this, import) + childRef
-                + child->getName();
-
-    else if (this->getParentFile())
+    if (parent || this->getParentFile())
     {
-        return this->getParentFile()->generateReferenceString(this, import)
-                + childRef + child->getName();
+        return this->sdfCommon::generateReferenceString(import) + childRef
+                + child->getName();
     }
     else if (import && this->getNamespace()
             && this->getNamespace()->getDefaultNamespace() != "")
@@ -2240,69 +2603,80 @@ string sdfThing::generateReferenceString(sdfCommon *child, bool import)
         return "#/sdfThing/" + this->getName();*/
 }
 
-void sdfCommon::jsonToCommon(json input)
+void sdfCommon::jsonToCommon(const json &input)
 {
-    for (auto it : input.items())
+    for (json::const_iterator it = input.begin(); it != input.end(); ++it)
     {
         //cout << "jsonToCommon: " << it.key() << endl;
-        if (it.key() == "label")
+        switch (stringToSdfKeyword(it.key()))
+        {
+        case key_label:
             this->setLabel(correctValue(it.value()));
-        else if (it.key() == "description")
+            break;
+        case key_description:
             this->setDescription(it.value());
-        else if (it.key() == "sdfRef")
-        {
+            break;
+        case key_sdfRef:
             unassignedRefs.push_back(tuple<string, sdfCommon*>{
                 correctValue(it.value()), this});
             //cout << correctValue(it.value())+" "+this->getName() << endl;
-        }
-        else if (it.key() == "sdfRequired")
-            for (auto jt : it.value())
+            break;
+        case key_sdfRequired:
+            for (const json &jt : it.value())
                 unassignedReqs.push_back(tuple<string, sdfCommon*>{
                     correctValue(jt), this});
+            break;
+        default:
+            break;
+        }
     }
     // check if this is the item constraint of an sdfData element
     sdfData *data = this->getThisAsSdfData();
     if (!data || !data->isItemConstr())
     {
         // if not, add to existing definitions
-        existingDefinitons[this->generateReferenceString()] = this;
+        existingDefinitons[internSymbol(this->generateReferenceString())] =
+                this;
 //        cout << "!!!jsonToCommon: " << this->generateReferenceString() <<" "
 //            << this->getName()<< endl;
     }
 }
 
-sdfData* sdfData::jsonToData(json input)
+sdfData* sdfData::jsonToData(const json &input)
 {
     this->jsonToCommon(input);
-    for (json::iterator it = input.begin(); it != input.end(); ++it)
+    for (json::const_iterator it = input.begin(); it != input.end(); ++it)
     {
-        if (it.key() == "type" && !it.value().empty())
+        if (it.value().empty())
+            continue;
+
+        switch (stringToSdfKeyword(it.key()))
         {
-            this->setType((string)input["type"]);
+        case key_type:
+            this->setType((string)it.value());
             // if type is number, maybe the const and default values have to
             // be reassigned
             if (simpleType == json_number)
             {
-                if (defaultIntDefined)
+                if (flag(flag_default_int_defined))
                 {
-                    defaultNumber = defaultInt;
-                    defaultIntDefined = false;
+                    defaultValue = (float)getDefaultInt();
+                    setFlag(flag_default_int_defined, false);
                 }
-                if (constIntDefined)
+                if (flag(flag_const_int_defined))
                 {
-                    constantNumber = constantInt;
-                    constIntDefined = false;
+                    constantValue = (float)getConstantInt();
+                    setFlag(flag_const_int_defined, false);
                 }
             }
-        }
-        else if (it.key() == "enum" && !it.value().empty())
-        {
+            break;
+        case key_enum:
             if (it.value().is_array())
             {
-                for (auto i : it.value())
+                for (const json &i : it.value())
                 {
                     if (i.is_string())
-                        this->enumString.push_back(i);
+                        this->editConstraints().enumString.push_back(i);
                     /*if (i.is_number_integer())
                         this->enumInt.push_back(i);
                     if (i.is_number())
@@ -2313,11 +2687,10 @@ sdfData* sdfData::jsonToData(json input)
                         ; // fix this?*/
                 }
             }
-        }
-        else if (it.key() == "sdfChoice" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin(); jt != it.value().end();
-                    ++jt)
+            break;
+        case key_sdfChoice:
+            for (json::const_iterator jt = it.value().begin();
+                    jt != it.value().end(); ++jt)
             {
                 sdfData *choice = new sdfData();
                 choice->setName(correctValue(jt.key()));
@@ -2325,22 +2698,20 @@ sdfData* sdfData::jsonToData(json input)
                 choice->jsonToData(jt.value());
                 //this->addChoice(choice->jsonToData(jt.value()));
             }
-        }
-        else if (it.key() == "required" && !it.value().empty())
-        {
+            break;
+        case key_required:
             if (it.value().is_array() && it.value()[0].is_string())
             {
-                for (auto i : it.value())
+                for (const json &i : it.value())
                     this->addRequiredObjectProperty((string)i);
             }
             else
                 cerr << "jsonToData(): field \'required\' could not be parsed"
                 << endl;
-        }
-        else if (it.key() == "properties" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin(); jt != it.value().end();
-                                ++jt)
+            break;
+        case key_properties:
+            for (json::const_iterator jt = it.value().begin();
+                    jt != it.value().end(); ++jt)
             {
                 //cout << jt.key() << endl;
                 sdfData *objectProperty = new sdfData();
@@ -2350,89 +2721,86 @@ sdfData* sdfData::jsonToData(json input)
                 //objectProperty->setParentCommon(this);
                 //this->addObjectProperty(objectProperty->jsonToData(jt.value()));
             }
-        }
-        if (it.key() == "const" && !it.value().empty())
-        {
-            this->constDefined = true;
+            break;
+        case key_const:
+            this->setFlag(flag_const_defined, true);
             if (it.value().is_number_integer())
             {
-                this->constantInt = it.value();
-                this->constIntDefined = true;
+                this->constantValue = it.value().get<int64_t>();
+                this->setFlag(flag_const_int_defined, true);
             }
             else if (it.value().is_number())
-                this->constantNumber = it.value();
+                this->constantValue = it.value().get<float>();
             else if (it.value().is_string())
-                this->constantString = it.value();
+                this->constantValue = it.value().get<string>();
             else if (it.value().is_boolean())
             {
-                this->constantBool = it.value();
-                this->constBoolDefined = true;
+                this->constantValue = it.value().get<bool>();
+                this->setFlag(flag_const_bool_defined, true);
             }
             else if (it.value().is_array())
             {
-                for (json::iterator jt = it.value().begin();
+                for (json::const_iterator jt = it.value().begin();
                         jt != it.value().end(); ++jt)
                 {
                     if (jt.value().is_number_integer()
                             && (simpleType == json_integer
                                     || simpleType == json_type_undef))
-                        this->constantIntArray.push_back(jt.value());
+                        this->editConstraints().constantIntArray.push_back(jt.value());
 
                     else if (jt.value().is_number())
-                        this->constantNumberArray.push_back(jt.value());
+                        this->editConstraints().constantNumberArray.push_back(jt.value());
 
                     else if (jt.value().is_string())
-                        this->constantStringArray.push_back(jt.value());
+                        this->editConstraints().constantStringArray.push_back(jt.value());
 
                     else if (jt.value().is_boolean())
-                        this->constantBoolArray.push_back(jt.value());
+                        this->editConstraints().constantBoolArray.push_back(jt.value());
                 }
             }
-        }
-        else if (it.key() == "default" && !it.value().empty())
-        {
-            this->defaultDefined = true;
+            break;
+        case key_default:
+            this->setFlag(flag_default_defined, true);
             if (it.value().is_number_integer()
                     && (simpleType == json_integer
                             || simpleType == json_type_undef))
             {
-                this->defaultInt = it.value();
-                this->defaultIntDefined = true;
+                this->defaultValue = it.value().get<int64_t>();
+                this->setFlag(flag_default_int_defined, true);
             }
             else if (it.value().is_number())
-                this->defaultNumber = it.value();
+                this->defaultValue = it.value().get<float>();
             else if (it.value().is_string())
-                this->defaultString = it.value();
+                this->defaultValue = it.value().get<string>();
             else if (it.value().is_boolean())
             {
-                this->defaultBool = it.value();
-                this->defaultBoolDefined = true;
+                this->defaultValue = it.value().get<bool>();
+                this->setFlag(flag_default_bool_defined, true);
             }
             else if (it.value().is_array())
             {
-                for (json::iterator jt = it.value().begin();
+                for (json::const_iterator jt = it.value().begin();
                         jt != it.value().end(); ++jt)
                 {
                     if (jt.value().is_number_integer()
                             && (simpleType == json_integer
                                     || simpleType == json_type_undef))
                     {
-                        this->defaultIntArray.push_back(jt.value());
+                        this->editConstraints().defaultIntArray.push_back(jt.value());
                     }
 
                     else if (jt.value().is_number())
-                        this->defaultNumberArray.push_back(jt.value());
+                        this->editConstraints().defaultNumberArray.push_back(jt.value());
 
                     else if (jt.value().is_string())
-                        this->defaultStringArray.push_back(jt.value());
+                        this->editConstraints().defaultStringArray.push_back(jt.value());
 
                     else if (jt.value().is_boolean())
-                        this->defaultBoolArray.push_back(jt.value());
+                        this->editConstraints().defaultBoolArray.push_back(jt.value());
                 }
             }
-        }
-        else if (it.key() == "minimum" && !it.value().empty())
-        {
+            break;
+        case key_minimum:
             if (it.value().is_number_integer()
                     && (simpleType == json_integer
                             || simpleType == json_type_undef))
@@ -2440,10 +2808,9 @@ sdfData* sdfData::jsonToData(json input)
                 this->setMinInt(it.value());
             }
             else
-                this->minimum = it.value();
-        }
-        else if (it.key() == "maximum" && !it.value().empty())
-        {
+                this->editConstraints().minimum = it.value();
+            break;
+        case key_maximum:
             if (it.value().is_number_integer()
                     && (simpleType == json_integer
                             || simpleType == json_type_undef))
@@ -2451,205 +2818,207 @@ sdfData* sdfData::jsonToData(json input)
                 this->setMaxInt(it.value());
             }
             else
-                this->maximum = it.value();
-        }
-        else if (it.key() == "exclusiveMinimum" && !it.value().empty())
-        {
+                this->editConstraints().maximum = it.value();
+            break;
+        case key_exclusiveMinimum:
             if (it.value().is_boolean())
-                this->exclusiveMinimum_bool = it.value();
+                this->setFlag(flag_exclusive_minimum, it.value());
             else if (it.value().is_number_integer()
                     && (simpleType == json_integer
                             || simpleType == json_type_undef))
             {
             }
             if (it.value().is_number())
-                this->exclusiveMinimum_number = it.value();
-        }
-        else if (it.key() == "exclusiveMaximum" && !it.value().empty())
-        {
+                this->editConstraints().exclusiveMinimum_number = it.value();
+            break;
+        case key_exclusiveMaximum:
             if (it.value().is_boolean())
-                this->exclusiveMaximum_bool = it.value();
+                this->setFlag(flag_exclusive_maximum, it.value());
             else if (it.value().is_number_integer()
                     && (simpleType == json_integer
                             || simpleType == json_type_undef))
             {
-                this->maxIntSet = true;
+                this->setFlag(flag_max_int_set, true);
             }
             if (it.value().is_number())
-                this->exclusiveMaximum_number = it.value();
-        }
-        else if (it.key() == "multipleOf" && !it.value().empty())
-        {
-            this->multipleOf = it.value();
-        }
-        else if (it.key() == "minLength" && !it.value().empty())
-        {
-            this->minLength = it.value();
-        }
-        else if (it.key() == "maxLength" && !it.value().empty())
-        {
-            this->maxLength = it.value();
-        }
-        else if (it.key() == "pattern" && !it.value().empty())
-        {
-            this->pattern = it.value();
-        }
-        else if (it.key() == "format" && !it.value().empty())
-        {
+                this->editConstraints().exclusiveMaximum_number = it.value();
+            break;
+        case key_multipleOf:
+            this->editConstraints().multipleOf = it.value();
+            break;
+        case key_minLength:
+            this->editConstraints().minLength = it.value();
+            break;
+        case key_maxLength:
+            this->editConstraints().maxLength = it.value();
+            break;
+        case key_pattern:
+            this->editConstraints().pattern = it.value();
+            break;
+        case key_format:
             if (it.value() == "date-time")
-                this->contentFormat = json_date_time;
+                this->editConstraints().contentFormat = json_date_time;
             else if (it.value() == "date")
-                this->contentFormat = json_date;
+                this->editConstraints().contentFormat = json_date;
             else if (it.value() == "time")
-                this->contentFormat = json_time;
+                this->editConstraints().contentFormat = json_time;
             else if (it.value() == "uri")
-                this->contentFormat = json_uri;
+                this->editConstraints().contentFormat = json_uri;
             else if (it.value() == "uri-reference")
-                this->contentFormat = json_uri_reference;
+                this->editConstraints().contentFormat = json_uri_reference;
             else if (it.value() == "uuid")
-                this->contentFormat = json_uuid;
+                this->editConstraints().contentFormat = json_uuid;
             else
-                this->contentFormat = json_format_undef;
-        }
-        else if (it.key() == "minItems" && !it.value().empty())
-        {
-            this->minItems = it.value();
-        }
-        else if (it.key() == "maxItems" && !it.value().empty())
-        {
-            this->maxItems = it.value();
-        }
-        else if (it.key() == "uniqueItems" && !it.value().empty())
-        {
-            this->uniqueItems = it.value();
-            this->uniqueItemsDefined = true;
-        }
-        else if (it.key() == "items" && !it.value().empty())
+                this->editConstraints().contentFormat = json_format_undef;
+            break;
+        case key_minItems:
+            this->editConstraints().minItems = it.value();
+            break;
+        case key_maxItems:
+            this->editConstraints().maxItems = it.value();
+            break;
+        case key_uniqueItems:
+            this->setFlag(flag_unique_items, it.value());
+            this->setFlag(flag_unique_items_defined, true);
+            break;
+        case key_items:
         {
             //this->item_constr = new sdfData();
             //this->item_constr->jsonToData(input["items"]);
             sdfData *itemConstr = new sdfData();
             this->setItemConstr(itemConstr);
-            itemConstr->jsonToData(input["items"]);
+            itemConstr->jsonToData(it.value());
+            break;
         }
-        // keep key "units" for older versions?
-        else if ((it.key() == "unit" || it.key() == "units")
-                && !it.value().empty())
-        {
-            this->units = it.value();
-        }
-        else if (it.key() == "scaleMinimum" && !it.value().empty())
-        {
-            this->scaleMinimum = it.value();
-        }
-        else if (it.key() == "scaleMaximum" && !it.value().empty())
-        {
-            this->scaleMaximum = it.value();
-        }
-        else if (it.key() == "readable" && !it.value().empty())
-        {
-            this->readable = it.value();
-            this->readableDefined = true;
-        }
-        else if (it.key() == "writable" && !it.value().empty())
-        {
-            this->writable = it.value();
-            this->writableDefined = true;
-        }
-        else if (it.key() == "observable" && !it.value().empty())
-        {
-            this->observable = it.value();
-            this->observableDefined = true;
-        }
-        else if (it.key() == "nullable" && !it.value().empty())
-        {
-            this->nullable = it.value();
-            this->nullableDefined = true;
-        }
-        else if (it.key() == "contentFormat" && !it.value().empty())
-        {
-            this->contentFormat = it.value();
-        }
-        else if ((it.key() == "sdfType" || it.key() == "subtype")
-                && !it.value().empty())
-        {
+        // key "units" of older versions is mapped to key_unit as well
+        case key_unit:
+            this->editConstraints().units = it.value();
+            break;
+        case key_scaleMinimum:
+            this->editConstraints().scaleMinimum = it.value();
+            break;
+        case key_scaleMaximum:
+            this->editConstraints().scaleMaximum = it.value();
+            break;
+        case key_readable:
+            this->setFlag(flag_readable, it.value());
+            this->setFlag(flag_readable_defined, true);
+            break;
+        case key_writable:
+            this->setFlag(flag_writable, it.value());
+            this->setFlag(flag_writable_defined, true);
+            break;
+        case key_observable:
+            this->setFlag(flag_observable, it.value());
+            this->setFlag(flag_observable_defined, true);
+            break;
+        case key_nullable:
+            this->setFlag(flag_nullable, it.value());
+            this->setFlag(flag_nullable_defined, true);
+            break;
+        case key_contentFormat:
+            this->editConstraints().contentFormat = it.value();
+            break;
+        // key "subtype" of older versions is mapped to key_sdfType as well
+        case key_sdfType:
             if (it.value() == "byte-string")
                 this->subtype = sdf_byte_string;
             else if (it.value() == "unix-time")
                 this->subtype = sdf_unix_time;
             else
                 this->subtype = sdf_subtype_undef;
+            break;
+        default:
+            break;
         }
     }
     return this;
 }
 
-sdfEvent* sdfEvent::jsonToEvent(json input)
+sdfEvent* sdfEvent::jsonToEvent(const json &input)
 {
     this->jsonToCommon(input);
-    for (auto it : input.items())
+    for (json::const_iterator it = input.begin(); it != input.end(); ++it)
     {
-        if (it.key() == "sdfOutputData" && !it.value().empty())
+        if (it.value().empty())
+            continue;
+
+        switch (stringToSdfKeyword(it.key()))
+        {
+        case key_sdfOutputData:
         {
             sdfData *data = new sdfData();
             this->setOutputData(data);
-            data->jsonToData(input["sdfOutputData"]);
-
+            data->jsonToData(it.value());
+            break;
         }
-        else if (it.key() == "sdfData" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin(); jt != it.value().end(); ++jt)
+        case key_sdfData:
+            for (json::const_iterator jt = it.value().begin();
+                    jt != it.value().end(); ++jt)
             {
                 sdfData *childData = new sdfData();
                 childData->setName(correctValue(jt.key()));
                 this->addDatatype(childData);
-                childData->jsonToData(input["sdfData"][jt.key()]);
+                childData->jsonToData(jt.value());
             }
+            break;
+        default:
+            break;
         }
     }
     return this;
 }
 
-sdfAction* sdfAction::jsonToAction(json input)
+sdfAction* sdfAction::jsonToAction(const json &input)
 {
     this->jsonToCommon(input);
-    for (json::iterator it = input.begin(); it != input.end(); ++it)
+    for (json::const_iterator it = input.begin(); it != input.end(); ++it)
     {
-        if (it.key() == "sdfInputData" && !it.value().empty())
+        if (it.value().empty())
+            continue;
+
+        switch (stringToSdfKeyword(it.key()))
+        {
+        case key_sdfInputData:
         {
             sdfData *data = new sdfData();
             this->setInputData(data);
-            data->jsonToData(input["sdfInputData"]);
+            data->jsonToData(it.value());
+            break;
         }
-        else if (it.key() == "sdfRequiredInputData" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin(); jt != it.value().end(); ++jt)
+        case key_sdfRequiredInputData:
+            for (json::const_iterator jt = it.value().begin();
+                    jt != it.value().end(); ++jt)
             {
                 sdfData *refData = new sdfData();
                 this->addRequiredInputData(refData);
             }
-        }
-        else if (it.key() == "sdfOutputData" && !it.value().empty())
+            break;
+        case key_sdfOutputData:
         {
             sdfData *data = new sdfData();
             this->setOutputData(data);
-            data->jsonToData(input["sdfOutputData"]);
+            data->jsonToData(it.value());
+            break;
         }
-        else if (it.key() == "sdfData" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin(); jt != it.value().end(); ++jt)
+        case key_sdfData:
+            for (json::const_iterator jt = it.value().begin();
+                    jt != it.value().end(); ++jt)
             {
                 sdfData *childData = new sdfData();
                 childData->setName(correctValue(jt.key()));
                 this->addDatatype(childData);
-                childData->jsonToData(input["sdfData"][jt.key()]);
+                childData->jsonToData(jt.value());
             }
+            break;
+        default:
+            break;
         }
     }
     return this;
 }
 
-sdfProperty* sdfProperty::jsonToProperty(json input)
+sdfProperty* sdfProperty::jsonToProperty(const json &input)
 {
     this->jsonToData(input);
     return this;
@@ -2660,10 +3029,10 @@ void sdfNamespaceSection::makeDefinitionsGlobal()
     // insert all definitions of this element into the global definitions
     // and add the default prefix to path
     string newRef;
-    map<string, sdfCommon*>::iterator it = existingDefinitons.begin();
+    unordered_map<sdfSymbol, sdfCommon*>::iterator it;
     for (it = existingDefinitons.begin(); it != existingDefinitons.end(); it++)
     {
-        newRef = it->first;
+        newRef = symbolToString(it->first);
         regex hashSplit ("#(.*)");
         smatch sm;
         if (this->getDefaultNamespace() != "")
@@ -2672,76 +3041,87 @@ void sdfNamespaceSection::makeDefinitionsGlobal()
                 newRef = this->getDefaultNamespace() + ":" + string(sm[1]);
             if (it->second)
             {
-                existingDefinitonsGlobal[newRef] = it->second;
+                existingDefinitonsGlobal[internSymbol(newRef)] = it->second;
             }
         }
     }
     existingDefinitons = {};
 }
 
-sdfObject* sdfObject::jsonToObject(json input, bool testForThing)
+sdfObject* sdfObject::jsonToObject(const json &input,
+        bool testForThing)
 {
     this->jsonToCommon(input);
-    for (json::iterator it = input.begin(); it != input.end(); ++it)
+    for (json::const_iterator it = input.begin(); it != input.end(); ++it)
     {
-        if (it.key() == "info" && !it.value().empty())
+        sdfKeyword key = stringToSdfKeyword(it.key());
+        if (key == key_sdfThing)
+        {
+            if (!testForThing)
+                cerr << "jsonToObject(): incorrect sdfObject (sdfThing found)"
+                    << endl;
+            return NULL;
+        }
+        if (it.value().empty())
+            continue;
+
+        switch (key)
+        {
+        case key_info:
         {
             sdfInfoBlock *info = new sdfInfoBlock();
             this->setInfo(info);
-            this->info->jsonToInfo(input["info"]);
+            this->info->jsonToInfo(it.value());
+            break;
         }
-        else if (it.key() == "namespace" && !it.value().empty())
+        case key_namespace:
         {
             sdfNamespaceSection *ns = new sdfNamespaceSection();
             this->setNamespace(ns);
             this->ns->jsonToNamespace(input);
+            break;
         }
         // for first level
-        else if (it.key() == "sdfObject" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+        case key_sdfObject:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 this->setName(correctValue(jt.key()));
-                this->jsonToObject(input["sdfObject"][jt.key()]);
+                this->jsonToObject(jt.value());
             }
-        }
-        else if (it.key() == "sdfData" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfData:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfData *childData = new sdfData();
                 this->addDatatype(childData);
                 childData->setName(correctValue(jt.key()));
-                childData->jsonToData(input["sdfData"][jt.key()]);
+                childData->jsonToData(jt.value());
             }
-        }
-        else if (it.key() == "sdfProperty" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfProperty:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfProperty *childProperty = new sdfProperty();
                 this->addProperty(childProperty);
                 childProperty->setName(correctValue(jt.key()));
-                childProperty->jsonToProperty(input["sdfProperty"][jt.key()]);
+                childProperty->jsonToProperty(jt.value());
             }
-        }
-        else if (it.key() == "sdfAction" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfAction:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfAction *childAction = new sdfAction();
                 this->addAction(childAction);
                 childAction->setName(correctValue(jt.key()));
-                childAction->jsonToAction(input["sdfAction"][jt.key()]);
+                childAction->jsonToAction(jt.value());
             }
-        }
-        else if (it.key() == "sdfEvent" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfEvent:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfEvent *childEvent =  new sdfEvent();
@@ -2749,15 +3129,11 @@ sdfObject* sdfObject::jsonToObject(json input, bool testForThing)
                 // with label set this way, a label will be printed
                 // even though there was just a "title" in the original
                 childEvent->setName(correctValue(jt.key()));
-                childEvent->jsonToEvent(input["sdfEvent"][jt.key()]);
+                childEvent->jsonToEvent(jt.value());
             }
-        }
-        else if (it.key() == "sdfThing")
-        {
-            if (!testForThing)
-                cerr << "jsonToObject(): incorrect sdfObject (sdfThing found)"
-                    << endl;
-            return NULL;
+            break;
+        default:
+            break;
         }
     }
 
@@ -2786,13 +3162,7 @@ sdfObject* sdfObject::fileToObject(string path, bool testForThing)
         loadContext();
 
     json json_input;
-    ifstream input(path);
-    if (input)
-    {
-        input >>  json_input;
-        input.close();
-    }
-    else
+    if (!readSdfFile(path, json_input))
     {
         cerr << "sdfObject::fileToObject: Error opening file" << endl;
         return NULL;
@@ -2800,7 +3170,7 @@ sdfObject* sdfObject::fileToObject(string path, bool testForThing)
     return this->jsonToObject(json_input, testForThing);
 }
 
-sdfThing* sdfThing::jsonToThing(json input, bool nested)
+sdfThing* sdfThing::jsonToThing(const json &input, bool nested)
 {
     // if we are just loading the context, ignore things that do not
     // have a default namespace and hence do not contribute to the
@@ -2811,53 +3181,57 @@ sdfThing* sdfThing::jsonToThing(json input, bool nested)
 
     this->jsonToCommon(input);
 
-    for (json::iterator it = input.begin(); it != input.end(); ++it)
+    for (json::const_iterator it = input.begin(); it != input.end(); ++it)
     {
-        if (it.key() == "info" && !it.value().empty())
+        if (it.value().empty())
+            continue;
+
+        switch (stringToSdfKeyword(it.key()))
+        {
+        case key_info:
         {
             sdfInfoBlock *info = new sdfInfoBlock();
             this->setInfo(info);
-            this->info->jsonToInfo(input["info"]);
+            this->info->jsonToInfo(it.value());
+            break;
         }
-        else if (it.key() == "namespace" && !it.value().empty())
+        case key_namespace:
         {
             sdfNamespaceSection *ns = new sdfNamespaceSection();
             this->setNamespace(ns);
             this->ns->jsonToNamespace(input);
+            break;
         }
-        else if (it.key() == "defaultNamespace" && !it.value().empty())
-        {
-            this->ns->jsonToNamespace(input["namespace"]);
-        }
-        else if (it.key() == "sdfThing" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+        case key_sdfThing:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 if (!nested)
                 {
                     this->setName(correctValue(jt.key()));
-                    this->jsonToThing(input["sdfThing"][jt.key()], true);
+                    this->jsonToThing(jt.value(), true);
                 }
                 else
                 {
                     sdfThing *childThing = new sdfThing();
                     childThing->setName(correctValue(jt.key()));
                     this->addThing(childThing);
-                    childThing->jsonToThing(input["sdfThing"][jt.key()], true);
+                    childThing->jsonToThing(jt.value(), true);
                 }
             }
-        }
-        else if (it.key() == "sdfObject" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfObject:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfObject *childObject = new sdfObject();
                 childObject->setName(correctValue(jt.key()));
                 this->addObject(childObject);
-                childObject->jsonToObject(input["sdfObject"][jt.key()]);
+                childObject->jsonToObject(jt.value());
             }
+            break;
+        default:
+            break;
         }
     }
     // only try to assign refs if this thing is at the top level
@@ -2889,13 +3263,7 @@ sdfThing* sdfThing::fileToThing(string path)
         loadContext();
 
     json json_input;
-    ifstream input(path);
-    if (input)
-    {
-        input >>  json_input;
-        input.close();
-    }
-    else
+    if (!readSdfFile(path, json_input))
     {
         cerr << "sdfThing::fileToThing: Error opening file" << endl;
         return NULL;
@@ -2906,6 +3274,8 @@ sdfThing* sdfThing::fileToThing(string path)
 void sdfCommon::setParentCommon(sdfCommon *parentCommon)
 {
     //cout << parentCommon->getLabel() << endl;
+    if (this->parent != parentCommon)
+        referenceGeneration++;
     this->parent = parentCommon;
 }
 
@@ -2916,133 +3286,139 @@ sdfCommon* sdfCommon::getParentCommon()
 */
 void sdfCommon::setDescription(string dsc)
 {
-    this->description = dsc;
+    this->description = move(dsc);
 }
 
 void sdfData::setSimpType(jsonDataType _type)
 {
+    qualityGeneration++;
     this->simpleType = _type;
 }
 
 void sdfData::setDerType(string _type)
 {
+    qualityGeneration++;
     //this->simpleType = stringToJsonDType(_type);
-    this->derType = _type;
+    this->derType = move(_type);
 }
 
 void sdfData::setType(jsonDataType _type)
 {
+    qualityGeneration++;
     this->derType = jsonDTypeToString(_type);
     this->simpleType = _type;
 }
 
 void sdfData::setType(std::string _type)
 {
+    qualityGeneration++;
     this->derType = _type;
     this->simpleType = stringToJsonDType(_type);
 }
 
 bool sdfData::getReadable()
 {
-    return this->readable;
+    return this->flag(flag_readable);
 }
 
 bool sdfData::getWritable()
 {
-    return this->writable;
+    return this->flag(flag_writable);
 }
 
 void sdfData::setMaxItems(float maxItems)
 {
-    this->maxItems = maxItems;
+    setConstraint(&sdfDataConstraints::maxItems, maxItems);
 }
 
 void sdfData::setMinItems(float minItems)
 {
-    this->minItems = minItems;
+    setConstraint(&sdfDataConstraints::minItems, minItems);
 }
 
 void sdfData::setPattern(string pattern)
 {
-    this->pattern = pattern;
+    setConstraint(&sdfDataConstraints::pattern, move(pattern));
 }
 
 void sdfData::setConstantBool(bool constantBool)
 {
-    this->constantBool = constantBool;
-    this->constDefined = true;
-    this->constBoolDefined = true;
+    this->constantValue = constantBool;
+    this->setFlag(flag_const_defined, true);
+    this->setFlag(flag_const_bool_defined, true);
 }
 
 void sdfData::setConstantInt(int64_t _constantInt)
 {
-    this->constantInt = _constantInt;
-    this->constDefined = true;
-    this->constIntDefined = true;
+    this->constantValue = _constantInt;
+    this->setFlag(flag_const_defined, true);
+    this->setFlag(flag_const_int_defined, true);
 }
 
 void sdfData::setConstantNumber(float constantNumber)
 {
-    this->constantNumber = constantNumber;
-    this->constDefined = true;
+    this->constantValue = constantNumber;
+    this->setFlag(flag_const_defined, true);
 }
 
 void sdfData::setConstantString(string constantString)
 {
-    this->constantString = constantString;
-    this->constDefined = true;
+    this->constantValue = move(constantString);
+    this->setFlag(flag_const_defined, true);
 }
 
 void sdfData::setDefaultBool(bool defaultBool)
 {
-    this->defaultBool = defaultBool;
-    this->defaultDefined = true;
-    this->defaultBoolDefined = true;
+    this->defaultValue = defaultBool;
+    this->setFlag(flag_default_defined, true);
+    this->setFlag(flag_default_bool_defined, true);
 }
 
 void sdfData::setDefaultInt(int64_t defaultInt)
 {
-    this->defaultInt = defaultInt;
-    this->defaultDefined = true;
-    this->defaultIntDefined = true;
+    this->defaultValue = defaultInt;
+    this->setFlag(flag_default_defined, true);
+    this->setFlag(flag_default_int_defined, true);
 }
 
 void sdfData::setDefaultNumber(float defaultNumber)
 {
-    this->defaultNumber = defaultNumber;
-    this->defaultDefined = true;
+    this->defaultValue = defaultNumber;
+    this->setFlag(flag_default_defined, true);
 }
 
 void sdfData::setDefaultString(string defaultString)
 {
-    this->defaultString = defaultString;
-    this->defaultDefined = true;
+    this->defaultValue = move(defaultString);
+    this->setFlag(flag_default_defined, true);
 }
 
-vector<string> sdfData::getConstantStringArray() const
+const vector<string>& sdfData::getConstantStringArray() const
 {
-    return constantStringArray;
+    return getConstraints().constantStringArray;
 }
 
 void sdfData::setConstantArray(std::vector<std::string> constantArray)
 {
-    this->constantStringArray = constantArray;
-    this->constDefined = true;
+    this->editConstraints().constantStringArray = move(constantArray);
+    this->setFlag(flag_const_defined, true);
 }
 
-vector<string> sdfData::getDefaultStringArray() const
+const vector<string>& sdfData::getDefaultStringArray() const
 {
-    return defaultStringArray;
+    return getConstraints().defaultStringArray;
 }
 
 void sdfData::setDefaultArray(std::vector<std::string> defaultArray)
 {
-    this->defaultStringArray = defaultArray;
-    this->defaultDefined = true;
+    this->editConstraints().defaultStringArray = move(defaultArray);
+    this->setFlag(flag_default_defined, true);
 }
 
 void sdfData::setParentCommon(sdfCommon *parentCommon)
 {
+    if (this->parent != parentCommon)
+        referenceGeneration++;
     this->parent = parentCommon;
 }
 
@@ -3051,9 +3427,9 @@ sdfCommon* sdfData::getParentCommon() const
     return this->parent;
 }
 
-sdfInfoBlock* sdfInfoBlock::jsonToInfo(json input)
+sdfInfoBlock* sdfInfoBlock::jsonToInfo(const json &input)
 {
-    for (json::iterator it = input.begin(); it != input.end(); ++it)
+    for (json::const_iterator it = input.begin(); it != input.end(); ++it)
     {
         if (it.key() == "title" && !it.value().empty())
         {
@@ -3075,18 +3451,20 @@ sdfInfoBlock* sdfInfoBlock::jsonToInfo(json input)
     return this;
 }
 
-sdfNamespaceSection* sdfNamespaceSection::jsonToNamespace(json input)
+sdfNamespaceSection* sdfNamespaceSection::jsonToNamespace(
+        const json &input)
 {
-    for (json::iterator it = input.begin(); it != input.end(); ++it)
+    for (json::const_iterator it = input.begin(); it != input.end(); ++it)
     {
         if (it.key() == "namespace" && !it.value().empty())
         {
-            for (json::iterator jt = it.value().begin(); jt != it.value().end(); ++jt)
+            for (json::const_iterator jt = it.value().begin();
+                    jt != it.value().end(); ++jt)
             {
                 if (!jt.value().empty())
                 {
                     namespaces[jt.key()] = jt.value();
-                    namedFiles[jt.key()] = prefixToFile[jt.key()];
+                    namedFiles[jt.key()] = findBySymbol(prefixToFile, jt.key());
                 }
             }
         }
@@ -3094,6 +3472,7 @@ sdfNamespaceSection* sdfNamespaceSection::jsonToNamespace(json input)
         {
             default_ns = it.value();
             namedFiles[default_ns] = NULL;
+            referenceGeneration++;
         }
     }
     return this;
@@ -3155,7 +3534,7 @@ const char* sdfInfoBlock::getLicenseAsArray() const
 
 const char* sdfData::getUnitsAsArray() const
 {
-    return this->units.c_str();
+    return this->getConstraints().units.c_str();
 }
 /*
 const char* sdfData::getDefaultAsCharArray()
@@ -3252,134 +3631,154 @@ sdfData* sdfData::getItemConstr() const
 
 sdfData* sdfData::getItemConstrOfRefs() const
 {
-    sdfData *ref = this->getSdfDataReference();
-    if (ref && !item_constr)
-        return ref->getItemConstrOfRefs();
-
-    return item_constr;
+    return getResolved().itemConstr;
 }
 
 void sdfData::addChoice(sdfData *choice)
 {
+    qualityGeneration++;
     choice->setParentCommon(this);
     sdfChoice.push_back(choice);
 }
 
 void sdfData::addObjectProperty(sdfData *property)
 {
+    qualityGeneration++;
     objectProperties.push_back(property);
     property->setParentCommon(this);
 }
 
+void sdfData::removeObjectProperty(sdfData *property)
+{
+    qualityGeneration++;
+    vector<sdfData*>::iterator it = find(objectProperties.begin(),
+            objectProperties.end(), property);
+    if (it != objectProperties.end())
+        objectProperties.erase(it);
+}
+
+bool sdfData::replaceChild(sdfData *child, sdfData *replacement)
+{
+    vector<sdfData*>::iterator it = find(sdfChoice.begin(), sdfChoice.end(),
+            child);
+    if (it == sdfChoice.end())
+    {
+        it = find(objectProperties.begin(), objectProperties.end(), child);
+        if (it == objectProperties.end())
+        {
+            if (item_constr != child)
+                return false;
+
+            qualityGeneration++;
+            item_constr = replacement;
+            replacement->setParentCommon(this);
+            return true;
+        }
+    }
+
+    qualityGeneration++;
+    *it = replacement;
+    replacement->setParentCommon(this);
+    return true;
+}
+
 void sdfData::addRequiredObjectProperty(string propertyName)
 {
-    requiredObjectProperties.push_back(propertyName);
+    editConstraints().requiredObjectProperties.push_back(move(propertyName));
 }
 
-std::vector<sdfData*> sdfData::getChoice() const
+const std::vector<sdfData*>& sdfData::getChoice() const
 {
     return sdfChoice;
 }
 
 void sdfData::setChoice(vector<sdfData*> choices)
 {
-    sdfChoice = choices;
+    qualityGeneration++;
+    sdfChoice = move(choices);
     for (sdfData *choice : this->getChoice())
         choice->setParentCommon(this);
 }
 
 void sdfData::setConstantArray(std::vector<bool> constantArray)
 {
-    constantBoolArray = constantArray;
-    constDefined = true;
+    editConstraints().constantBoolArray = move(constantArray);
+    setFlag(flag_const_defined, true);
 }
 
 void sdfData::setDefaultArray(std::vector<bool> defaultArray)
 {
-    defaultBoolArray = defaultArray;
-    defaultDefined = true;
+    editConstraints().defaultBoolArray = move(defaultArray);
+    setFlag(flag_default_defined, true);
 }
 
 void sdfData::setConstantArray(std::vector<int64_t> constantArray)
 {
-    constantIntArray = constantArray;
-    constDefined = true;
+    editConstraints().constantIntArray = move(constantArray);
+    setFlag(flag_const_defined, true);
 }
 
 void sdfData::setDefaultArray(std::vector<int64_t> defaultArray)
 {
-    defaultIntArray = defaultArray;
-    defaultDefined = true;
+    editConstraints().defaultIntArray = move(defaultArray);
+    setFlag(flag_default_defined, true);
 }
 
 void sdfData::setConstantArray(std::vector<float> constantArray)
 {
-    constantNumberArray = constantArray;
-    constDefined = true;
+    editConstraints().constantNumberArray = move(constantArray);
+    setFlag(flag_const_defined, true);
 }
 
 void sdfData::setDefaultArray(std::vector<float> defaultArray)
 {
-    defaultNumberArray = defaultArray;
-    defaultDefined = true;
+    editConstraints().defaultNumberArray = move(defaultArray);
+    setFlag(flag_default_defined, true);
 }
 
-std::vector<bool> sdfData::getConstantBoolArray() const
+const std::vector<bool>& sdfData::getConstantBoolArray() const
 {
-    return constantBoolArray;
+    return getConstraints().constantBoolArray;
 }
 
-std::vector<bool> sdfData::getDefaultBoolArray() const
+const std::vector<bool>& sdfData::getDefaultBoolArray() const
 {
-    return defaultBoolArray;
+    return getConstraints().defaultBoolArray;
 }
 
-std::vector<int64_t> sdfData::getConstantIntArray() const
+const std::vector<int64_t>& sdfData::getConstantIntArray() const
 {
-    return constantIntArray;
+    return getConstraints().constantIntArray;
 }
 
-std::vector<int64_t> sdfData::getDefaultIntArray() const
+const std::vector<int64_t>& sdfData::getDefaultIntArray() const
 {
-    return defaultIntArray;
+    return getConstraints().defaultIntArray;
 }
 
-std::vector<float> sdfData::getDefaultNumberArray() const
+const std::vector<float>& sdfData::getDefaultNumberArray() const
 {
-    return defaultNumberArray;
+    return getConstraints().defaultNumberArray;
 }
 
-std::vector<float> sdfData::getConstantNumberArray() const
+const std::vector<float>& sdfData::getConstantNumberArray() const
 {
-    return constantNumberArray;
+    return getConstraints().constantNumberArray;
 }
 
-std::vector<sdfData*> sdfData::getObjectProperties() const
+const std::vector<sdfData*>& sdfData::getObjectProperties() const
 {
     return objectProperties;
 }
 
-std::vector<sdfData*> sdfData::getObjectPropertiesOfRefs() const
+const std::vector<sdfData*>& sdfData::getObjectPropertiesOfRefs() const
 {
-    sdfData *ref = this->getSdfDataReference();
-    if (ref)
-    {
-        vector<sdfData*> refObjProps = ref->getObjectProperties();
-        vector<sdfData*> concatObjProps = {};
-
-        concatObjProps.insert(concatObjProps.end(),
-                objectProperties.begin(),
-                objectProperties.end());
-        concatObjProps.insert(concatObjProps.end(),
-                refObjProps.begin(),
-                refObjProps.end());
-        return concatObjProps;
-    }
-    return objectProperties;
+    return getResolved().objectProperties;
 }
 
 void sdfData::setItemConstr(sdfData *constr)
 {
+    qualityGeneration++;
     // properties should also have "this" as their parent and not
     // the constraint
     if (constr)
@@ -3415,12 +3814,13 @@ sdfData* sdfData::getDefaultObject() const
 
 void sdfData::setObjectProperties(std::vector<sdfData*> properties)
 {
-    objectProperties = properties;
+    qualityGeneration++;
+    objectProperties = move(properties);
     for (int i = 0; i < objectProperties.size(); i++)
         objectProperties.at(i)->setParentCommon(this);
 }
 
-std::string sdfCommon::getName() const
+const std::string& sdfCommon::getName() const
 {
     if (name == "")
         return label;
@@ -3443,101 +3843,106 @@ sdfFile* sdfCommon::getParentFile() const
 
 void sdfCommon::setName(std::string _name)
 {
-    name = _name;
+    if (name != _name)
+        referenceGeneration++;
+    name = move(_name);
 }
 
-std::vector<std::string> sdfData::getRequiredObjectProperties() const
+const std::vector<std::string>& sdfData::getRequiredObjectProperties() const
 {
-    return requiredObjectProperties;
+    return getConstraints().requiredObjectProperties;
 }
 
 void sdfData::setMinimum(double min)
 {
-    minimum = min;
+    setConstraint(&sdfDataConstraints::minimum, min);
 }
 
 void sdfData::setMaximum(double max)
 {
-    maximum = max;
+    setConstraint(&sdfDataConstraints::maximum, max);
 }
 
 void sdfData::setMultipleOf(float mult)
 {
-    multipleOf = mult;
+    setConstraint(&sdfDataConstraints::multipleOf, mult);
 }
 
 bool sdfData::getReadableDefined() const
 {
-    return readableDefined;
+    return flag(flag_readable_defined);
 }
 
 bool sdfData::getWritableDefined() const
 {
-    return writableDefined;
+    return flag(flag_writable_defined);
 }
 
 bool sdfData::getNullableDefined() const
 {
-    return nullableDefined;
+    return flag(flag_nullable_defined);
 }
 
 bool sdfData::getObservableDefined() const
 {
-    return observableDefined;
+    return flag(flag_observable_defined);
 }
 
 bool sdfData::getDefaultDefined() const
 {
-    return defaultDefined;
+    return flag(flag_default_defined);
 }
 
 bool sdfData::getConstantDefined() const
 {
-    return constDefined;
+    return flag(flag_const_defined);
 }
 
 bool sdfData::getDefaultIntDefined() const
 {
-    return defaultIntDefined;
+    return flag(flag_default_int_defined);
 }
 
 bool sdfData::getConstantIntDefined() const
 {
-    return constIntDefined;
+    return flag(flag_const_int_defined);
 }
 
 bool sdfData::getDefaultBoolDefined() const
 {
-    return defaultBoolDefined;
+    return flag(flag_default_bool_defined);
 }
 
 bool sdfData::getConstantBoolDefined() const
 {
-    return constBoolDefined;
+    return flag(flag_const_bool_defined);
 }
 
 bool sdfData::getUniqueItemsDefined() const
 {
-    return uniqueItemsDefined;
+    return flag(flag_unique_items_defined);
 }
 
 void sdfData::setMinLength(float min)
 {
-    minLength = min;
+    setConstraint(&sdfDataConstraints::minLength, min);
 }
 
 void sdfData::setMaxLength(float max)
 {
-    maxLength = max;
+    setConstraint(&sdfDataConstraints::maxLength, max);
 }
 
 void sdfData::setEnumString(std::vector<std::string> enm)
 {
-    enumString = enm;
+    setConstraint(&sdfDataConstraints::enumString, move(enm));
 }
 
-bool validateJson(json sdf, std::string schemaFileName)
+bool prepareValidator(std::string schemaFileName)
 {
+    if (validators[schemaFileName])
+        return true;
+
     // Load the schema
     json sdf_schema;
     ifstream input_schema(schemaFileName);
@@ -3549,24 +3954,33 @@ bool validateJson(json sdf, std::string schemaFileName)
     else
     {
         cerr << "Error opening validation CDDL file" << endl;
-        return -1;
+        return false;
     }
 
-    nlohmann::json_schema::json_validator validator;
+    shared_ptr<json_validator> validator(new json_validator());
     try
     {
-        validator.set_root_schema(sdf_schema);
+        validator->set_root_schema(sdf_schema);
     }
     catch (const exception &e)
     {
         cerr << "Validation of schema failed:\n" << e.what() << endl;
-        return -1;
+        return false;
     }
 
+    validators[schemaFileName] = validator;
+    return true;
+}
+
+bool validateJson(json sdf, std::string schemaFileName)
+{
+    if (!prepareValidator(schemaFileName))
+        return -1;
+
     // validate
     try
     {
-        validator.validate(sdf);
+        validators[schemaFileName]->validate(sdf);
     }
     catch (const exception &e)
     {
@@ -3582,19 +3996,427 @@ bool validateFile(std::string fileName, std::string schemaFileName)
 {
     // open resulting model from file
     json sdf;
-    ifstream input_sdf(fileName);
-    if (input_sdf)
+    if (!readSdfFile(fileName, sdf))
+        return false;
+
+    cout << fileName << ": ";
+    return validateJson(sdf, schemaFileName);
+}
+
+int outputIndentWidth()
+{
+    // a negative indent makes nlohmann::json print without any whitespace
+    return compactOutput ? -1 : INDENT_WIDTH;
+}
+
+sdfFormat sdfFormatOfFileName(const std::string &fileName)
+{
+    static const regex cborRegex(".*\\.sdf\\.cbor");
+    static const regex msgpackRegex(".*\\.sdf\\.msgpack");
+    if (regex_match(fileName, cborRegex))
+        return sdf_format_cbor;
+    if (regex_match(fileName, msgpackRegex))
+        return sdf_format_msgpack;
+    return sdf_format_json;
+}
+
+bool isSdfFileName(const std::string &fileName)
+{
+    static const regex sdfRegex(".*\\.sdf\\.(json|cbor|msgpack)");
+    return regex_match(fileName, sdfRegex);
+}
+
+bool isSdfBundleName(const std::string &fileName)
+{
+    static const regex bundleRegex(".*\\.sdf\\.(jsonl|cborseq)");
+    return regex_match(fileName, bundleRegex);
+}
+
+sdfFormat sdfBundleFormatOfFileName(const std::string &fileName)
+{
+    static const regex cborSeqRegex(".*\\.sdf\\.cborseq");
+    if (regex_match(fileName, cborSeqRegex))
+        return sdf_format_cbor;
+    return sdf_format_json;
+}
+
+/*
+ * Returns the position behind the CBOR data item that starts at pos in input,
+ * or string::npos if the item is malformed or truncated. Only the heads of
+ * the (nested) items are read, their content is skipped.
+ */
+static size_t cborItemEnd(string_view input, size_t pos)
+{
+    // the number of items left to skip on every nesting level, -1 for
+    // indefinite-length arrays, maps and strings (ended by a break byte)
+    vector<int64_t> pending = {1};
+    while (!pending.empty())
     {
-        input_sdf >> sdf;
-        input_sdf.close();
+        if (pending.back() == 0)
+        {
+            pending.pop_back();
+            continue;
+        }
+        if (pos >= input.size())
+            return string::npos;
+
+        uint8_t initial = input[pos++];
+        if (pending.back() == -1 && initial == 0xff)
+        {
+            pending.pop_back();
+            continue;
+        }
+        if (pending.back() > 0)
+            pending.back()--;
+
+        uint8_t major = initial >> 5;
+        uint8_t info = initial & 0x1f;
+        uint64_t arg = info;
+        bool indefinite = false;
+        if (info >= 24 && info <= 27)
+        {
+            size_t length = 1u << (info - 24);
+            if (pos + length > input.size())
+                return string::npos;
+            arg = 0;
+            for (size_t i = 0; i < length; i++)
+                arg = (arg << 8) | (uint8_t)input[pos++];
+        }
+        else if (info == 31 && major >= 2 && major <= 5)
+            indefinite = true;
+        else if (info > 27)
+            return string::npos;
+
+        if (major == 2 || major == 3)
+        {
+            if (indefinite)
+                pending.push_back(-1);
+            else if (arg > input.size() - pos)
+                return string::npos;
+            else
+                pos += arg;
+        }
+        else if (major == 4 || major == 5)
+        {
+            if (indefinite)
+                pending.push_back(-1);
+            else if (arg > input.size())
+                return string::npos;
+            else
+                pending.push_back(major == 4 ? arg : 2 * arg);
+        }
+        else if (major == 6)
+            pending.push_back(1);
     }
+    return pos;
+}
+
+bool splitSdfBundle(const char *data, size_t size, sdfFormat format,
+        std::vector<std::string_view> &documents)
+{
+    string_view input(data, size);
+    size_t pos = 0;
+    while (pos < input.size())
+    {
+        size_t end;
+        if (format == sdf_format_cbor)
+        {
+            end = cborItemEnd(input, pos);
+            if (end == string::npos)
+            {
+                cerr << "splitSdfBundle: malformed CBOR data item at byte "
+                        << pos << endl;
+                return false;
+            }
+        }
+        else
+        {
+            end = input.find('\n', pos);
+            if (end == string::npos)
+                end = input.size();
+        }
+
+        // empty lines between JSON documents are skipped
+        if (format == sdf_format_cbor
+                || input.find_first_not_of(" \t\r", pos) < end)
+            documents.push_back(input.substr(pos, end - pos));
+        pos = format == sdf_format_cbor ? end : end + 1;
+    }
+    return true;
+}
+
+std::string encodeSdfBundleDocument(const json &sdf, sdfFormat format)
+{
+    if (format == sdf_format_cbor)
+        return encodeSdf(sdf, sdf_format_cbor);
+    return sdf.dump() + "\n";
+}
+
+std::string sdfFormatExtension(sdfFormat format)
+{
+    if (format == sdf_format_cbor)
+        return ".sdf.cbor";
+    if (format == sdf_format_msgpack)
+        return ".sdf.msgpack";
+    return ".sdf.json";
+}
+
+std::string encodeSdf(const json &sdf, sdfFormat format)
+{
+    string output;
+    if (format == sdf_format_cbor)
+        json::to_cbor(sdf, output);
+    else if (format == sdf_format_msgpack)
+        json::to_msgpack(sdf, output);
     else
+        output = sdf.dump(outputIndentWidth()) + "\n";
+    return output;
+}
+
+bool decodeSdf(const std::string &input, sdfFormat format, json &sdf)
+{
+    return decodeSdf(input.data(), input.size(), format, sdf);
+}
+
+bool simdjsonAvailable()
+{
+#ifdef SDFCONV_WITH_SIMDJSON
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef SDFCONV_WITH_SIMDJSON
+/*
+ * Converts a document parsed by simdjson into a JSON object. Nested values are
+ * converted after the JSON value holding them has been created, with an
+ * explicit stack instead of recursion.
+ */
+static void simdjsonToJson(simdjson::dom::element root, json &sdf)
+{
+    using simdjson::dom::element_type;
+    vector<tuple<simdjson::dom::element, json*>> stack;
+    vector<tuple<simdjson::dom::element, json*>> children;
+    stack.push_back(make_tuple(root, &sdf));
+    while (!stack.empty())
     {
-        cerr << "Error opening sdf.json file" << endl;
-        return -1;
+        simdjson::dom::element elem = get<0>(stack.back());
+        json *target = get<1>(stack.back());
+        stack.pop_back();
+
+        children.clear();
+        switch (elem.type())
+        {
+        case element_type::OBJECT:
+        {
+            // the members of a JSON object keep their addresses
+            simdjson::dom::object object = elem.get_object().value_unsafe();
+            *target = json::object();
+            for (simdjson::dom::key_value_pair member : object)
+                children.push_back(make_tuple(member.value,
+                        &(*target)[string(member.key)]));
+            break;
+        }
+        case element_type::ARRAY:
+        {
+            // the items are counted instead of using array::size(), which
+            // saturates for large arrays, so that the array is not resized
+            // (and its items moved) after their addresses have been taken
+            simdjson::dom::array array = elem.get_array().value_unsafe();
+            size_t count = 0;
+            for (simdjson::dom::element item : array)
+            {
+                (void)item;
+                count++;
+            }
+            *target = json::array();
+            json::array_t &items = target->get_ref<json::array_t&>();
+            items.resize(count);
+            size_t i = 0;
+            for (simdjson::dom::element item : array)
+                children.push_back(make_tuple(item, &items[i++]));
+            break;
+        }
+        case element_type::STRING:
+            *target = string(elem.get_string().value_unsafe());
+            break;
+        case element_type::INT64:
+        {
+            // nlohmann::json stores non-negative integers as unsigned
+            int64_t value = elem.get_int64().value_unsafe();
+            if (value >= 0)
+                *target = (uint64_t)value;
+            else
+                *target = value;
+            break;
+        }
+        case element_type::UINT64:
+            *target = elem.get_uint64().value_unsafe();
+            break;
+        case element_type::DOUBLE:
+            *target = elem.get_double().value_unsafe();
+            break;
+        case element_type::BOOL:
+            *target = elem.get_bool().value_unsafe();
+            break;
+        default:
+            *target = nullptr;
+            break;
+        }
+
+        // converted in document order, so that the last one of duplicate
+        // members wins like with nlohmann::json
+        stack.insert(stack.end(), children.rbegin(), children.rend());
     }
-    cout << fileName << ": ";
-    return validateJson(sdf, schemaFileName);
+}
+#endif
+
+bool parseSdfJson(const char *data, size_t size, json &sdf,
+        sdfJsonParser parser, size_t capacity)
+{
+#ifdef SDFCONV_WITH_SIMDJSON
+    if (parser == json_parser_simdjson)
+    {
+        // the parser keeps its buffers between documents, the text is only
+        // copied into a padded buffer if it cannot be parsed in place
+        static thread_local simdjson::dom::parser simdParser;
+        simdjson::dom::element doc;
+        bool inPlace = capacity >= size + simdjson::SIMDJSON_PADDING;
+        if (simdParser.parse(data, size, !inPlace).get(doc)
+                == simdjson::SUCCESS)
+        {
+            simdjsonToJson(doc, sdf);
+            return true;
+        }
+    }
+#else
+    (void)parser;
+    (void)capacity;
+#endif
+
+    try
+    {
+        sdf = json::parse(data, data + size);
+    }
+    catch (const exception &e)
+    {
+        cerr << "parseSdfJson: parsing the SDF model failed:\n" << e.what()
+                << endl;
+        return false;
+    }
+    return true;
+}
+
+bool decodeSdf(const char *data, size_t size, sdfFormat format, json &sdf,
+        size_t capacity)
+{
+    if (format == sdf_format_json)
+        return parseSdfJson(data, size, sdf, simdjsonAvailable()
+                ? json_parser_simdjson : json_parser_nlohmann, capacity);
+
+    try
+    {
+        if (format == sdf_format_cbor)
+            sdf = json::from_cbor(data, data + size);
+        else
+            sdf = json::from_msgpack(data, data + size);
+    }
+    catch (const exception &e)
+    {
+        cerr << "decodeSdf: decoding the SDF model failed:\n" << e.what()
+                << endl;
+        return false;
+    }
+    return true;
+}
+
+bool readSdfFile(const std::string &path, json &sdf)
+{
+    sdfInputBuffer buffer;
+    if (!buffer.open(path))
+    {
+        cerr << "readSdfFile: Error opening file " << path << endl;
+        return false;
+    }
+
+    return decodeSdf(buffer.data(), buffer.size(), sdfFormatOfFileName(path),
+            sdf, buffer.capacity());
+}
+
+sdfInputBuffer::sdfInputBuffer() : mapped(NULL), mappedLength(0)
+{}
+
+sdfInputBuffer::~sdfInputBuffer()
+{
+    close();
+}
+
+bool sdfInputBuffer::open(const std::string &path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    // regular files are mapped as a whole (empty files cannot be mapped)
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+            mapped = (char*)map;
+            mappedLength = st.st_size;
+            ::close(fd);
+            return true;
+        }
+    }
+
+    // fall back to read() for pipes and file systems without mmap support
+    char chunk[1 << 16];
+    ssize_t n;
+    while ((n = ::read(fd, chunk, sizeof(chunk))) != 0)
+    {
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            break;
+        fallback.append(chunk, n);
+    }
+    ::close(fd);
+    return n == 0;
+}
+
+void sdfInputBuffer::close()
+{
+    if (mapped)
+        munmap(mapped, mappedLength);
+    mapped = NULL;
+    mappedLength = 0;
+    fallback.clear();
+}
+
+const char* sdfInputBuffer::data() const
+{
+    return mapped ? mapped : fallback.data();
+}
+
+size_t sdfInputBuffer::size() const
+{
+    return mapped ? mappedLength : fallback.size();
+}
+
+size_t sdfInputBuffer::capacity() const
+{
+    // the mapping is readable up to the end of its last page
+    if (mapped)
+    {
+        size_t page = sysconf(_SC_PAGESIZE);
+        return (mappedLength + page - 1) / page * page;
+    }
+    return fallback.size();
 }
 
 bool sdfData::isItemConstr() const
@@ -3613,7 +4435,7 @@ bool sdfData::isObjectProp() const
     //if (parent && this == parent->getItemConstr())
     if (parent)
     {
-        vector<sdfData*> op = parent->getObjectProperties();
+        const vector<sdfData*> &op = parent->getObjectProperties();
         if (find(op.begin(), op.end(), this) != op.end())
             return true;
     }
@@ -3634,14 +4456,14 @@ void sdfData::parseDefaultArray(lys_node_leaflist *node)
     }
     else if(this->getSimpType() == json_array && node->dflt_size > 0)
     {
-        defaultDefined = true;
+        setFlag(flag_default_defined, true);
         //cout<<"dflt size "<<to_string(node->dflt_size)<<endl;
 
         if (this->getItemConstr()->getSimpType() == json_string)
         {
             for (int i = 0; i < node->dflt_size; i++)
             {
-                defaultStringArray.push_back(node->dflt[i]);
+                editConstraints().defaultStringArray.push_back(node->dflt[i]);
                 //cout <<"dflt "<< node->dflt[i] << endl;
             }
         }
@@ -3649,19 +4471,20 @@ void sdfData::parseDefaultArray(lys_node_leaflist *node)
         else if (this->getItemConstr()->getSimpType() == json_number)
         {
             for (int i = 0; i < node->dflt_size; i++)
-                defaultNumberArray.push_back(atof(node->dflt[i]));
+                editConstraints().defaultNumberArray.push_back(atof(node->dflt[i]));
         }
         else if (this->getItemConstr()->getSimpType() == json_boolean)
         {
-            defaultBoolArray = vector<bool>(node->dflt_size, false);
+            editConstraints().defaultBoolArray =
+                    vector<bool>(node->dflt_size, false);
             for (int i = 0; i < node->dflt_size; i++)
                 if (strcmp(node->dflt[i], "true") == 0)
-                    defaultBoolArray[i] = true;
+                    editConstraints().defaultBoolArray[i] = true;
         }
         else if (this->getItemConstr()->getSimpType() == json_integer)
         {
             for (int i = 0; i < node->dflt_size; i++)
-                defaultIntArray.push_back(atoi(node->dflt[i]));
+                editConstraints().defaultIntArray.push_back(atoi(node->dflt[i]));
         }
 
         else if (this->getItemConstr()->getSimpType() == json_array)
@@ -3711,33 +4534,33 @@ void sdfData::parseDefault(const char *value)
 
 string sdfData::getDefaultAsString()
 {
-    if (!defaultDefined)
+    if (!flag(flag_default_defined))
         return "";
 
     string defStr;
-    if (simpleType == json_number || !isnan(defaultNumber))
+    if (simpleType == json_number || !isnan(getDefaultNumber()))
     {
-        defStr = to_string(defaultNumber);
+        defStr = to_string(getDefaultNumber());
     }
-    else if (simpleType == json_string || defaultString != "")
+    else if (simpleType == json_string || getDefaultString() != "")
     {
-        defStr = defaultString;
+        defStr = getDefaultString();
     }
 
-    else if (simpleType == json_boolean || defaultBoolDefined)
+    else if (simpleType == json_boolean || flag(flag_default_bool_defined))
     {
-        if (defaultBool == true)
+        if (getDefaultBool() == true)
             defStr = "true";
         else
             defStr = "false";
     }
-    else if (simpleType == json_integer || defaultIntDefined)
+    else if (simpleType == json_integer || flag(flag_default_int_defined))
     {
-        defStr = string(to_string(defaultInt));
+        defStr = string(to_string(getDefaultInt()));
     }
-    else if(simpleType == json_array || !defaultBoolArray.empty()
-            || !defaultIntArray.empty() || !defaultNumberArray.empty()
-            || !defaultStringArray.empty())
+    else if(simpleType == json_array || !getConstraints().defaultBoolArray.empty()
+            || !getConstraints().defaultIntArray.empty() || !getConstraints().defaultNumberArray.empty()
+            || !getConstraints().defaultStringArray.empty())
     {
         cerr << "getDefaultAsString: wrong function for default arrays" << endl;
     }
@@ -3749,12 +4572,12 @@ vector<string> sdfData::getDefaultArrayAsStringVector()
 {
     // fill a vector with whatever default vector is defined
     // (only one of them can be != {})
-    vector<string> strVec = defaultStringArray;
+    vector<string> strVec = getConstraints().defaultStringArray;
 
-    for (float i : defaultNumberArray)
+    for (float i : getConstraints().defaultNumberArray)
         strVec.push_back(to_string(i));
 
-    for (bool i : defaultBoolArray)
+    for (bool i : getConstraints().defaultBoolArray)
     {
         if (i == true)
             strVec.push_back("true");
@@ -3762,7 +4585,7 @@ vector<string> sdfData::getDefaultArrayAsStringVector()
             strVec.push_back("false");
     }
 
-    for (int i : defaultIntArray)
+    for (int i : getConstraints().defaultIntArray)
         strVec.push_back(to_string(i));
 
     return strVec;
@@ -3770,31 +4593,31 @@ vector<string> sdfData::getDefaultArrayAsStringVector()
 
 string sdfData::getConstantAsString()
 {
-    if (!constDefined)
+    if (!flag(flag_const_defined))
         return "";
 
     string constStr;
-    if (simpleType == json_number || !isnan(constantNumber))
+    if (simpleType == json_number || !isnan(getConstantNumber()))
     {
-        constStr = to_string(constantNumber);
+        constStr = to_string(getConstantNumber());
     }
-    else if (simpleType == json_string || constantString != "")
-        constStr = constantString;
+    else if (simpleType == json_string || getConstantString() != "")
+        constStr = getConstantString();
 
-    else if (simpleType == json_boolean || constBoolDefined)
+    else if (simpleType == json_boolean || flag(flag_const_bool_defined))
     {
-        if (constantBool == true)
+        if (getConstantBool() == true)
             constStr = "true";
         else
             constStr = "false";
     }
-    else if (simpleType == json_integer || constIntDefined)
+    else if (simpleType == json_integer || flag(flag_const_int_defined))
     {
-        constStr = to_string(constantInt);
+        constStr = to_string(getConstantInt());
     }
-    else if(simpleType == json_array || !constantBoolArray.empty()
-            || !constantIntArray.empty() || !constantNumberArray.empty()
-            || !constantStringArray.empty())
+    else if(simpleType == json_array || !getConstraints().constantBoolArray.empty()
+            || !getConstraints().constantIntArray.empty() || !getConstraints().constantNumberArray.empty()
+            || !getConstraints().constantStringArray.empty())
     {
         cerr << "getDefaultAsString: wrong function for constant arrays"
                 << endl;
@@ -3808,12 +4631,12 @@ vector<string> sdfData::getConstantArrayAsStringVector()
 {
     // fill a vector with whatever default vector is defined
     // (only one of them can be != {})
-    vector<string> strVec = constantStringArray;
+    vector<string> strVec = getConstraints().constantStringArray;
 
-    for (float i : constantNumberArray)
+    for (float i : getConstraints().constantNumberArray)
         strVec.push_back(to_string(i));
 
-    for (bool i : constantBoolArray)
+    for (bool i : getConstraints().constantBoolArray)
     {
         if (i == true)
             strVec.push_back("true");
@@ -3821,7 +4644,7 @@ vector<string> sdfData::getConstantArrayAsStringVector()
             strVec.push_back("false");
     }
 
-    for (int i : constantIntArray)
+    for (int i : getConstraints().constantIntArray)
         strVec.push_back(to_string(i));
 
     return strVec;
@@ -3829,6 +4652,8 @@ vector<string> sdfData::getConstantArrayAsStringVector()
 
 void sdfCommon::setParentFile(sdfFile *file)
 {
+    if (parentFile != file)
+        referenceGeneration++;
     parentFile = file;
 }
 
@@ -3851,47 +4676,14 @@ sdfFile::~sdfFile()
     delete ns;
     ns = NULL;
 
-    for (int i = 0; i < things.size(); i++)
-    {
-        delete things[i];
-        things[i] = NULL;
-    }
-    things.clear();
-
-    for (int i = 0; i < objects.size(); i++)
-    {
-        delete objects[i];
-        objects[i] = NULL;
-    }
-    objects.clear();
-
-    for (int i = 0; i < properties.size(); i++)
-    {
-        delete properties[i];
-        properties[i] = NULL;
-    }
-    properties.clear();
-
-    for (int i = 0; i < actions.size(); i++)
-    {
-        delete actions[i];
-        actions[i] = NULL;
-    }
-    actions.clear();
-
-    for (int i = 0; i < events.size(); i++)
-    {
-        delete events[i];
-        events[i] = NULL;
-    }
-    events.clear();
-
-    for (int i = 0; i < datatypes.size(); i++)
-    {
-        delete datatypes[i];
-        datatypes[i] = NULL;
-    }
-    datatypes.clear();
+    // children owned by the arena are destroyed together with it (after
+    // this destructor), only children created outside of it are deleted
+    deleteChildren(things);
+    deleteChildren(objects);
+    deleteChildren(properties);
+    deleteChildren(actions);
+    deleteChildren(events);
+    deleteChildren(datatypes);
 }
 
 void sdfFile::setInfo(sdfInfoBlock *_info)
@@ -3901,6 +4693,9 @@ void sdfFile::setInfo(sdfInfoBlock *_info)
 
 void sdfFile::setNamespace(sdfNamespaceSection *_ns)
 {
+    // the namespace determines the prefix of imported reference strings
+    if (ns != _ns)
+        referenceGeneration++;
     ns = _ns;
 }
 
@@ -3952,37 +4747,42 @@ sdfInfoBlock* sdfFile::getInfo() const
     return info;
 }
 
+sdfArena* sdfFile::getArena()
+{
+    return &arena;
+}
+
 sdfNamespaceSection* sdfFile::getNamespace() const
 {
     return ns;
 }
 
-std::vector<sdfThing*> sdfFile::getThings() const
+const std::vector<sdfThing*>& sdfFile::getThings() const
 {
     return things;
 }
 
-std::vector<sdfObject*> sdfFile::getObjects() const
+const std::vector<sdfObject*>& sdfFile::getObjects() const
 {
     return objects;
 }
 
-std::vector<sdfProperty*> sdfFile::getProperties()
+const std::vector<sdfProperty*>& sdfFile::getProperties()
 {
     return properties;
 }
 
-std::vector<sdfAction*> sdfFile::getActions()
+const std::vector<sdfAction*>& sdfFile::getActions()
 {
     return actions;
 }
 
-std::vector<sdfEvent*> sdfFile::getEvents()
+const std::vector<sdfEvent*>& sdfFile::getEvents()
 {
     return events;
 }
 
-std::vector<sdfData*> sdfFile::getDatatypes()
+const std::vector<sdfData*>& sdfFile::getDatatypes()
 {
     return datatypes;
 }
@@ -4060,101 +4860,101 @@ nlohmann::json sdfFile::toJson(nlohmann::json prefix)
 std::string sdfFile::toString()
 {
     json json_output;
-    return this->toJson(json_output).dump(INDENT_WIDTH);
+    return this->toJson(json_output).dump(outputIndentWidth());
 }
 
 void sdfFile::toFile(std::string path)
 {
-    ofstream output(path);
+    json json_output = this->toJson(json());
+    ofstream output(path, ios::binary);
     if (output)
     {
-        output << this->toString() << endl;
+        output << encodeSdf(json_output, sdfFormatOfFileName(path));
         output.close();
     }
     else
         cerr << "sdfFile::toFile: Error opening file" << endl;
 
-    validateFile(path);
+    cout << path << ": ";
+    validateJson(json_output);
 }
 
-sdfFile* sdfFile::fromJson(nlohmann::json input)
+sdfFile* sdfFile::fromJson(const json &input)
 {
-    // first check for the namespace etc (to determine whether this file
+    // all nodes of the model are allocated in the arena of this file
+    sdfArenaScope arenaScope(&arena);
+
+    // first look up the namespace etc (to determine whether this file
     // contributes to a global namespace -> whether default namespace is given)
-    for (json::iterator it = input.begin(); it != input.end(); ++it)
+    json::const_iterator infoIt = input.find("info");
+    if (infoIt != input.end() && !infoIt->empty())
     {
-        if (it.key() == "info" && !it.value().empty())
-        {
-            //shared_ptr<sdfInfoBlock> info(new sdfInfoBlock());
-            sdfInfoBlock *info = new sdfInfoBlock();
-            this->setInfo(info);
-            info->jsonToInfo(input["info"]);
-        }
-        else if (it.key() == "namespace" && !it.value().empty())
-        {
-            //shared_ptr<sdfNamespaceSection> ns(new sdfNamespaceSection());
-            sdfNamespaceSection *ns = new sdfNamespaceSection();
-            this->setNamespace(ns);
-            ns->jsonToNamespace(input);
-        }
-        else if (it.key() == "defaultNamespace" && !it.value().empty())
-        {
-            ns->jsonToNamespace(input["namespace"]);
-        }
+        sdfInfoBlock *info = new sdfInfoBlock();
+        this->setInfo(info);
+        info->jsonToInfo(*infoIt);
+    }
+    json::const_iterator nsIt = input.find("namespace");
+    if (nsIt != input.end() && !nsIt->empty())
+    {
+        // jsonToNamespace() reads both the namespace map and the
+        // defaultNamespace of the whole input
+        sdfNamespaceSection *ns = new sdfNamespaceSection();
+        this->setNamespace(ns);
+        ns->jsonToNamespace(input);
     }
     if (isContext && (!ns || ns->getDefaultNamespace() == ""))
         return NULL;
 
     // then check for things etc
-    for (json::iterator it = input.begin(); it != input.end(); ++it)
+    for (json::const_iterator it = input.begin(); it != input.end(); ++it)
     {
-        if (it.key() == "sdfThing" && !it.value().empty())
+        if (it.value().empty())
+            continue;
+
+        switch (stringToSdfKeyword(it.key()))
         {
-            for (json::iterator jt = it.value().begin();
+        case key_sdfThing:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfThing *childThing = new sdfThing();
                 childThing->setName(correctValue(jt.key()));
                 this->addThing(childThing);
-                childThing->jsonToThing(input["sdfThing"][jt.key()], true);
+                childThing->jsonToThing(jt.value(), true);
             }
-        }
-        else if (it.key() == "sdfObject" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfObject:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfObject *childObject = new sdfObject();
                 childObject->setName(correctValue(jt.key()));
                 this->addObject(childObject);
-                childObject->jsonToObject(input["sdfObject"][jt.key()], true);
+                childObject->jsonToObject(jt.value(), true);
             }
-        }
-        else if (it.key() == "sdfProperty" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfProperty:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfProperty *childProperty = new sdfProperty();
                 this->addProperty(childProperty);
                 childProperty->setName(correctValue(jt.key()));
-                childProperty->jsonToProperty(input["sdfProperty"][jt.key()]);
+                childProperty->jsonToProperty(jt.value());
             }
-        }
-        else if (it.key() == "sdfAction" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfAction:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfAction *childAction = new sdfAction();
                 this->addAction(childAction);
                 childAction->setName(correctValue(jt.key()));
-                childAction->jsonToAction(input["sdfAction"][jt.key()]);
+                childAction->jsonToAction(jt.value());
             }
-        }
-        else if (it.key() == "sdfEvent" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfEvent:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfEvent *childEvent =  new sdfEvent();
@@ -4162,19 +4962,21 @@ sdfFile* sdfFile::fromJson(nlohmann::json input)
                 // with label set this way, a label will be printed
                 // even though there was just a "title" in the original
                 childEvent->setName(correctValue(jt.key()));
-                childEvent->jsonToEvent(input["sdfEvent"][jt.key()]);
+                childEvent->jsonToEvent(jt.value());
             }
-        }
-        else if (it.key() == "sdfData" && !it.value().empty())
-        {
-            for (json::iterator jt = it.value().begin();
+            break;
+        case key_sdfData:
+            for (json::const_iterator jt = it.value().begin();
                     jt != it.value().end(); ++jt)
             {
                 sdfData *childData = new sdfData();
                 this->addDatatype(childData);
                 childData->setName(correctValue(jt.key()));
-                childData->jsonToData(input["sdfData"][jt.key()]);
+                childData->jsonToData(jt.value());
             }
+            break;
+        default:
+            break;
         }
     }
     // assign sdfRef and sdfRequired references
@@ -4203,18 +5005,319 @@ sdfFile* sdfFile::fromFile(std::string path)
         loadContext();
 
     json json_input;
-    ifstream input(path);
-    if (input)
+    if (!readSdfFile(path, json_input))
+        return NULL;
+    return this->fromJson(json_input);
+}
+
+/*
+ * Collects the elements of an sdfObject (the object itself, its sdfAction and
+ * sdfEvent definitions) into commons and the top-level sdfData subtrees of
+ * the object (properties, datatypes and the input/output data of actions and
+ * events) into roots.
+ */
+static void collectObjectElements(sdfObject *object,
+        vector<sdfCommon*> &commons, vector<sdfData*> &roots)
+{
+    commons.push_back(object);
+    for (sdfProperty *prop : object->getProperties())
+        roots.push_back(prop);
+    for (sdfData *data : object->getDatatypes())
+        roots.push_back(data);
+    for (sdfAction *action : object->getActions())
     {
-        input >>  json_input;
-        input.close();
+        commons.push_back(action);
+        roots.push_back(action->getInputData());
+        roots.push_back(action->getOutputData());
+        for (sdfData *data : action->getDatatypes())
+            roots.push_back(data);
     }
-    else
+    for (sdfEvent *event : object->getEvents())
     {
-        cerr << "sdfFile::fromFile: Error opening file" << endl;
-        return NULL;
+        commons.push_back(event);
+        roots.push_back(event->getOutputData());
+        for (sdfData *data : event->getDatatypes())
+            roots.push_back(data);
     }
-    return this->fromJson(json_input);
+}
+
+/*
+ * Collects all sdfData nodes below roots in pre-order into commons (each
+ * root before its sdfChoice elements, properties and item constraint).
+ */
+static void collectDataNodes(const vector<sdfData*> &roots,
+        vector<sdfCommon*> &commons)
+{
+    vector<sdfData*> stack(roots.rbegin(), roots.rend());
+    sdfData *data;
+    while (!stack.empty())
+    {
+        data = stack.back();
+        stack.pop_back();
+        if (!data)
+            continue;
+
+        commons.push_back(data);
+        stack.push_back(data->getItemConstr());
+        const vector<sdfData*> &props = data->getObjectProperties();
+        stack.insert(stack.end(), props.rbegin(), props.rend());
+        const vector<sdfData*> &choice = data->getChoice();
+        stack.insert(stack.end(), choice.rbegin(), choice.rend());
+    }
+}
+
+/*
+ * The qualities of an sdfData node without its children as JSON text, the
+ * structural hash of its subtree and the (approximate) length of the JSON
+ * text of its subtree, as used by sdfFile::deduplicateData()
+ */
+struct dedupNode
+{
+    string local;
+    size_t hash = 0;
+    size_t length = 0;
+};
+
+/*
+ * A child of an sdfData node with its JSON key (the kind of child and its
+ * name)
+ */
+typedef pair<string, sdfData*> dedupChild;
+
+/*
+ * Returns the sdfChoice elements, properties and item constraint of an
+ * sdfData node sorted by their JSON keys (JSON objects are unordered).
+ */
+static vector<dedupChild> dedupChildren(sdfData *data)
+{
+    vector<dedupChild> children;
+    for (sdfData *choice : data->getChoice())
+        children.push_back({"sdfChoice/" + choice->getName(), choice});
+    for (sdfData *prop : data->getObjectProperties())
+        children.push_back({"properties/" + prop->getName(), prop});
+    if (data->getItemConstr())
+        children.push_back({"items", data->getItemConstr()});
+    sort(children.begin(), children.end());
+    return children;
+}
+
+/*
+ * Mixes the key of a child and the hash of its subtree into one value, these
+ * values are summed up so that the order of the children does not matter.
+ */
+static size_t hashDedupChild(const string &key, size_t childHash)
+{
+    size_t seed = hash<string>()(key);
+    seed ^= childHash + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+/*
+ * Compares the subtrees of two sdfData nodes structurally, i.e. their
+ * qualities and the keys and structure of their children.
+ */
+static bool sameDedupStructure(sdfData *a, sdfData *b,
+        unordered_map<sdfData*, dedupNode> &nodes)
+{
+    vector<pair<sdfData*, sdfData*>> stack = {{a, b}};
+    while (!stack.empty())
+    {
+        pair<sdfData*, sdfData*> current = stack.back();
+        stack.pop_back();
+        if (nodes[current.first].local != nodes[current.second].local)
+            return false;
+
+        vector<dedupChild> childrenA = dedupChildren(current.first);
+        vector<dedupChild> childrenB = dedupChildren(current.second);
+        if (childrenA.size() != childrenB.size())
+            return false;
+        for (size_t i = 0; i < childrenA.size(); i++)
+        {
+            if (childrenA[i].first != childrenB[i].first)
+                return false;
+            stack.push_back({childrenA[i].second, childrenB[i].second});
+        }
+    }
+    return true;
+}
+
+int sdfFile::deduplicateData(const unordered_set<sdfCommon*> &keep)
+{
+    // collect all definitions of this file
+    vector<sdfCommon*> commons;
+    vector<sdfData*> roots;
+    vector<sdfThing*> things(this->getThings().rbegin(),
+            this->getThings().rend());
+    vector<sdfObject*> objects(this->getObjects().rbegin(),
+            this->getObjects().rend());
+    while (!things.empty())
+    {
+        sdfThing *thing = things.back();
+        things.pop_back();
+        commons.push_back(thing);
+        things.insert(things.end(), thing->getThings().rbegin(),
+                thing->getThings().rend());
+        objects.insert(objects.end(), thing->getObjects().rbegin(),
+                thing->getObjects().rend());
+    }
+    for (sdfObject *object : objects)
+        collectObjectElements(object, commons, roots);
+    for (sdfProperty *prop : this->getProperties())
+        roots.push_back(prop);
+    for (sdfAction *action : this->getActions())
+    {
+        commons.push_back(action);
+        roots.push_back(action->getInputData());
+        roots.push_back(action->getOutputData());
+        for (sdfData *data : action->getDatatypes())
+            roots.push_back(data);
+    }
+    for (sdfEvent *event : this->getEvents())
+    {
+        commons.push_back(event);
+        roots.push_back(event->getOutputData());
+        for (sdfData *data : event->getDatatypes())
+            roots.push_back(data);
+    }
+    for (sdfData *data : this->getDatatypes())
+        roots.push_back(data);
+    size_t firstData = commons.size();
+    collectDataNodes(roots, commons);
+
+    // nodes that are referenced (and the sdfData nodes containing them)
+    // cannot be moved or removed
+    unordered_set<sdfCommon*> pinned(keep.begin(), keep.end());
+    for (sdfCommon *com : commons)
+    {
+        if (com->getReference())
+            pinned.insert(com->getReference());
+        for (sdfCommon *req : com->getRequired())
+            pinned.insert(req);
+    }
+    vector<sdfCommon*> referenced(pinned.begin(), pinned.end());
+    for (sdfCommon *com : referenced)
+    {
+        sdfData *data = dynamic_cast<sdfData*>(com);
+        while (data)
+        {
+            pinned.insert(data);
+            data = dynamic_cast<sdfData*>(data->getParentCommon());
+        }
+    }
+
+    // the qualities of each nested sdfData node without its children, in
+    // pre-order because dataToJson() sets the types of sdfChoice elements
+    unordered_map<sdfData*, dedupNode> nodes;
+    for (size_t i = firstData; i < commons.size(); i++)
+    {
+        sdfData *data = dynamic_cast<sdfData*>(commons[i]);
+        nodes[data].local = data->dataToJson(json(), false)
+                ["sdfData"][data->getName()].dump();
+    }
+
+    // structural hashes and JSON text lengths bottom-up (children come after
+    // their parents in commons)
+    for (size_t i = commons.size(); i-- > firstData;)
+    {
+        sdfData *data = dynamic_cast<sdfData*>(commons[i]);
+        dedupNode &node = nodes[data];
+        node.hash = hash<string>()(node.local);
+        node.length = node.local.length();
+        for (const dedupChild &child : dedupChildren(data))
+        {
+            const dedupNode &childNode = nodes[child.second];
+            node.hash += hashDedupChild(child.first, childNode.hash);
+            node.length += child.first.length() + childNode.length;
+        }
+    }
+
+    // group the nested sdfData nodes by their structure in the order of
+    // their first appearance, the structure is only compared in full if
+    // the hashes are equal
+    unordered_map<size_t, vector<size_t>> groupsByHash;
+    vector<vector<sdfData*>> groups;
+    for (size_t i = firstData; i < commons.size(); i++)
+    {
+        sdfData *data = dynamic_cast<sdfData*>(commons[i]);
+        sdfData *parent = dynamic_cast<sdfData*>(data->getParentCommon());
+        if (!parent || parent->getItemConstr() == data || pinned.count(data))
+            continue;
+
+        // integer constraints are printed depending on the parent node
+        if (parent->getSimpType() == json_integer
+                && data->getSimpType() != json_integer)
+            continue;
+
+        const dedupNode &node = nodes[data];
+        if (node.length < DEDUP_MIN_LENGTH)
+            continue;
+
+        vector<size_t> &candidates = groupsByHash[node.hash];
+        bool found = false;
+        for (size_t group : candidates)
+        {
+            if (sameDedupStructure(groups[group][0], data, nodes))
+            {
+                groups[group].push_back(data);
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            candidates.push_back(groups.size());
+            groups.push_back({data});
+        }
+    }
+
+    // names of the datatypes of this file
+    unordered_set<string> names;
+    for (sdfData *data : this->getDatatypes())
+        names.insert(data->getName());
+
+    sdfArenaScope scope(this->getArena());
+    unordered_set<sdfData*> removed;
+    int replaced = 0;
+    for (vector<sdfData*> &group : groups)
+    {
+        vector<sdfData*> members;
+        for (sdfData *data : group)
+            if (!removed.count(data))
+                members.push_back(data);
+        if (members.size() < 2)
+            continue;
+
+        // move the first occurrence to the datatypes of this file
+        sdfData *first = members[0];
+        sdfData *parent = dynamic_cast<sdfData*>(first->getParentCommon());
+        parent->replaceChild(first,
+                new sdfData(first->getName(), "", "", first));
+
+        string name = first->getName();
+        for (int i = 1; names.count(name); i++)
+            name = first->getName() + "_" + to_string(i);
+        names.insert(name);
+        first->setName(name);
+        this->addDatatype(first);
+
+        // replace the other occurrences by references to the first one
+        for (size_t i = 1; i < members.size(); i++)
+        {
+            sdfData *dup = members[i];
+            parent = dynamic_cast<sdfData*>(dup->getParentCommon());
+            parent->replaceChild(dup, new sdfData(dup->getName(), "", "",
+                    first));
+
+            vector<sdfCommon*> subtree;
+            collectDataNodes({dup}, subtree);
+            for (sdfCommon *com : subtree)
+                removed.insert(dynamic_cast<sdfData*>(com));
+            delete dup;
+            replaced++;
+        }
+    }
+
+    return replaced;
 }
 
 sdfFile* sdfCommon::getTopLevelFile()
@@ -4252,22 +5355,31 @@ sdfCommon* sdfProperty::getParent() const
     return this->sdfObjectElement::getParent();
 }
 
-std::string sdfCommon::generateReferenceString(bool import)
+const std::string& sdfCommon::generateReferenceString(bool import)
 {
+    if (!referenceCache)
+        referenceCache.reset(new sdfReferenceCache());
+    if (referenceCache->generation[import] == referenceGeneration)
+        return referenceCache->reference[import];
+
+    string ref = "";
     if (this->getParent())
     {
         //cout << this->getParent()->generateReferenceString(this) << endl;
-        return this->getParent()->generateReferenceString(this, import);
+        ref = this->getParent()->generateReferenceString(this, import);
     }
     else if (this->getParentFile())
     {
         //cout << this->getParentFile()->generateReferenceString(this) << endl;
-        return this->getParentFile()->generateReferenceString(this, import);
+        ref = this->getParentFile()->generateReferenceString(this, import);
     }
+    else
+        cerr << "sdfCommon::generateReferenceString: " + this->getName()
+                + " has no assigned parent object" << endl;
 
-    cerr << "sdfCommon::generateReferenceString: " + this->getName()
-            + " has no assigned parent object" << endl;
-    return "";
+    referenceCache->reference[import] = move(ref);
+    referenceCache->generation[import] = referenceGeneration;
+    return referenceCache->reference[import];
 }
 
 sdfData* sdfCommon::getThisAsSdfData()
@@ -4282,10 +5394,10 @@ sdfData* sdfData::getThisAsSdfData()
 
 void sdfNamespaceSection::addNamespace(std::string pre, std::string ns)
 {
-    namespaces[pre] = ns;
+    namespaces[pre] = move(ns);
 
     // link files no foreign namespace
-    namedFiles[pre] = prefixToFile[pre];
+    namedFiles[pre] = findBySymbol(prefixToFile, pre);
 
     if (pre == default_ns)
         namedFiles[pre] = NULL;
@@ -4293,8 +5405,8 @@ void sdfNamespaceSection::addNamespace(std::string pre, std::string ns)
 
 void sdfData::setUniqueItems(bool unique)
 {
-    uniqueItems = unique;
-    uniqueItemsDefined = true;
+    setFlag(flag_unique_items, unique);
+    setFlag(flag_unique_items_defined, true);
 }
 
 std::map<std::string, sdfFile*> sdfNamespaceSection::getNamedFiles() const
@@ -4325,21 +5437,21 @@ void sdfNamespaceSection::updateNamedFiles()
     // link files to foreign namespaces
     map<string, string>::iterator it;
     for (it = namespaces.begin(); it != namespaces.end(); it++)
-        namedFiles[it->first] = prefixToFile[it->first];
+        namedFiles[it->first] = findBySymbol(prefixToFile, it->first);
 
     namedFiles[default_ns] = NULL;
 }
 
 void sdfData::setWritable(bool _writable)
 {
-    writable = _writable;
-    writableDefined = true;
+    setFlag(flag_writable, _writable);
+    setFlag(flag_writable_defined, true);
 }
 
 void sdfData::setReadable(bool _readable)
 {
-    readable = _readable;
-    readableDefined = true;
+    setFlag(flag_readable, _readable);
+    setFlag(flag_readable_defined, true);
 }
 
 void sdfNamespaceSection::removeNamespace(string pre)
@@ -4350,44 +5462,141 @@ void sdfNamespaceSection::removeNamespace(string pre)
 
 void sdfData::setMinInt(int64_t min)
 {
-    minInt = min;
-    minIntSet = true;
+    editConstraints().minInt = min;
+    setFlag(flag_min_int_set, true);
 }
 
 void sdfData::setMaxInt(int64_t  max)
 {
-    maxInt = max;
-    maxIntSet = true;
+    editConstraints().maxInt = max;
+    setFlag(flag_max_int_set, true);
 }
 
 int64_t sdfData::getMinInt() const
 {
-    return minInt;
+    return getConstraints().minInt;
 }
 
 int64_t sdfData::getMaxInt() const
 {
-    return maxInt;
+    return getConstraints().maxInt;
 }
 
 void sdfData::eraseMinInt()
 {
-    minInt = 0;
-    minIntSet = false;
+    setConstraint(&sdfDataConstraints::minInt, 0);
+    setFlag(flag_min_int_set, false);
 }
 
 void sdfData::eraseMaxInt()
 {
-    maxInt = 0;
-    maxIntSet = false;
+    setConstraint(&sdfDataConstraints::maxInt, 0);
+    setFlag(flag_max_int_set, false);
 }
 
 bool sdfData::getMinIntSet() const
 {
-    return minIntSet;
+    return flag(flag_min_int_set);
 }
 
 bool sdfData::getMaxIntSet() const
 {
-    return maxIntSet;
+    return flag(flag_max_int_set);
+}
+
+sdfBundle::sdfBundle()
+{
+    files = {};
+}
+
+sdfBundle::~sdfBundle()
+{
+    for (sdfFile *file : files)
+        delete file;
+    files.clear();
+}
+
+void sdfBundle::addFile(sdfFile *file)
+{
+    files.push_back(file);
+}
+
+const std::vector<sdfFile*>& sdfBundle::getFiles() const
+{
+    return files;
+}
+
+std::string sdfBundle::toString(sdfFormat format)
+{
+    string output;
+    for (sdfFile *file : files)
+        output += encodeSdfBundleDocument(file->toJson(json()), format);
+    return output;
+}
+
+void sdfBundle::toFile(std::string path)
+{
+    ofstream output(path, ios::binary);
+    if (output)
+    {
+        output << this->toString(sdfBundleFormatOfFileName(path));
+        output.close();
+    }
+    else
+        cerr << "sdfBundle::toFile: Error opening file" << endl;
+}
+
+sdfBundle* sdfBundle::fromString(const std::string &input, sdfFormat format)
+{
+    return this->fromString(input.data(), input.size(), format);
+}
+
+sdfBundle* sdfBundle::fromString(const char *data, size_t size,
+        sdfFormat format, size_t capacity)
+{
+    vector<string_view> documents;
+    if (!splitSdfBundle(data, size, format, documents))
+        return NULL;
+
+    // documents that cannot be decoded or loaded are skipped (e.g. models
+    // without default namespace in an SDF context), the others are kept
+    json document;
+    for (size_t i = 0; i < documents.size(); i++)
+    {
+        // the bytes behind a document (up to capacity) can be read as well
+        size_t offset = documents[i].data() - data;
+        if (!decodeSdf(documents[i].data(), documents[i].size(), format,
+                document, capacity > offset ? capacity - offset : 0))
+        {
+            cerr << "sdfBundle::fromString: skipping document " << i + 1
+                    << " (it could not be decoded)" << endl;
+            continue;
+        }
+
+        sdfFile *file = new sdfFile();
+        if (!file->fromJson(document))
+        {
+            cerr << "sdfBundle::fromString: skipping document " << i + 1
+                    << " (it is not a valid SDF model"
+                    << (isContext ? " with default namespace" : "") << ")"
+                    << endl;
+            delete file;
+            continue;
+        }
+        this->addFile(file);
+    }
+    return this;
+}
+
+sdfBundle* sdfBundle::fromFile(std::string path)
+{
+    sdfInputBuffer buffer;
+    if (!buffer.open(path))
+    {
+        cerr << "sdfBundle::fromFile: Error opening file " << path << endl;
+        return NULL;
+    }
+
+    return this->fromString(buffer.data(), buffer.size(),
+            sdfBundleFormatOfFileName(path), buffer.capacity());
 }
@@ -13,8 +13,16 @@
 #include <fstream>
 #include <sstream>
 #include <stdio.h>
+#include <stdint.h>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <tuple>
+#include <variant>
+#include <memory>
 #include <cmath>
 #include <regex>
 #include <typeinfo>
@@ -24,6 +32,11 @@
 
 #include <dirent.h>
 
+/**
+ * Enumeration of the encodings of SDF models (defined in sdfconv.hpp)
+ */
+enum sdfFormat : int;
+
 /**
  * Enumeration representing JSON built-in data types
  */
@@ -74,6 +87,212 @@ enum refOrReq
     REQ  /*!< sdfRequired */
 };
 
+/**
+ * Enumeration of the SDF and JSON schema keywords that are recognised when
+ * parsing SDF models
+ *
+ * @sa stringToSdfKeyword()
+ */
+enum sdfKeyword
+{
+    key_label,                /*!< Keyword label */
+    key_description,          /*!< Keyword description */
+    key_sdfRef,               /*!< Keyword sdfRef */
+    key_sdfRequired,          /*!< Keyword sdfRequired */
+    key_type,                 /*!< Keyword type */
+    key_enum,                 /*!< Keyword enum */
+    key_sdfChoice,            /*!< Keyword sdfChoice */
+    key_required,             /*!< Keyword required */
+    key_properties,           /*!< Keyword properties */
+    key_const,                /*!< Keyword const */
+    key_default,              /*!< Keyword default */
+    key_minimum,              /*!< Keyword minimum */
+    key_maximum,              /*!< Keyword maximum */
+    key_exclusiveMinimum,     /*!< Keyword exclusiveMinimum */
+    key_exclusiveMaximum,     /*!< Keyword exclusiveMaximum */
+    key_multipleOf,           /*!< Keyword multipleOf */
+    key_minLength,            /*!< Keyword minLength */
+    key_maxLength,            /*!< Keyword maxLength */
+    key_pattern,              /*!< Keyword pattern */
+    key_format,               /*!< Keyword format */
+    key_minItems,             /*!< Keyword minItems */
+    key_maxItems,             /*!< Keyword maxItems */
+    key_uniqueItems,          /*!< Keyword uniqueItems */
+    key_items,                /*!< Keyword items */
+    key_unit,                 /*!< Keyword unit (or units in older versions) */
+    key_scaleMinimum,         /*!< Keyword scaleMinimum */
+    key_scaleMaximum,         /*!< Keyword scaleMaximum */
+    key_readable,             /*!< Keyword readable */
+    key_writable,             /*!< Keyword writable */
+    key_observable,           /*!< Keyword observable */
+    key_nullable,             /*!< Keyword nullable */
+    key_contentFormat,        /*!< Keyword contentFormat */
+    key_sdfType,              /*!< Keyword sdfType (or subtype in older
+                                   versions) */
+    key_sdfInputData,         /*!< Keyword sdfInputData */
+    key_sdfRequiredInputData, /*!< Keyword sdfRequiredInputData */
+    key_sdfOutputData,        /*!< Keyword sdfOutputData */
+    key_sdfData,              /*!< Keyword sdfData */
+    key_sdfProperty,          /*!< Keyword sdfProperty */
+    key_sdfAction,            /*!< Keyword sdfAction */
+    key_sdfEvent,             /*!< Keyword sdfEvent */
+    key_sdfObject,            /*!< Keyword sdfObject */
+    key_sdfThing,             /*!< Keyword sdfThing */
+    key_info,                 /*!< Keyword info */
+    key_namespace,            /*!< Keyword namespace */
+    key_defaultNamespace,     /*!< Keyword defaultNamespace */
+    key_undef                 /*!< Keyword is not recognised */
+};
+
+/**
+ * Computes the FNV-1a hash of a string. Since the function can be evaluated at
+ * compile time, the hashes of string literals can be used as case labels to
+ * switch over strings. The hashes of all keywords in one switch statement
+ * must differ (this is checked by the compiler), the matched string still has
+ * to be compared to the keyword.
+ *
+ * @param str The string to hash
+ * @param len The length of the string
+ *
+ * @return The hash of the string
+ */
+constexpr uint32_t keywordHash(const char *str, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (unsigned char)str[i]) * 16777619u;
+    return hash;
+}
+
+/**
+ * Computes the FNV-1a hash of a null-terminated string literal at compile time
+ *
+ * @param str The string literal to hash
+ *
+ * @return The hash of the string
+ *
+ * @sa keywordHash(const char*, size_t)
+ */
+template<size_t N>
+constexpr uint32_t keywordHash(const char (&str)[N])
+{
+    return keywordHash(str, N - 1);
+}
+
+/**
+ * Computes the FNV-1a hash of a string
+ *
+ * @param str The string to hash
+ *
+ * @return The hash of the string
+ *
+ * @sa keywordHash(const char*, size_t)
+ */
+inline uint32_t keywordHash(const std::string &str)
+{
+    return keywordHash(str.data(), str.size());
+}
+
+/**
+ * Looks up the keyword corresponding to the key of a JSON member
+ *
+ * @param key The key to look up
+ *
+ * @return The corresponding keyword or key_undef if the key is no keyword
+ *
+ * @sa sdfKeyword
+ */
+sdfKeyword stringToSdfKeyword(const std::string &key);
+
+/**
+ * The ID of a string that is interned in the global symbol table. Equal
+ * strings are interned to equal IDs, so that interned strings can be compared
+ * and hashed as integers.
+ *
+ * @sa internSymbol(), findSymbol() and symbolToString()
+ */
+typedef uint32_t sdfSymbol;
+
+const sdfSymbol emptySymbol = 0; /**< The ID of the empty string */
+
+/**
+ * Interns a string into the global symbol table. Strings that are interned
+ * after markPersistentSymbols() are released again by resetSdfState().
+ *
+ * @param str The string to intern
+ *
+ * @return The ID of the string
+ */
+sdfSymbol internSymbol(const std::string &str);
+
+/**
+ * Interns a C string into the global symbol table (NULL is interned as the
+ * empty string).
+ *
+ * @param str The string to intern
+ *
+ * @return The ID of the string
+ *
+ * @sa internSymbol(const std::string&)
+ */
+sdfSymbol internSymbol(const char *str);
+
+/**
+ * Looks up the ID of a string without interning it. A string that has not
+ * been interned cannot be the key of a map keyed by sdfSymbol, therefore
+ * lookups should use this function to keep the symbol table from growing.
+ *
+ * @param str The string to look up
+ *
+ * @return The ID of the string or emptySymbol if the string is not interned
+ */
+sdfSymbol findSymbol(const std::string &str);
+
+/**
+ * Returns the string that is interned under a given ID
+ *
+ * @param sym The ID of the string
+ *
+ * @return A constant reference to the interned string (the empty string for
+ *         unknown IDs)
+ */
+const std::string& symbolToString(sdfSymbol sym);
+
+/**
+ * Marks all strings interned so far as persistent, i.e. they are kept by
+ * releaseSymbols(). Called once the SDF context is loaded because the global
+ * definitions of the context are keyed by symbol.
+ */
+void markPersistentSymbols();
+
+/**
+ * Removes all strings from the symbol table that were interned after the last
+ * call of markPersistentSymbols(). Their IDs must not be used any more.
+ */
+void releaseSymbols();
+
+/**
+ * Looks up the value that is mapped to a string in a map keyed by sdfSymbol
+ *
+ * @param symbols The map to search
+ * @param str     The string to look up
+ *
+ * @return The mapped value or a value-initialised T if the string is not mapped
+ */
+template<typename T>
+T findBySymbol(const std::unordered_map<sdfSymbol, T> &symbols,
+        const std::string &str)
+{
+    sdfSymbol sym = findSymbol(str);
+    if (sym == emptySymbol && str != "")
+        return T();
+    typename std::unordered_map<sdfSymbol, T>::const_iterator it =
+            symbols.find(sym);
+    if (it == symbols.end())
+        return T();
+    return it->second;
+}
+
 class sdfCommon;
 class sdfThing;
 class sdfObject;
@@ -90,7 +309,7 @@ class sdfFile;
  *
  * @sa jsonDataType
  */
-std::string jsonDTypeToString(jsonDataType type);
+const std::string& jsonDTypeToString(jsonDataType type);
 
 /**
  * Deduces the JSON data type from a given string
@@ -101,7 +320,7 @@ std::string jsonDTypeToString(jsonDataType type);
  *
  * @sa jsonDataType
  */
-jsonDataType stringToJsonDType(std::string str);
+jsonDataType stringToJsonDType(const std::string &str);
 
 /**
  * Takes a reference string and optionally a prefix and returns a pointer to the
@@ -165,7 +384,453 @@ bool validateJson(nlohmann::json sdf,
 bool validateFile(std::string fileName,
         std::string schemaFileName = "sdf-validation.cddl");
 
+/**
+ * Returns the indent width that SDF JSON output is printed with.
+ *
+ * @return INDENT_WIDTH, or -1 (no whitespace at all) if compactOutput is set
+ */
+int outputIndentWidth();
+
+/**
+ * Determines the encoding of an SDF file from the extension of its name
+ * (.sdf.json, .sdf.cbor or .sdf.msgpack).
+ *
+ * @param fileName The name of the file
+ *
+ * @return The encoding of the file (sdf_format_json for unknown extensions)
+ */
+sdfFormat sdfFormatOfFileName(const std::string &fileName);
+
+/**
+ * Checks whether the name of a file has one of the extensions of SDF files
+ * (.sdf.json, .sdf.cbor or .sdf.msgpack).
+ *
+ * @param fileName The name of the file
+ *
+ * @return True if fileName is the name of an SDF file, false otherwise
+ */
+bool isSdfFileName(const std::string &fileName);
+
+/**
+ * Checks whether the name of a file has one of the extensions of SDF bundle
+ * files, i.e. JSON Lines (.sdf.jsonl) or a CBOR sequence (.sdf.cborseq).
+ *
+ * @param fileName The name of the file
+ *
+ * @return True if fileName is the name of an SDF bundle, false otherwise
+ *
+ * @sa sdfBundle
+ */
+bool isSdfBundleName(const std::string &fileName);
+
+/**
+ * Determines the encoding of the models in an SDF bundle from the extension of
+ * its name.
+ *
+ * @param fileName The name of the bundle file
+ *
+ * @return sdf_format_cbor for .sdf.cborseq, sdf_format_json otherwise
+ */
+sdfFormat sdfBundleFormatOfFileName(const std::string &fileName);
+
+/**
+ * Splits the content of an SDF bundle into its encoded models. The models of
+ * a JSON Lines bundle are its non-empty lines, those of a CBOR sequence are
+ * its consecutive CBOR data items.
+ *
+ * @param data      A pointer to the content of the bundle
+ * @param size      The size of the content in bytes
+ * @param format    The encoding of the models (sdf_format_json or
+ *                  sdf_format_cbor)
+ * @param documents The vector to append the (still encoded) models to, they
+ *                  refer to the content and are not copied
+ *
+ * @return True if the content could be split, false if a CBOR data item is
+ *         malformed or truncated
+ */
+bool splitSdfBundle(const char *data, size_t size, sdfFormat format,
+        std::vector<std::string_view> &documents);
+
+/**
+ * Encodes a single SDF model as part of an SDF bundle, i.e. as compact JSON
+ * text ending with a newline or as a CBOR data item.
+ *
+ * @param sdf    The JSON object containing the SDF model
+ * @param format The encoding of the bundle (sdf_format_json or
+ *               sdf_format_cbor)
+ *
+ * @return The encoded model
+ */
+std::string encodeSdfBundleDocument(const nlohmann::json &sdf,
+        sdfFormat format);
+
+/**
+ * Returns the file extension of SDF files in a given encoding.
+ *
+ * @param format The encoding
+ *
+ * @return The file extension (including the leading dot)
+ */
+std::string sdfFormatExtension(sdfFormat format);
+
+/**
+ * Encodes an SDF model given as JSON object. JSON text is indented as given
+ * by outputIndentWidth() and ends with a newline.
+ *
+ * @param sdf    The JSON object containing the SDF model
+ * @param format The encoding
+ *
+ * @return The encoded SDF model (binary encodings may contain null bytes)
+ */
+std::string encodeSdf(const nlohmann::json &sdf, sdfFormat format);
+
+/**
+ * Decodes an SDF model into a JSON object.
+ *
+ * @param input  The encoded SDF model
+ * @param format The encoding of input
+ * @param sdf    The JSON object to store the decoded SDF model in
+ *
+ * @return True if input could be decoded, false otherwise
+ */
+bool decodeSdf(const std::string &input, sdfFormat format,
+        nlohmann::json &sdf);
+
+/**
+ * Enumeration of the parsers for SDF models in JSON text
+ *
+ * @sa parseSdfJson()
+ */
+enum sdfJsonParser
+{
+    json_parser_nlohmann, /*!< The parser of nlohmann::json */
+    json_parser_simdjson  /*!< simdjson (only available if the converter is
+                               built with SDFCONV_WITH_SIMDJSON) */
+};
+
+/**
+ * Checks whether the converter has been built with simdjson.
+ *
+ * @return True if json_parser_simdjson is available, false otherwise
+ */
+bool simdjsonAvailable();
+
+/**
+ * Parses an SDF model given as JSON text into a JSON object. If simdjson is
+ * requested but not available, or if it rejects the input (e.g. because of
+ * numbers it cannot represent), the parser of nlohmann::json is used.
+ *
+ * simdjson parses the text in place if enough bytes can be read behind it
+ * (see capacity), otherwise it copies the text into a padded buffer first.
+ *
+ * @param data     A pointer to the JSON text
+ * @param size     The size of the JSON text in bytes
+ * @param sdf      The JSON object to store the SDF model in
+ * @param parser   The parser to use
+ * @param capacity The number of bytes that can be read from data on (0 if
+ *                 only size bytes can be read)
+ *
+ * @return True if the JSON text could be parsed, false otherwise
+ */
+bool parseSdfJson(const char *data, size_t size, nlohmann::json &sdf,
+        sdfJsonParser parser, size_t capacity = 0);
+
+/**
+ * Decodes an SDF model given as contiguous buffer into a JSON object. JSON
+ * text is parsed with simdjson if it is available (see parseSdfJson()).
+ *
+ * @param data     A pointer to the encoded SDF model
+ * @param size     The size of the encoded SDF model in bytes
+ * @param format   The encoding of the model
+ * @param sdf      The JSON object to store the decoded SDF model in
+ * @param capacity The number of bytes that can be read from data on (see
+ *                 parseSdfJson())
+ *
+ * @return True if the model could be decoded, false otherwise
+ */
+bool decodeSdf(const char *data, size_t size, sdfFormat format,
+        nlohmann::json &sdf, size_t capacity = 0);
+
+/**
+ * Reads an SDF file in the encoding given by the extension of its name into a
+ * JSON object. The file is parsed from an sdfInputBuffer.
+ *
+ * @param path The path to the file
+ * @param sdf  The JSON object to store the SDF model in
+ *
+ * @return True if the file could be read and decoded, false otherwise
+ */
+bool readSdfFile(const std::string &path, nlohmann::json &sdf);
+
+/**
+ * Loads and compiles the JSON schema in a specified file into a validator.
+ * Compiled validators are kept per schema file so that following calls of
+ * validateJson() and validateFile() do not have to load the schema again.
+ *
+ * @param schemaFileName The file name of file containing the JSON schema
+ *                       (set to the SDF validation JSON schema by default)
+ *
+ * @return True if the validator is ready to use, false otherwise
+ */
+bool prepareValidator(std::string schemaFileName = "sdf-validation.cddl");
+
+/**
+ * Searches a given directory for SDF files and SDF bundles and loads them as
+ * context, i.e. the definitions in files with a default namespace are made
+ * globally available to resolve sdfRef and sdfRequired references.
+ *
+ * @param path The path to the directory to search (the current directory by
+ *             default) or to a single SDF bundle file
+ */
+void loadContext(const char *path = ".");
+
+extern bool compactOutput;
+/**<
+ * Global variable to determine whether SDF JSON output is printed without
+ * indentation and line breaks (see outputIndentWidth())
+ */
+
+extern bool contextLoaded;
+/**<
+ * Global variable to determine whether the directory has been searched for
+ * SDF context files by loadContext()
+ */
+
+/**
+ * Resets the global state that is kept while a single SDF model is
+ * deserialised (definitions of the model and unassigned references) and
+ * releases the symbols interned since the SDF context was loaded.
+ * The global context loaded by loadContext() is kept.
+ */
+void resetSdfState();
+
 #define INDENT_WIDTH 2 /**< The indent width of output SDF JSON files */
+#define DEDUP_MIN_LENGTH 64 /**< The minimal length of the JSON text of an
+                                 sdfData subtree to be deduplicated by
+                                 sdfFile::deduplicateData() */
+
+/**
+ * The content of an input file in one contiguous buffer. Regular files are
+ * memory-mapped, other files (and files that cannot be mapped) are read with
+ * read() instead. The buffer can be parsed directly, without stream
+ * extraction, and handed on to be validated or converted.
+ */
+class sdfInputBuffer
+{
+public:
+    /**
+     * The sdfInputBuffer constructor. The buffer is empty until open() is
+     * called.
+     */
+    sdfInputBuffer();
+
+    /**
+     * The sdfInputBuffer destructor. Unmaps the file if it was mapped.
+     */
+    ~sdfInputBuffer();
+
+    sdfInputBuffer(const sdfInputBuffer&) = delete;
+    sdfInputBuffer& operator=(const sdfInputBuffer&) = delete;
+
+    /**
+     * Loads the content of a file into the buffer (replacing the previous
+     * content).
+     *
+     * @param path The path to the file
+     *
+     * @return True if the file could be read, false otherwise
+     */
+    bool open(const std::string &path);
+
+    /**
+     * Releases the content of the buffer.
+     */
+    void close();
+
+    /**
+     * Getter function for the content of the buffer
+     *
+     * @return A pointer to the first byte of the content (not terminated)
+     */
+    const char* data() const;
+
+    /**
+     * Getter function for the size of the buffer
+     *
+     * @return The size of the content in bytes
+     */
+    size_t size() const;
+
+    /**
+     * Getter function for the number of bytes that can be read from data()
+     * on. For mapped files this includes the rest of the last page, which
+     * is filled with zeros.
+     *
+     * @return The number of readable bytes (at least size())
+     */
+    size_t capacity() const;
+
+private:
+    char *mapped;         /**< The mapped file, NULL if it is not mapped */
+    size_t mappedLength;  /**< The length of the mapping */
+    std::string fallback; /**< The content if the file is not mapped */
+};
+
+/**
+ * An arena that owns the nodes of an SDF object model (sdfThing, sdfObject,
+ * sdfProperty, sdfAction, sdfEvent and sdfData objects). Nodes that are
+ * created with new while the arena is the current arena (see sdfArenaScope)
+ * are placed next to each other in large blocks of memory. They are not
+ * deleted by their parents but destroyed together with the arena, which then
+ * frees all blocks at once.
+ *
+ * Every sdfFile has an arena for the model it represents.
+ *
+ * @sa sdfArenaScope and sdfFile::getArena()
+ */
+class sdfArena
+{
+public:
+    /**
+     * The sdfArena constructor
+     *
+     * @param _blockSize The size of the memory blocks in bytes
+     */
+    sdfArena(size_t _blockSize = 64 * 1024);
+
+    /**
+     * The sdfArena destructor. Destroys all nodes owned by the arena.
+     *
+     * @sa clear()
+     */
+    ~sdfArena();
+
+    sdfArena(const sdfArena&) = delete;
+    sdfArena& operator=(const sdfArena&) = delete;
+
+    /**
+     * Allocates memory for a node inside of the current block (or a new
+     * block if the current one is full)
+     *
+     * @param size The size of the node
+     *
+     * @return A pointer to the allocated memory
+     */
+    void* allocate(size_t size);
+
+    /**
+     * Registers a node that was constructed in the memory of the arena so
+     * that it is destroyed together with the arena
+     *
+     * @param node The node
+     *
+     * @return The slot of the node (needed to release it)
+     *
+     * @sa release()
+     */
+    size_t adopt(sdfCommon *node);
+
+    /**
+     * Removes a node from the arena without freeing its memory. This is
+     * called when a node owned by the arena is destroyed by other means.
+     *
+     * @param slot The slot of the node as returned by adopt()
+     */
+    void release(size_t slot);
+
+    /**
+     * Destroys all nodes owned by the arena and frees its memory blocks
+     */
+    void clear();
+
+    /**
+     * Looks up the arena that the given memory belongs to
+     *
+     * @param ptr A pointer to the memory
+     *
+     * @return The arena or NULL if the memory does not belong to any arena
+     */
+    static sdfArena* arenaOf(const void *ptr);
+
+private:
+    /**
+     * The size of newly allocated blocks
+     */
+    size_t blockSize;
+
+    /**
+     * The next free byte of the current block
+     */
+    char *next;
+
+    /**
+     * The number of free bytes left in the current block
+     */
+    size_t left;
+
+    /**
+     * The memory blocks of the arena
+     */
+    std::vector<char*> blocks;
+
+    /**
+     * The nodes constructed in the arena, in the order of their construction
+     * (NULL for nodes that have been released)
+     */
+    std::vector<sdfCommon*> nodes;
+
+    /**
+     * The memory blocks of all arenas, mapped by their start addresses to
+     * their sizes and arenas
+     */
+    static std::map<const char*, std::tuple<size_t, sdfArena*>> allBlocks;
+};
+
+extern sdfArena *currentArena;
+/**<
+ * Global variable holding the arena that new nodes of the SDF object model
+ * are allocated in (NULL to allocate nodes on the heap)
+ */
+
+/**
+ * Makes an arena the current arena for the lifetime of the object and
+ * restores the previous one afterwards
+ *
+ * @sa currentArena
+ */
+class sdfArenaScope
+{
+public:
+    /**
+     * The sdfArenaScope constructor
+     *
+     * @param arena The arena that becomes the current arena
+     */
+    sdfArenaScope(sdfArena *arena);
+
+    /**
+     * The sdfArenaScope destructor. Restores the previous arena.
+     */
+    ~sdfArenaScope();
+
+private:
+    /**
+     * The arena that was current before
+     */
+    sdfArena *previous;
+};
+
+/**
+ * The reference strings of an sdfCommon cached by
+ * sdfCommon::generateReferenceString(), indexed by the import parameter
+ */
+struct sdfReferenceCache
+{
+    unsigned long generation[2] = {0, 0}; /**< The generation the reference
+                                               strings were generated in */
+    std::string reference[2];             /**< The reference strings without
+                                               and with namespace prefix */
+};
 
 /**
  * The sdfCommon class is used as a base to the sdfObject, sdfProperty,
@@ -174,6 +839,26 @@ bool validateFile(std::string fileName,
 class sdfCommon
 {
 public:
+    /**
+     * Allocates a node in the current arena, or on the heap if there is no
+     * current arena
+     *
+     * @param size The size of the node
+     *
+     * @return A pointer to the allocated memory
+     *
+     * @sa currentArena
+     */
+    static void* operator new(size_t size);
+
+    /**
+     * Frees the memory of a node allocated on the heap. The memory of nodes
+     * in an arena is freed together with the arena.
+     *
+     * @param ptr A pointer to the memory
+     */
+    static void operator delete(void *ptr);
+
     /**
      * The sdfCommon constructor
      *
@@ -192,16 +877,34 @@ public:
               sdfCommon *_reference = NULL,
               std::vector<sdfCommon*> _required = {},
               sdfFile *_file = NULL);
+
+    /**
+     * The sdfCommon move constructor. The name, description, label and
+     * sdfRequired of the given sdfCommon are moved, its sdfRef and file are
+     * taken over.
+     *
+     * @param common The sdfCommon to move from
+     */
+    sdfCommon(sdfCommon &&common);
+
     /**
      * The (virtual) sdfCommon destructor
      */
     virtual ~sdfCommon();
+
+    /**
+     * Returns the arena that owns this node
+     *
+     * @return The arena or NULL if the node is not owned by an arena (i.e. it
+     *         was allocated on the heap or the stack)
+     */
+    sdfArena* getArena() const;
     // getters
     /**
      * Getter function for the name
-     * @return The name
+     * @return A constant reference to the name (the label if no name is set)
      */
-    std::string getName() const;
+    const std::string& getName() const;
     /**
      * Getter function for the name as a C-array
      * @return The name as a C-array
@@ -238,7 +941,7 @@ public:
      *
      * @sa reference
      */
-    sdfCommon* getReference();
+    sdfCommon* getReference() const;
 
     /**
      * Getter function for the required subordinate definitions
@@ -249,7 +952,7 @@ public:
      * @sa required
      */
 
-    std::vector<sdfCommon*> getRequired();
+    const std::vector<sdfCommon*>& getRequired();
     /**
      * Getter function for the referenced definition cast to a sdfData pointer
      * (content of the sdfRef quality)
@@ -308,7 +1011,8 @@ public:
      */
     std::map<std::string, std::string> getNamespaces();
 
-    // setters
+    // setters (strings and vectors are taken by value and moved into the
+    // members, so temporaries are never copied)
     /**
      * Setter function for the name member variable
      * @param _name The new value for the name member variable
@@ -341,6 +1045,14 @@ public:
      */
     void addRequired(sdfCommon *common);
 
+    /**
+     * Setter function for the required member vector
+     * @param _required The new value for the required member vector
+     *
+     * @sa required
+     */
+    void setRequired(std::vector<sdfCommon*> _required);
+
     /**
      * Setter function for the reference member variable
      * @param common The value to set the reference member variable to
@@ -363,14 +1075,15 @@ public:
      * required by the sdfRef quality.
      *
      * This function works by calling this sdfCommon's parent's version of the
-     * function with this sdfCommon as a parameter.
+     * function with this sdfCommon as a parameter. The result is cached until
+     * any sdfCommon is renamed or reparented.
      *
      * @param import Set to true if this sdfCommon is referenced from another
      *               model and the reference string needs a prefix
      *
      * @return The reference string to refer to this sdfCommon
      */
-    std::string generateReferenceString(bool import = false);
+    const std::string& generateReferenceString(bool import = false);
 
     /**
      * Generate a string that contains a reference to a
@@ -408,7 +1121,7 @@ public:
      *
      * @param input The input JSON object
      */
-    void jsonToCommon(nlohmann::json input);
+    void jsonToCommon(const nlohmann::json &input);
 
 private:
     /**
@@ -451,6 +1164,25 @@ private:
      * @sa setParentFile() and getParent()
      */
     sdfFile *parentFile;
+
+    /**
+     * The cached reference strings (NULL until a reference string is first
+     * generated)
+     * @sa generateReferenceString()
+     */
+    std::unique_ptr<sdfReferenceCache> referenceCache;
+
+    /**
+     * The arena that owns this node (NULL if there is none)
+     * @sa getArena()
+     */
+    sdfArena *arena;
+
+    /**
+     * The slot of this node in its arena
+     * @sa sdfArena::adopt()
+     */
+    size_t arenaSlot;
 };
 
 /**
@@ -596,7 +1328,7 @@ public:
      *
      * @param input The input JSON object
      */
-    sdfInfoBlock* jsonToInfo(nlohmann::json input);
+    sdfInfoBlock* jsonToInfo(const nlohmann::json &input);
 private:
     /**
      * The title (for search results)
@@ -728,7 +1460,7 @@ public:
      *
      * @param input The input JSON object
      */
-    sdfNamespaceSection* jsonToNamespace(nlohmann::json input);
+    sdfNamespaceSection* jsonToNamespace(const nlohmann::json &input);
 
     /**
      * Inserts all definitions of this sdfNamespaceSection
@@ -755,12 +1487,133 @@ private:
      */
     std::string default_ns;
 
-    /**
-     * Maps prefixes to pointers to their respective sdfFile
-     *
-     * @sa getNamedFiles(), addNamespace() and updateNamedFiles()
-     */
-    std::map<std::string, sdfFile*> namedFiles;
+    /**
+     * Maps prefixes to pointers to their respective sdfFile
+     *
+     * @sa getNamedFiles(), addNamespace() and updateNamedFiles()
+     */
+    std::map<std::string, sdfFile*> namedFiles;
+};
+
+/**
+ * Enumeration of the boolean qualities of sdfData objects and of the flags
+ * that state whether a quality of an sdfData object is defined. They are
+ * stored as single bits.
+ *
+ * @sa sdfData::flag() and sdfData::setFlag()
+ */
+enum sdfDataFlag
+{
+    flag_const_defined,         /*!< A constant value is defined */
+    flag_default_defined,       /*!< A default value is defined */
+    flag_const_bool_defined,    /*!< A constant boolean value is defined */
+    flag_default_bool_defined,  /*!< A default boolean value is defined */
+    flag_const_int_defined,     /*!< A constant integer value is defined */
+    flag_default_int_defined,   /*!< A default integer value is defined */
+    flag_min_int_set,           /*!< An integer minimum is defined */
+    flag_max_int_set,           /*!< An integer maximum is defined */
+    flag_exclusive_minimum,     /*!< The minimum is exclusive */
+    flag_exclusive_maximum,     /*!< The maximum is exclusive */
+    flag_unique_items,          /*!< The uniqueItems quality */
+    flag_unique_items_defined,  /*!< The uniqueItems quality is defined */
+    flag_readable,              /*!< The readable quality */
+    flag_writable,              /*!< The writable quality */
+    flag_observable,            /*!< The observable quality */
+    flag_nullable,              /*!< The nullable quality */
+    flag_readable_defined,      /*!< The readable quality is defined */
+    flag_writable_defined,      /*!< The writable quality is defined */
+    flag_observable_defined,    /*!< The observable quality is defined */
+    flag_nullable_defined       /*!< The nullable quality is defined */
+};
+
+/**
+ * A constant or default value of an sdfData object with a simple type.
+ * An empty value (std::monostate) means that no value was set.
+ */
+typedef std::variant<std::monostate, bool, int64_t, float, std::string>
+    sdfValue;
+
+/**
+ * The data qualities of an sdfData object that are only used by few types.
+ * They are kept apart from the sdfData object and only allocated if at least
+ * one of them is set. Number-valued qualities are NaN if undefined,
+ * string-valued qualities are empty.
+ *
+ * @sa sdfData::getConstraints() and sdfData::editConstraints()
+ */
+struct sdfDataConstraints
+{
+    // only filled for type string
+    std::vector<std::string> enumString;  /**< Represents the enum quality */
+    std::string pattern;                  /**< Represents the pattern quality */
+    jsonSchemaFormat format = json_format_undef;
+    /**< Represents the format quality */
+    float minLength = NAN;  /**< Represents the minLength quality */
+    float maxLength = NAN;  /**< Represents the maxLength quality */
+
+    // only filled for type number or integer
+    double minimum = NAN;   /**< Represents the minimum quality if type is
+                                 number */
+    double maximum = NAN;   /**< Represents the maximum quality if type is
+                                 number */
+    int64_t minInt = 0;     /**< Represents the minimum quality if type is
+                                 integer */
+    uint64_t maxInt = 0;    /**< Represents the maximum quality if type is
+                                 integer */
+    float exclusiveMinimum_number = NAN;
+    /**< Represents the exclusiveMinimum quality of type number */
+    float exclusiveMaximum_number = NAN;
+    /**< Represents the exclusiveMaximum quality of type number */
+    float multipleOf = NAN; /**< Represents the multipleOf quality */
+
+    // only filled for type array
+    float minItems = NAN;   /**< Represents the minItems quality */
+    float maxItems = NAN;   /**< Represents the maxItems quality */
+    std::vector<bool> constantBoolArray;   /**< Represents the const quality
+                                                with boolean-typed items */
+    std::vector<bool> defaultBoolArray;    /**< Represents the default quality
+                                                with boolean-typed items */
+    std::vector<int64_t> constantIntArray; /**< Represents the const quality
+                                                with integer-typed items */
+    std::vector<int64_t> defaultIntArray;  /**< Represents the default quality
+                                                with integer-typed items */
+    std::vector<float> constantNumberArray;
+    /**< Represents the const quality with number-typed items */
+    std::vector<float> defaultNumberArray;
+    /**< Represents the default quality with number-typed items */
+    std::vector<std::string> constantStringArray;
+    /**< Represents the const quality with string-typed items */
+    std::vector<std::string> defaultStringArray;
+    /**< Represents the default quality with string-typed items */
+
+    // only filled for type object
+    std::vector<std::string> requiredObjectProperties;
+    /**< Represents the required quality */
+
+    // SDF-defined data qualities
+    std::string units;           /**< Represents the unit quality */
+    float scaleMinimum = NAN;    /**< Represents the scaleMinimum quality */
+    float scaleMaximum = NAN;    /**< Represents the scaleMaximum quality */
+    std::string contentFormat;   /**< Represents the contentFormat quality */
+};
+
+/**
+ * The qualities of an sdfData object that are resolved through its sdfRef
+ * chain (and its sdfChoice members). They are cached by
+ * sdfData::getResolved() until an sdfData object is changed.
+ */
+struct sdfResolvedQualities
+{
+    unsigned long generation = 0;   /**< The model generation the qualities
+                                         were resolved in */
+    std::string type;               /**< @sa sdfData::getType() */
+    jsonDataType simpleType = json_type_undef;
+    /**< @sa sdfData::getSimpType() */
+    float minItems = NAN;           /**< @sa sdfData::getMinItemsOfRef() */
+    float maxItems = NAN;           /**< @sa sdfData::getMaxItemsOfRef() */
+    sdfData *itemConstr = NULL;     /**< @sa sdfData::getItemConstrOfRefs() */
+    std::vector<sdfData*> objectProperties;
+    /**< @sa sdfData::getObjectPropertiesOfRefs() */
 };
 
 /**
@@ -826,6 +1679,14 @@ public:
      */
     sdfData(sdfData &data);
 
+    /**
+     * The sdfData move constructor. The children (objectProperties,
+     * sdfChoice and item constraint) are taken over and re-parented, the
+     * given object is left empty.
+     * @param data The sdfData object to move from
+     */
+    sdfData(sdfData &&data);
+
     /**
      * The sdfData copy constructor for casting sdfProperty objects
      * @param prop The address of the sdfProperty object to copy
@@ -1300,6 +2161,26 @@ public:
      */
     void addObjectProperty(sdfData *property);
 
+    /**
+     * Remove an element from the objectProperties member vector (without
+     * deleting it or changing its parent)
+     * @param property The element to remove from the objectProperties member
+     *                 vector.
+     * @sa objectProperties
+     */
+    void removeObjectProperty(sdfData *property);
+
+    /**
+     * Replace an element of sdfChoice, an object property or the item
+     * constraint by another sdfData object (without deleting the replaced
+     * element or changing its parent)
+     * @param child       The element to replace
+     * @param replacement The sdfData object to put in its place
+     *
+     * @return True if child was found and replaced, false otherwise
+     */
+    bool replaceChild(sdfData *child, sdfData *replacement);
+
     /**
      * Setter function for the objectProperties member variable
      * @param properties The new value of the objectProperties member variable.
@@ -1567,11 +2448,11 @@ public:
     /**
      * Getter function for the member variable enumString
      *
-     * @return The value of the member variable enumString.
+     * @return A constant reference to the member variable enumString.
      *
      * @sa enumString
      */
-    std::vector<std::string> getEnumString();
+    const std::vector<std::string>& getEnumString();
 
     /**
      * Getter function for the member variable exclusiveMaximum_bool
@@ -1646,7 +2527,7 @@ public:
      *
      * @sa maxItems
      */
-    float getMaxItemsOfRef();
+    float getMaxItemsOfRef() const;
 
     /**
      * Getter function for the member variable maxLength
@@ -1685,7 +2566,7 @@ public:
      *
      * @sa minItems
      */
-    float getMinItemsOfRef();
+    float getMinItemsOfRef() const;
 
     /**
      * Getter function for the member variable minLength
@@ -1792,7 +2673,7 @@ public:
      *
      * @sa simpleType
      */
-    jsonDataType getSimpType();
+    jsonDataType getSimpType() const;
 
     /**
      * Getter function for the member variable derType, or, if it exists,
@@ -1804,7 +2685,7 @@ public:
      *
      * @sa derType
      */
-    std::string getType();
+    const std::string& getType() const;
 
     /**
      * Getter function for the member variable uniqueItems.
@@ -1851,74 +2732,74 @@ public:
     /**
      * Getter function for the member variable constantBoolArray.
      *
-     * @return The value of the member variable constantBoolArray.
+     * @return A constant reference to the member variable constantBoolArray.
      *
      * @sa constantBoolArray
      */
-    std::vector<bool> getConstantBoolArray() const;
+    const std::vector<bool>& getConstantBoolArray() const;
 
     /**
      * Getter function for the member variable defaultBoolArray.
      *
-     * @return The value of the member variable defaultBoolArray.
+     * @return A constant reference to the member variable defaultBoolArray.
      *
      * @sa defaultBoolArray
      */
-    std::vector<bool> getDefaultBoolArray() const;
+    const std::vector<bool>& getDefaultBoolArray() const;
 
     /**
      * Getter function for the member variable constantIntArray.
      *
-     * @return The value of the member variable constantIntArray.
+     * @return A constant reference to the member variable constantIntArray.
      *
      * @sa constantIntArray
      */
-    std::vector<int64_t> getConstantIntArray() const;
+    const std::vector<int64_t>& getConstantIntArray() const;
 
     /**
      * Getter function for the member variable defaultIntArray.
      *
-     * @return The value of the member variable defaultIntArray.
+     * @return A constant reference to the member variable defaultIntArray.
      *
      * @sa defaultIntArray
      */
-    std::vector<int64_t> getDefaultIntArray() const;
+    const std::vector<int64_t>& getDefaultIntArray() const;
 
     /**
      * Getter function for the member variable constantNumberArray.
      *
-     * @return The value of the member variable constantNumberArray.
+     * @return A constant reference to the member variable constantNumberArray.
      *
      * @sa constantNumberArray
      */
-    std::vector<float> getConstantNumberArray() const;
+    const std::vector<float>& getConstantNumberArray() const;
 
     /**
      * Getter function for the member variable defaultNumberArray.
      *
-     * @return The value of the member variable defaultNumberArray.
+     * @return A constant reference to the member variable defaultNumberArray.
      *
      * @sa defaultNumberArray
      */
-    std::vector<float> getDefaultNumberArray() const;
+    const std::vector<float>& getDefaultNumberArray() const;
 
     /**
      * Getter function for the member variable constantStringArray.
      *
-     * @return The value of the member variable constantStringArray.
+     * @return A constant reference to the member variable constantStringArray.
      *
      * @sa constantStringArray
      */
-    std::vector<std::string> getConstantStringArray() const;
+    const std::vector<std::string>& getConstantStringArray() const;
 
     /**
      * Getter function for the member variable defaultStringArray.
      *
-     * @return The value of the member variable defaultStringArray.
+     * @return A constant reference to the member variable defaultStringArray.
      *
      * @sa defaultStringArray
      */
-    std::vector<std::string> getDefaultStringArray() const;
+    const std::vector<std::string>& getDefaultStringArray() const;
 
     /**
      * Getter function for the member variable parent.
@@ -1984,20 +2865,20 @@ public:
     /**
      * Getter function for the member variable sdfChoice.
      *
-     * @return The value of the member variable sdfChoice.
+     * @return A constant reference to the member variable sdfChoice.
      *
      * @sa sdfChoice
      */
-    std::vector<sdfData*> getChoice() const;
+    const std::vector<sdfData*>& getChoice() const;
 
     /**
      * Getter function for the member variable objectProperties.
      *
-     * @return The value of the member variable objectProperties.
+     * @return A constant reference to the member variable objectProperties.
      *
      * @sa objectProperties
      */
-    std::vector<sdfData*> getObjectProperties() const;
+    const std::vector<sdfData*>& getObjectProperties() const;
 
     /**
      * Return whether or not this sdfData object is listed in the
@@ -2008,16 +2889,17 @@ public:
      *
      * @sa objectProperties
      */
-    std::vector<sdfData*> getObjectPropertiesOfRefs() const;
+    const std::vector<sdfData*>& getObjectPropertiesOfRefs() const;
 
     /**
      * Getter function for the member variable requiredObjectProperties.
      *
-     * @return The value of the member variable requiredObjectProperties.
+     * @return A constant reference to the member variable
+     *         requiredObjectProperties.
      *
      * @sa requiredObjectProperties
      */
-    std::vector<std::string> getRequiredObjectProperties() const;
+    const std::vector<std::string>& getRequiredObjectProperties() const;
 
     /**
      * Returns a pointer to this sdfData object
@@ -2050,12 +2932,15 @@ public:
     /**
      * Transfer the information from this sdfData object into a JSON object.
      *
-     * @param prefix JSON object to add to (prefix does not mean the same prefix
-     *               as in the namespace prefix)
+     * @param prefix   JSON object to add to (prefix does not mean the same
+     *                 prefix as in the namespace prefix)
+     * @param children Whether the sdfChoice elements, properties and item
+     *                 constraint are transferred as well (if false, only the
+     *                 qualities of this node itself are)
      *
      * @return The completed JSON object
      */
-    nlohmann::json dataToJson(nlohmann::json prefix);
+    nlohmann::json dataToJson(nlohmann::json prefix, bool children = true);
 
     /**
      * Transfer the information from a given JSON object into this
@@ -2063,299 +2948,130 @@ public:
      *
      * @param input The input JSON object
      */
-    sdfData* jsonToData(nlohmann::json input);
+    sdfData* jsonToData(const nlohmann::json &input);
 
 private:
-    // TODO: use a C union for constant and default values, maximum, minimum?
-    /**
-     * True if a constant value is defined. This is necessary because
-     * some types of variables cannot be set to NULL.
-     * @sa getConstantDefined()
-     */
-    bool constDefined;
-
-    /**
-     * True if a default value is defined. This is necessary because
-     * some types of variables cannot be set to NULL.
-     * @sa getDefaultDefined()
-     */
-    bool defaultDefined;
-
-    /**
-     * Represents the type quality
-     * @sa setSimpType() and setType()
-     */
-    jsonDataType simpleType;
-
-    /**
-     * Represents the type quality as a string
-     * @sa setDerType() and setType()
-     */
-    std::string derType;
-
-    /**
-     * Represents the const quality for number values
-     * @sa setConstantNumber() and getConstantNumber()
-     */
-    float constantNumber;
-
-    /**
-     * Represents the default quality for number values
-     * @sa setDefaultNumber() and getDefaultNumber()
-     */
-    float defaultNumber;
-
-    // only fill for type string
-    /**
-     * Represents the enum quality
-     * @sa setEnumString() and getEnumString()
-     */
-    std::vector<std::string> enumString;
-
-    /**
-     * Represents the const quality if type is string
-     * @sa setConstantString() and getConstantString()
-     */
-    std::string constantString;
-
-    /**
-     * Represents the default quality if type is string
-     * @sa setDefaultString() and getDefaultString()
-     */
-    std::string defaultString;
-
-    // only fill for type boolean
-    /**
-     * Represents the const quality if type is boolean
-     * @sa setConstantBool() and getConstantBool()
-      */
-    bool constantBool;
-
-    /**
-     * Represents the default quality if type is boolean
-     * @sa setDefaultBool() and getDefaultBool()
-      */
-    bool defaultBool;
-
-    /**
-     * True if a constant boolean value is defined. This is necessary because
-     * boolean variables cannot be set to NULL.
-     * @sa constantBool and getConstantBoolDefined()
-     */
-    bool constBoolDefined;
-
-    /**
-     * True if a default boolean value is defined. This is necessary because
-     * boolean variables cannot be set to NULL.
-     * @sa defaultBool and getDefaultBoolDefined()
-     */
-    bool defaultBoolDefined;
-
-    // only fill for type integer
-    /**
-     * Represents the const quality if type is integer
-     * @sa setConstantInt() and getConstantInt()
-     */
-    int64_t constantInt;
-
-    /**
-     * Represents the default quality if type is integer
-     * @sa setDefaultInt() and getDefaultInt()
-      */
-    int64_t defaultInt;
-
-    /**
-     * True if a constant integer value is defined. This is necessary because
-     * integer variables cannot be set to NULL.
-     * @sa constantInt and getConstantIntDefined()
-     */
-    bool constIntDefined;
-
-    /**
-     * True if a default integer value is defined. This is necessary because
-     * integer variables cannot be set to NULL.
-     * @sa defaultInt and getDefaultIntDefined()
-     */
-    bool defaultIntDefined;
-
-    // only fill for type array
-    /**
-     * Represents the const quality if type is array with boolean-typed
-     * items
-     * @sa setConstantArray() and getConstantBoolArray()
-     */
-    std::vector<bool> constantBoolArray;
-
-    /**
-     * Represents the default quality if type is array with boolean-typed
-     * items
-     * @sa setDefaultArray() and getDefaultBoolArray()
-     */
-    std::vector<bool> defaultBoolArray;
-
-    /**
-     * Represents the const quality if type is array with integer-typed
-     * items
-     * @sa setConstantArray() and getConstantIntArray()
-     */
-    std::vector<int64_t> constantIntArray;
-
-    /**
-     * Represents the default quality if type is array with integer-typed
-     * items
-     * @sa setDefaultArray() and getDefaultIntArray()
-     */
-    std::vector<int64_t> defaultIntArray;
-
-    /**
-     * Represents the const quality if type is array with number-typed
-     * items
-     * @sa setConstantArray() and getConstantNumberArray()
-     */
-    std::vector<float> constantNumberArray;
-
-    /**
-     * Represents the default quality if type is array with number-typed
-     * items
-     * @sa setDefaultArray() and getDefaultNumberArray()
-     */
-    std::vector<float> defaultNumberArray;
-
-    /**
-     * Represents the const quality if type is array with string-typed
-     * items
-     * @sa setConstantArray() and getConstantStringArray()
-     */
-    std::vector<std::string> constantStringArray;
-
-    /**
-     * Represents the default quality if type is array with string-typed
-     * items
-     * @sa setDefaultArray() and getDefaultStringArray()
-     */
-    std::vector<std::string> defaultStringArray;
-
-    //sdfData *constantObject;
-    //sdfData *defaultObject;
-
-    /**
-     * Represents the minimum quality if type is number
-     * @sa setMinimum() and getMinimum()
-     */
-    double minimum;
-
-    /**
-     * Represents the maximum quality if type is number
-     * @sa setMaximum() and getMaximum()
-     */
-    double maximum;
-
     /**
-     * Represents the minimum quality if type is integer
-     * @sa setMinInt(), getMinInt() and eraseMinInt()
-     */
-    int64_t minInt;
-
-    /**
-     * Represents the maximum quality if type is integer
-     * @sa setMaxInt(), getMaxInt() and eraseMinInt()
-     */
-    uint64_t maxInt;
-
-    /**
-     * True if a minimum integer value is defined. This is necessary because
-     * integer variables cannot be set to NULL.
-     * @sa minInt and getMinIntSet()
-     */
-    bool minIntSet;
-
-    /**
-     * True if a maximum integer value is defined. This is necessary because
-     * integer variables cannot be set to NULL.
-     * @sa maxInt and getMaxIntSet()
+     * Getter function for one of the boolean qualities stored in the flags
+     * member variable
+     *
+     * @param f The flag to read
+     *
+     * @return The value of the flag
+     *
+     * @sa flags
      */
-    bool maxIntSet;
+    bool flag(sdfDataFlag f) const;
 
     /**
-     * Represents the exclusiveMinimum quality of type number
-     * @sa getExclusiveMinimumNumber()
+     * Setter function for one of the boolean qualities stored in the flags
+     * member variable
+     *
+     * @param f     The flag to set
+     * @param value The new value of the flag
+     *
+     * @sa flags
      */
-    float exclusiveMinimum_number;
+    void setFlag(sdfDataFlag f, bool value);
 
     /**
-     * Represents the exclusiveMaximum quality of type number
-     * @sa getExclusiveMaximumNumber()
+     * Returns the constraints of this sdfData object. If no constraint has
+     * been set yet, a shared set of undefined constraints is returned.
+     *
+     * @return The constraints (read only)
+     *
+     * @sa constraints
      */
-    float exclusiveMaximum_number;
+    const sdfDataConstraints& getConstraints() const;
 
     /**
-     * Represents the exclusiveMinimum quality of type boolean (implicating
-     * that the minimum variable states an exclusive minimum)
-     * @sa isExclusiveMinimumBool()
+     * Returns the qualities of this sdfData object resolved through its
+     * sdfRef chain and sdfChoice. They are computed on the first call and
+     * cached until any sdfData object or sdfRef is changed.
+     *
+     * @return The resolved qualities
+     *
+     * @sa resolved
      */
-    bool exclusiveMinimum_bool;
+    const sdfResolvedQualities& getResolved() const;
 
     /**
-     * Represents the exclusiveMaximum quality of type boolean (implicating
-     * that the maximum variable states an exclusive maximum)
-     * @sa isExclusiveMaximumBool()
+     * Returns the constraints of this sdfData object for modification. They
+     * are allocated on first use.
+     *
+     * @return The constraints
+     *
+     * @sa constraints
      */
-    bool exclusiveMaximum_bool;
+    sdfDataConstraints& editConstraints();
 
     /**
-     * Represents the multipleOf quality
-     * @sa setMultipleOf() and getMultipleOf()
+     * Sets one of the constraints of this sdfData object. The constraints are
+     * not allocated if the value is undefined (NaN, empty or zero) and no
+     * other constraint is set.
+     *
+     * @param member The constraint to set
+     * @param value  The new value of the constraint (moved from if it is an
+     *               rvalue)
+     *
+     * @sa constraints
      */
-    float multipleOf;
+    template<typename T, typename U>
+    void setConstraint(T sdfDataConstraints::*member, U &&value);
 
     /**
-     * Represents the minLength quality
-     * @sa setMinLength() and getMinLength()
+     * Represents the type quality
+     * @sa setSimpType() and setType()
      */
-    float minLength;
+    jsonDataType simpleType;
 
     /**
-     * Represents the maxLength quality
-     * @sa setMaxLength() and getMaxLength()
+     * Represents the sdfType quality
+     * @sa setSubtype() and getSubtype()
      */
-    float maxLength;
+    sdfSubtype subtype;
 
     /**
-     * Represents the pattern quality
-     * @sa setPattern() and getPattern()
+     * The boolean qualities and the flags that state whether a quality is
+     * defined, one bit per sdfDataFlag
+     * @sa flag() and setFlag()
      */
-    std::string pattern;
+    uint32_t flags;
 
     /**
-     * Represents the format quality
-     * @sa setFormat() and getFormat()
+     * Represents the type quality as a string
+     * @sa setDerType() and setType()
      */
-    jsonSchemaFormat format;
+    std::string derType;
 
     /**
-     * Represents the minItems quality
-     * @sa setMinItems() and getMinItems()
+     * Represents the const quality if type is number, string, boolean or
+     * integer. Only the alternative corresponding to the type is used.
+     * @sa getConstantNumber(), getConstantString(), getConstantBool() and
+     *     getConstantInt()
      */
-    float minItems;
+    sdfValue constantValue;
 
     /**
-     * Represents the maxItems quality
-     * @sa setMaxItems() and getMaxItems()
+     * Represents the default quality if type is number, string, boolean or
+     * integer. Only the alternative corresponding to the type is used.
+     * @sa getDefaultNumber(), getDefaultString(), getDefaultBool() and
+     *     getDefaultInt()
      */
-    float maxItems;
+    sdfValue defaultValue;
 
     /**
-     * Represents the uniqueItems quality
-     * @sa setUniqueItems() and getUniqueItems()
+     * Holds the remaining data qualities. It is only allocated if at least one
+     * of them is set.
+     * @sa getConstraints() and editConstraints()
      */
-    bool uniqueItems;
+    std::unique_ptr<sdfDataConstraints> constraints;
 
     /**
-     * True if the uniqueItems value is defined. This is necessary because
-     * boolean variables cannot be set to NULL.
-     * @sa uniqueItems and getUniqueItemsDefined()
+     * The cached resolved qualities (NULL until they are first needed)
+     * @sa getResolved()
      */
-    bool uniqueItemsDefined;
+    mutable std::unique_ptr<sdfResolvedQualities> resolved;
 
     /**
      * Represents the items quality, thus the constraints on the array items
@@ -2364,102 +3080,12 @@ private:
      */
     sdfData *item_constr;
 
-    // SDF-defined data qualities
-    /**
-     * Represents the unit quality
-     * @sa setUnits() and getUnits()
-     */
-    std::string units;
-
-    /**
-     * Represents the scaleMinimum quality
-     * @sa getScaleMinimum()
-     */
-    float scaleMinimum;
-
-    /**
-     * Represents the scaleMaximum quality
-     * @sa getScaleMaximum()
-     */
-    float scaleMaximum;
-
-    /**
-     * Represents the readable quality
-     * @sa setReadable and getReadable()
-      */
-    bool readable;
-
-    /**
-     * Represents the writable quality
-     * @sa setWritable and getWritable()
-      */
-    bool writable;
-
-    /**
-     * Represents the observable quality
-     * @sa setObserveNull() and getObservable()
-     */
-    bool observable;
-
-    /**
-     * Represents the nullable quality
-     * @sa setObserveNull() and getNullable()
-     */
-    bool nullable;
-
-    /**
-     * True if the readable value is defined. This is necessary because
-     * boolean variables cannot be set to NULL.
-     * @sa readable and getReadableDefined()
-     */
-    bool readableDefined;
-
-    /**
-     * True if the writable value is defined. This is necessary because
-     * boolean variables cannot be set to NULL.
-     * @sa writable and getWritableDefined()
-     */
-    bool writableDefined;
-
-    /**
-     * True if the observable value is defined. This is necessary because
-     * boolean variables cannot be set to NULL.
-     * @sa observable and getObservableDefined()
-     */
-    bool observableDefined;
-
-    /**
-     * True if the nullable value is defined. This is necessary because
-     * boolean variables cannot be set to NULL.
-     * @sa nullable and getNullableDefined()
-     */
-    bool nullableDefined;
-
-    /**
-     * Represents the contentFormat quality
-     * @sa getContentFormat()
-     */
-    std::string contentFormat;
-
-    // TODO: rename sdfSubtype to sdfType
-    /**
-     * Represents the sdfType quality
-     * @sa setSubtype() and getSubtype()
-     */
-    sdfSubtype subtype;
-
     /**
      * Represents the properties quality
      * @sa setObjectProperties(), getObjectProperties and addObjectProperties()
      */
     std::vector<sdfData*> objectProperties;
 
-    /**
-     * Represents the required quality
-     * @sa getRequiredObjectProperties() and addRequiredObjectProperty()
-     */
-    std::vector<std::string> requiredObjectProperties;
-
     /**
      * Represents the sdfChoice quality
      * @sa getChoice(), setChoice() and addChoice()
@@ -2533,11 +3159,11 @@ public:
     /**
      * Getter function for the member variable datatypes.
      *
-     * @return The value of the member variable datatypes.
+     * @return A constant reference to the member variable datatypes.
      *
      * @sa datatypes
      */
-    std::vector<sdfData*> getDatatypes();
+    const std::vector<sdfData*>& getDatatypes();
 
     /**
      * Getter function for the member variable outputData.
@@ -2569,7 +3195,7 @@ public:
      *
      * @param input The input JSON object
      */
-    sdfEvent* jsonToEvent(nlohmann::json input);
+    sdfEvent* jsonToEvent(const nlohmann::json &input);
 private:
     /**
      * Member variable representing the sdfOutputData quality of sdfEvent
@@ -2681,11 +3307,11 @@ public:
     /**
      * Getter function for the member variable requiredInputData.
      *
-     * @return The value of the member variable requiredInputData.
+     * @return A constant reference to the member variable requiredInputData.
      *
      * @sa inputData
      */
-    std::vector<sdfData*> getRequiredInputData();
+    const std::vector<sdfData*>& getRequiredInputData();
 
     /**
      * Getter function for the member variable outputData.
@@ -2699,11 +3325,11 @@ public:
     /**
      * Getter function for the member variable datatypes.
      *
-     * @return The value of the member variable datatypes.
+     * @return A constant reference to the member variable datatypes.
      *
      * @sa datatypes
      */
-    std::vector<sdfData*> getDatatypes();
+    const std::vector<sdfData*>& getDatatypes();
 
     // parsing
     std::string generateReferenceString(sdfCommon *child = NULL,
@@ -2726,7 +3352,7 @@ public:
      *
      * @param input The input JSON object
      */
-    sdfAction* jsonToAction(nlohmann::json input);
+    sdfAction* jsonToAction(const nlohmann::json &input);
 
 private:
     /**
@@ -2793,6 +3419,15 @@ public:
      */
     sdfProperty(sdfData& data);
 
+    /**
+     * The sdfProperty move constructor for promoting sdfData objects,
+     * nothing but the pointers to the children is copied
+     * @param data The sdfData object to move from
+     *
+     * @sa sdfData(sdfData &&data)
+     */
+    sdfProperty(sdfData &&data);
+
     // getters
     /**
      * Getter function for the member variable sdfObjectElement::parentObject.
@@ -2824,7 +3459,7 @@ public:
      *
      * @param input The input JSON object
      */
-    sdfProperty* jsonToProperty(nlohmann::json input);
+    sdfProperty* jsonToProperty(const nlohmann::json &input);
 };
 
 /**
@@ -2958,38 +3593,38 @@ public:
     /**
      * Getter function for the member variable properties
      *
-     * @return The value of the member variable properties.
+     * @return A constant reference to the member variable properties.
      *
      * @sa properties
      */
-    std::vector<sdfProperty*> getProperties();
+    const std::vector<sdfProperty*>& getProperties();
 
     /**
      * Getter function for the member variable actions
      *
-     * @return The value of the member variable actions.
+     * @return A constant reference to the member variable actions.
      *
      * @sa actions
      */
-    std::vector<sdfAction*> getActions();
+    const std::vector<sdfAction*>& getActions();
 
     /**
      * Getter function for the member variable events
      *
-     * @return The value of the member variable events.
+     * @return A constant reference to the member variable events.
      *
      * @sa events
      */
-    std::vector<sdfEvent*> getEvents();
+    const std::vector<sdfEvent*>& getEvents();
 
     /**
      * Getter function for the member variable datatypes.
      *
-     * @return The value of the member variable datatypes.
+     * @return A constant reference to the member variable datatypes.
      *
      * @sa datatypes
      */
-    std::vector<sdfData*> getDatatypes();
+    const std::vector<sdfData*>& getDatatypes();
 
     /**
      * Getter function for the member variable parent.
@@ -3050,7 +3685,7 @@ public:
     /**
      * Print the information from this sdfObject object into a JSON object
      * first, then into a string and then into a file.
-     * This function uses objectToJson() and objectToString().
+     * This function uses objectToJson(). The result is validated in memory.
      *
      * @param path The path to the output file
      */
@@ -3067,7 +3702,8 @@ public:
      * @param testForThing If true, look if input is has an sdfThing on the
      *                     top-level
      */
-    sdfObject* jsonToObject(nlohmann::json input, bool testForThing = false);
+    sdfObject* jsonToObject(const nlohmann::json &input,
+            bool testForThing = false);
 
     /**
      * Transfer the information from a file given by its name into this
@@ -3243,20 +3879,20 @@ public:
     /**
      * Getter function for the member variable childThings
      *
-     * @return The value of the member variable childThings.
+     * @return A constant reference to the member variable childThings.
      *
      * @sa childThings
      */
-    std::vector<sdfThing*> getThings() const;
+    const std::vector<sdfThing*>& getThings() const;
 
     /**
      * Getter function for the member variable childObjects
      *
-     * @return The value of the member variable childObjects.
+     * @return A constant reference to the member variable childObjects.
      *
      * @sa childObjects
      */
-    std::vector<sdfObject*> getObjects() const;
+    const std::vector<sdfObject*>& getObjects() const;
 
     /**
      * Getter function for the member variable parent
@@ -3316,7 +3952,7 @@ public:
     /**
      * Print the information from this sdfThing object into a JSON object first,
      * then into a string and then into a file.
-     * This function uses thingToJson() and thingToString().
+     * This function uses thingToJson(). The result is validated in memory.
      *
      * @param path The path to the output file
      */
@@ -3330,7 +3966,7 @@ public:
      * @param nested If true, this sdfThing belongs to another sdfThing and
      *               needs to be handled differently as a top-level sdfThing
      */
-    sdfThing* jsonToThing(nlohmann::json input, bool nested = false);
+    sdfThing* jsonToThing(const nlohmann::json &input, bool nested = false);
 
     /**
      * Transfer the information from a given JSON object into this (nested)
@@ -3338,7 +3974,7 @@ public:
      *
      * @param input  The input JSON object
      */
-    sdfThing* jsonToNestedThing(nlohmann::json input);
+    sdfThing* jsonToNestedThing(const nlohmann::json &input);
 
     /**
      * Transfer the information from a file given by its path into this
@@ -3503,6 +4139,16 @@ public:
      */
     sdfInfoBlock* getInfo() const;
 
+    /**
+     * Returns the arena that owns the nodes of the model. It is the current
+     * arena while the model is built by fromJson().
+     *
+     * @return A pointer to the member variable arena.
+     *
+     * @sa arena and sdfArenaScope
+     */
+    sdfArena* getArena();
+
     /**
      * Getter function for the member variable ns
      *
@@ -3515,56 +4161,56 @@ public:
     /**
      * Getter function for the member variable things
      *
-     * @return The value of the member variable things.
+     * @return A constant reference to the member variable things.
      *
      * @sa things
      */
-    std::vector<sdfThing*> getThings() const;
+    const std::vector<sdfThing*>& getThings() const;
 
     /**
      * Getter function for the member variable objects
      *
-     * @return The value of the member variable objects.
+     * @return A constant reference to the member variable objects.
      *
      * @sa objects
      */
-    std::vector<sdfObject*> getObjects() const;
+    const std::vector<sdfObject*>& getObjects() const;
 
     /**
      * Getter function for the member variable properties
      *
-     * @return The value of the member variable properties.
+     * @return A constant reference to the member variable properties.
      *
      * @sa properties
      */
-    std::vector<sdfProperty*> getProperties();
+    const std::vector<sdfProperty*>& getProperties();
 
     /**
      * Getter function for the member variable actions
      *
-     * @return The value of the member variable actions.
+     * @return A constant reference to the member variable actions.
      *
      * @sa actions
      */
-    std::vector<sdfAction*> getActions();
+    const std::vector<sdfAction*>& getActions();
 
     /**
      * Getter function for the member variable events.
      *
-     * @return The value of the member variable events.
+     * @return A constant reference to the member variable events.
      *
      * @sa events
      */
-    std::vector<sdfEvent*> getEvents();
+    const std::vector<sdfEvent*>& getEvents();
 
     /**
      * Getter function for the member variable datatypes.
      *
-     * @return The value of the member variable datatypes.
+     * @return A constant reference to the member variable datatypes.
      *
      * @sa datatypes
      */
-    std::vector<sdfData*> getDatatypes();
+    const std::vector<sdfData*>& getDatatypes();
 
     // parsing
     /**
@@ -3608,8 +4254,10 @@ public:
 
     /**
      * Print the information from this sdfFile object into a JSON object
-     * first, then into a string and then into a file.
-     * This function uses toJson() and toString().
+     * first and then into a file in the encoding given by the extension of
+     * the file name (see sdfFormatOfFileName()).
+     * This function uses toJson() and encodeSdf(). The result is validated
+     * in memory.
      *
      * @param path The path to the output file
      */
@@ -3621,15 +4269,32 @@ public:
      *
      * @param input The input JSON object
      */
-    sdfFile* fromJson(nlohmann::json input);
+    sdfFile* fromJson(const nlohmann::json &input);
 
     /**
      * Transfer the information from a file given by its path into this
-     * sdfFile object. This function uses fromJson().
+     * sdfFile object. The encoding of the file is given by the extension of
+     * its name (see sdfFormatOfFileName()). This function uses readSdfFile()
+     * and fromJson().
      *
      * @param path  The path to the input file
      */
     sdfFile* fromFile(std::string path);
+
+    /**
+     * Collapse structurally identical sdfData subtrees (e.g. range and length
+     * options, union members or bits) into one shared definition. The first
+     * occurrence is moved to the sdfData of this file, the others are
+     * replaced by sdfData objects that refer to it by sdfRef. Subtrees that
+     * are referenced (by sdfRef, sdfRequired or from keep) are left in place,
+     * as are item constraints and subtrees whose JSON text is shorter than
+     * DEDUP_MIN_LENGTH.
+     *
+     * @param keep Nodes that are referenced from outside of this file
+     *
+     * @return The number of subtrees that were replaced by an sdfRef
+     */
+    int deduplicateData(const std::unordered_set<sdfCommon*> &keep = {});
 private:
     /**
      * Represents the information block of an SDF model.
@@ -3684,7 +4349,115 @@ private:
      * @sa addDatatype() and getDatatypes()
      */
     std::vector<sdfData*> datatypes;
+
+    /**
+     * The arena that owns the nodes of the model
+     * @sa getArena()
+     */
+    sdfArena arena;
 };
 
-#endif
+/**
+ * This class represents a bundle of SDF models that are stored in a single
+ * file, each with its own information block and namespace section. Bundles
+ * are encoded as JSON Lines (one compact SDF model per line, file extension
+ * .sdf.jsonl) or as a CBOR sequence (RFC 8742, file extension .sdf.cborseq).
+ */
+class sdfBundle
+{
+public:
+    /**
+     * The sdfBundle constructor.
+     */
+    sdfBundle();
+
+    /**
+     * The sdfBundle destructor. The sdfFile objects of the bundle are
+     * deleted as well.
+     */
+    ~sdfBundle();
+
+    /**
+     * Adds an SDF model to the bundle. The bundle takes ownership of it.
+     *
+     * @param file The SDF model to add
+     */
+    void addFile(sdfFile *file);
+
+    /**
+     * Getter function for the files member variable
+     *
+     * @return The SDF models of the bundle
+     */
+    const std::vector<sdfFile*>& getFiles() const;
 
+    /**
+     * Encodes all SDF models of the bundle (using sdfFile::toJson()).
+     *
+     * @param format The encoding of the bundle (sdf_format_json for JSON
+     *               Lines or sdf_format_cbor for a CBOR sequence)
+     *
+     * @return The encoded bundle
+     */
+    std::string toString(sdfFormat format);
+
+    /**
+     * Writes the bundle into a file in the encoding given by the extension
+     * of the file name (see sdfBundleFormatOfFileName()).
+     *
+     * @param path The path to the output file
+     */
+    void toFile(std::string path);
+
+    /**
+     * Adds the SDF models of an encoded bundle to this bundle (using
+     * sdfFile::fromJson()).
+     *
+     * @param input  The encoded bundle
+     * @param format The encoding of the bundle (sdf_format_json for JSON
+     *               Lines or sdf_format_cbor for a CBOR sequence)
+     *
+     * @return This bundle, or NULL if input could not be split into models
+     *         (models that cannot be decoded or loaded are skipped)
+     */
+    sdfBundle* fromString(const std::string &input, sdfFormat format);
+
+    /**
+     * Adds the SDF models of an encoded bundle given as contiguous buffer to
+     * this bundle (using sdfFile::fromJson()). The models are decoded in
+     * place without copying them out of the buffer.
+     *
+     * @param data     A pointer to the encoded bundle
+     * @param size     The size of the encoded bundle in bytes
+     * @param format   The encoding of the bundle (sdf_format_json for JSON
+     *                 Lines or sdf_format_cbor for a CBOR sequence)
+     * @param capacity The number of bytes that can be read from data on (see
+     *                 parseSdfJson())
+     *
+     * @return This bundle, or NULL if the bundle could not be split into
+     *         models (models that cannot be decoded or loaded are skipped
+     *         and reported)
+     */
+    sdfBundle* fromString(const char *data, size_t size, sdfFormat format,
+            size_t capacity = 0);
+
+    /**
+     * Adds the SDF models of a bundle file to this bundle. The encoding is
+     * given by the extension of the file name. The file is read into an
+     * sdfInputBuffer that is decoded by fromString().
+     *
+     * @param path The path to the bundle file
+     *
+     * @return This bundle, or NULL if the file could not be read or split
+     */
+    sdfBundle* fromFile(std::string path);
+
+private:
+    /**
+     * The SDF models of the bundle (in the order of the bundle file)
+     * @sa addFile() and getFiles()
+     */
+    std::vector<sdfFile*> files;
+};
+
+#endif
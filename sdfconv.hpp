@@ -0,0 +1,232 @@
+/*!
+ * @file sdfconv.hpp
+ * @brief The programming interface header of the libsdfconv library
+ *
+ * This header specifies the in-memory conversion interface of the SDF/YANG
+ * converter. Models are passed in and returned as text buffers, no files are
+ * read or written.
+ */
+
+#ifndef SDFCONV_H
+#define SDFCONV_H
+
+#include <string>
+#include <map>
+#include <libyang/libyang.h>
+
+/**
+ * Enumeration of the modes to validate converted models
+ *
+ * @sa setValidationMode()
+ */
+enum validationMode
+{
+    validation_off,      /*!< Converted models are not validated */
+    validation_memory,   /*!< Converted models are validated in memory, YANG
+                              modules in a separate YANG context */
+    validation_deferred  /*!< Like validation_memory but YANG modules are
+                              validated in the background, the results are
+                              collected by finishValidations() or by
+                              validationResult() */
+};
+
+/**
+ * Enumeration of the encodings of SDF models
+ *
+ * @sa setSdfFormat()
+ */
+enum sdfFormat : int
+{
+    sdf_format_json,   /*!< JSON text (file extension .sdf.json) */
+    sdf_format_cbor,   /*!< CBOR (file extension .sdf.cbor) */
+    sdf_format_msgpack /*!< MessagePack (file extension .sdf.msgpack) */
+};
+
+/**
+ * The result of a conversion in memory
+ */
+struct conversionResult
+{
+    std::string fileName; /**< The file name proposed for the converted model
+                               (named after the model) */
+    std::string content;  /**< The converted model */
+    std::map<std::string, std::string> imports;
+    /**< The converted imports of the model, mapped by their proposed file
+         names */
+    bool validated = false;    /**< Whether the converted model has been
+                                    validated */
+    bool valid = false;        /**< The validation result (only meaningful if
+                                    validated is true) */
+    double conversionTime = 0; /**< The duration of the conversion in
+                                    milliseconds (without validation) */
+    double validationTime = 0; /**< The duration of the validation in
+                                    milliseconds */
+    int validationId = 0;      /**< The handle of the validation if it was
+                                    deferred (0 otherwise), see
+                                    validationResult() */
+};
+
+/**
+ * Converts a YANG module given as text into an SDF model.
+ * The modules imported by the YANG module are converted as well and returned
+ * as imports of the result.
+ *
+ * The module is parsed into ctx and removed from it again after the
+ * conversion, the modules it imports stay loaded in ctx so that following
+ * conversions can use them.
+ *
+ * @param ctx    The YANG context that is used to parse the module and to
+ *               resolve its imports
+ * @param input  The YANG module as text
+ * @param result The conversion result to store the SDF model and its imports
+ *               in
+ *
+ * @return 0 on successful conversion, -1 else
+ */
+int yangToSdfBuffer(ly_ctx *ctx, const char *input, conversionResult &result);
+
+/**
+ * Converts an already parsed YANG module into an SDF model.
+ * The modules imported by the YANG module are converted as well and returned
+ * as imports of the result.
+ *
+ * @param module The YANG module
+ * @param result The conversion result to store the SDF model and its imports
+ *               in
+ *
+ * @return 0 on successful conversion, -1 else
+ */
+int moduleToSdfBuffer(lys_module *module, conversionResult &result);
+
+/**
+ * Converts an SDF model given as JSON text into a YANG module.
+ * YANG modules that are imported by the resulting module are printed as well
+ * and returned as imports of the result.
+ *
+ * @param ctx        The YANG context that is used to resolve imports and to
+ *                   validate the resulting module
+ * @param input      The SDF model as JSON text
+ * @param result     The conversion result to store the YANG module and its
+ *                   imports in
+ * @param moduleName Optionally the name of the resulting YANG module (the name
+ *                   is derived from the SDF model otherwise)
+ *
+ * @return 0 on successful conversion, -1 else
+ */
+int sdfToYangBuffer(ly_ctx *ctx, const char *input, conversionResult &result,
+        const char *moduleName = NULL);
+
+/**
+ * Converts an SDF model in a given encoding into a YANG module.
+ * YANG modules that are imported by the resulting module are printed as well
+ * and returned as imports of the result.
+ *
+ * @param ctx        The YANG context that is used to resolve imports and to
+ *                   validate the resulting module
+ * @param input      The encoded SDF model (may contain null bytes)
+ * @param format     The encoding of input
+ * @param result     The conversion result to store the YANG module and its
+ *                   imports in
+ * @param moduleName Optionally the name of the resulting YANG module (the name
+ *                   is derived from the SDF model otherwise)
+ *
+ * @return 0 on successful conversion, -1 else
+ */
+int sdfToYangBuffer(ly_ctx *ctx, const std::string &input, sdfFormat format,
+        conversionResult &result, const char *moduleName = NULL);
+
+/**
+ * Sets the mode in which converted models are validated (validation_memory by
+ * default).
+ *
+ * @param mode The validation mode
+ */
+void setValidationMode(validationMode mode);
+
+/**
+ * Sets the encoding of the SDF models converted from YANG (sdf_format_json by
+ * default). The file names proposed for the converted models carry the
+ * matching extension.
+ *
+ * @param format The encoding of converted SDF models
+ */
+void setSdfFormat(sdfFormat format);
+
+/**
+ * Sets whether SDF models are printed as compact JSON text without
+ * indentation and line breaks (off by default).
+ *
+ * @param compact Whether to print compact JSON text
+ */
+void setCompactOutput(bool compact);
+
+/**
+ * Sets whether structurally identical sdfData definitions of SDF models
+ * converted from YANG are collapsed into shared definitions that are referred
+ * to by sdfRef (off by default).
+ *
+ * @param enabled Whether to deduplicate converted SDF models
+ */
+void setDeduplication(bool enabled);
+
+/**
+ * Enables features of a YANG module for the conversions (all features are
+ * converted by default). Once features of a module are given, its other
+ * features count as disabled and nodes whose if-feature expressions are false
+ * are skipped in both conversion directions. The feature state is taken from
+ * libyang, i.e. the given features are enabled in the YANG context.
+ *
+ * @param spec The module and its enabled features in the form
+ *             module:feature,feature,... (module: alone disables all
+ *             features of the module)
+ *
+ * @return True if spec could be parsed, false otherwise
+ */
+bool enableFeatures(const char *spec);
+
+/**
+ * Reads a feature profile file with one module:feature,... entry (see
+ * enableFeatures()) per line. Empty lines and lines starting with # are
+ * ignored.
+ *
+ * @param path The path to the feature profile file
+ *
+ * @return True if the file could be read and all entries parsed, false
+ *         otherwise
+ */
+bool loadFeatureProfile(const char *path);
+
+/**
+ * Waits for validations that have been deferred in mode validation_deferred
+ * and reports their results.
+ *
+ * @param wait If false, only the results of validations that are already
+ *             finished are reported
+ *
+ * @return The number of reported validations that failed
+ */
+int finishValidations(bool wait = true);
+
+/**
+ * Looks up the result of a deferred validation by its handle. A result can
+ * only be fetched once, it is not reported by finishValidations() after that.
+ *
+ * @param id    The handle of the validation (conversionResult::validationId)
+ * @param valid The variable to store the validation result in
+ * @param time  The variable to store the duration of the validation in
+ * @param wait  If false, the result is only fetched if the validation is
+ *              finished already
+ *
+ * @return 1 if the result was fetched, 0 if the validation is still running,
+ *         -1 if there is no validation with this handle
+ */
+int validationResult(int id, bool &valid, double &time, bool wait = false);
+
+/**
+ * Resets the global state of a conversion (in both conversion directions)
+ * so that the next conversion can start from scratch with the same YANG
+ * context and the same SDF context.
+ */
+void resetConversionState();
+
+#endif